@@ -0,0 +1,213 @@
+// buffercache.cc
+//	Routines to read and write disk sectors through the buffer cache.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "buffercache.h"
+#include "copyright.h"
+#include "system.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------------
+// FlusherThread
+// 	Body of the flusher.  Need this to be a C routine, because C++
+//	can't handle pointers to member functions.
+//----------------------------------------------------------------------
+
+static void FlusherThread(void *arg) { ((BufferCache *)arg)->Flusher(); }
+
+//----------------------------------------------------------------------
+// BufferCache::BufferCache
+// 	Initialize an empty cache.  The flusher is only started by the
+//	first write, so that a Nachos that does not write to the disk
+//	has no thread more.
+//----------------------------------------------------------------------
+
+BufferCache::BufferCache() {
+  for (int i = 0; i < NumCacheBuffers; i++) {
+    buffers[i].sector = -1;
+    buffers[i].dirty = buffers[i].busy = false;
+    buffers[i].lastUsed = 0;
+    buffers[i].next = NULL;
+    buckets[i] = NULL;
+  }
+  clock = numDirty = 0;
+  flusherStarted = false;
+  lock = new Lock("buffer cache");
+  ioDone = new Condition("buffer cache io");
+  dirtied = new Condition("buffer cache dirty");
+}
+
+BufferCache::~BufferCache() {
+  delete dirtied;
+  delete ioDone;
+  delete lock;
+}
+
+//----------------------------------------------------------------------
+// BufferCache::ReadSector
+// 	Copy the contents of "sectorNumber" into "data", reading it from
+//	the disk only if it is not in the cache.
+//----------------------------------------------------------------------
+
+void BufferCache::ReadSector(int sectorNumber, char *data) {
+  lock->Acquire();
+  CacheBuffer *buffer = Get(sectorNumber, true);
+  memcpy(data, buffer->data, SectorSize);
+  buffer->lastUsed = ++clock;
+  lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::WriteSector
+// 	Make "data" the new contents of "sectorNumber".  It goes to the
+//	disk later, with the flusher, a Sync, or when it is evicted.
+//----------------------------------------------------------------------
+
+void BufferCache::WriteSector(int sectorNumber, const char *data) {
+  lock->Acquire();
+  CacheBuffer *buffer = Get(sectorNumber, false);
+  memcpy(buffer->data, data, SectorSize);
+  buffer->lastUsed = ++clock;
+  if (!buffer->dirty) {
+    buffer->dirty = true;
+    if (numDirty++ == 0)
+      dirtied->Signal(lock);
+  }
+  if (!flusherStarted) {
+    flusherStarted = true;
+    Thread *thread = new Thread("buffer flusher");
+    thread->Fork(FlusherThread, this);
+  }
+  lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Sync
+// 	Write every dirty buffer back to the disk.  Returns once they all
+//	are, except for those written to again meanwhile.
+//----------------------------------------------------------------------
+
+void BufferCache::Sync() {
+  lock->Acquire();
+  for (int i = 0; i < NumCacheBuffers; i++) {
+    // INFO: uno ocupado ya se esta escribiendo, o se esta leyendo
+    while (buffers[i].busy)
+      ioDone->Wait(lock);
+    if (buffers[i].dirty)
+      WriteBack(&buffers[i]);
+  }
+  lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Flusher
+// 	Wait until some buffer is dirty, give it FlushDelay ticks to be
+//	written to again, and write everything back.  While there is
+//	nothing to write, the thread just waits, so it does not keep
+//	Nachos from halting.
+//----------------------------------------------------------------------
+
+void BufferCache::Flusher() {
+  for (;;) {
+    lock->Acquire();
+    while (numDirty == 0)
+      dirtied->Wait(lock);
+    lock->Release();
+    alarmClock->WaitUntil(FlushDelay);
+    Sync();
+  }
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Find
+// 	Return the buffer holding "sectorNumber", or NULL.
+//----------------------------------------------------------------------
+
+CacheBuffer *BufferCache::Find(int sectorNumber) {
+  CacheBuffer *buffer = buckets[sectorNumber % NumCacheBuffers];
+
+  while (buffer != NULL && buffer->sector != sectorNumber)
+    buffer = buffer->next;
+  return buffer;
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Get
+// 	Return the buffer for "sectorNumber", not busy, taking the least
+//	recently used one if the sector is not in the cache.  If "fill",
+//	the new buffer is read from the disk; if not, the caller is about
+//	to overwrite all of it.  The lock must be held; it is let go of
+//	while waiting for the disk.
+//----------------------------------------------------------------------
+
+CacheBuffer *BufferCache::Get(int sectorNumber, bool fill) {
+  for (;;) {
+    CacheBuffer *buffer = Find(sectorNumber);
+    if (buffer != NULL && buffer->busy) {
+      ioDone->Wait(lock);
+      continue;
+    }
+    if (buffer != NULL) {
+      if (fill)
+        stats->numBufferCacheHits++;
+      return buffer;
+    }
+
+    CacheBuffer *victim = NULL;
+    for (int i = 0; i < NumCacheBuffers; i++)
+      if (!buffers[i].busy &&
+          (victim == NULL || buffers[i].lastUsed < victim->lastUsed))
+        victim = &buffers[i];
+    if (victim == NULL) { // todos en el disco
+      ioDone->Wait(lock);
+      continue;
+    }
+    if (victim->dirty) {
+      // NOTE: mientras se escribe, otro pudo traer el sector buscado
+      WriteBack(victim);
+      continue;
+    }
+
+    if (victim->sector != -1) {
+      CacheBuffer **link = &buckets[victim->sector % NumCacheBuffers];
+      while (*link != victim)
+        link = &(*link)->next;
+      *link = victim->next;
+    }
+    victim->sector = sectorNumber;
+    victim->next = buckets[sectorNumber % NumCacheBuffers];
+    buckets[sectorNumber % NumCacheBuffers] = victim;
+    if (fill) {
+      stats->numBufferCacheMisses++;
+      victim->busy = true;
+      lock->Release();
+      synchDisk->ReadSector(sectorNumber, victim->data);
+      lock->Acquire();
+      victim->busy = false;
+      ioDone->Broadcast(lock);
+    }
+    return victim;
+  }
+}
+
+//----------------------------------------------------------------------
+// BufferCache::WriteBack
+// 	Write dirty "buffer" to the disk.  The lock must be held; it is
+//	let go of while waiting for the disk.
+//----------------------------------------------------------------------
+
+void BufferCache::WriteBack(CacheBuffer *buffer) {
+  buffer->busy = true;
+  buffer->dirty = false;
+  numDirty--;
+  lock->Release();
+  synchDisk->WriteSector(buffer->sector, buffer->data);
+  lock->Acquire();
+  buffer->busy = false;
+  stats->numBufferWritesBack++;
+  ioDone->Broadcast(lock);
+}
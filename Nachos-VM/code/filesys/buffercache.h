@@ -0,0 +1,83 @@
+// buffercache.h
+//	Data structures to keep recently used disk sectors in memory.
+//
+//	Every sector the file system reads or writes (file headers, the
+//	free map, directories, file data) goes through the buffer cache
+//	instead of straight to the SynchDisk.  A sector already in the
+//	cache is read from memory, without waiting for the disk; sectors
+//	are found through a hash table, and when the cache is full the
+//	least recently used one makes room.
+//
+//	Writes are delayed: WriteSector only copies the data into the
+//	cache and marks the buffer dirty.  A kernel thread, started with
+//	the first write, writes the dirty buffers back FlushDelay ticks
+//	after they were dirtied; a dirty buffer that is evicted is written
+//	back first; and Sync writes them all back right away (Halt calls
+//	it, since Nachos stops without waiting for the flusher).
+//
+//	A buffer is "busy" while its sector is moving to or from the
+//	disk.  The cache lock is not held meanwhile, so other threads can
+//	use the rest of the cache; the ones that want that same buffer
+//	wait for it.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BUFFERCACHE_H
+#define BUFFERCACHE_H
+
+#include "copyright.h"
+#include "disk.h"
+#include "synch.h"
+
+// Sectors the cache keeps at once
+const int NumCacheBuffers = 64;
+
+// Ticks a dirty buffer can wait before the flusher writes it back
+const int FlushDelay = 100000;
+
+// One sector in memory
+
+class CacheBuffer {
+public:
+  int sector;             // -1 while the buffer has not been used
+  bool dirty;             // newer than the disk
+  bool busy;              // being read from, or written to, the disk
+  int lastUsed;           // for the LRU replacement
+  CacheBuffer *next;      // next buffer in the same hash bucket
+  char data[SectorSize];
+};
+
+// The buffer cache
+
+class BufferCache {
+public:
+  BufferCache();  // every buffer empty
+  ~BufferCache(); // dirty buffers are lost: Sync first
+
+  // The same interface as SynchDisk, but served from memory when the
+  // sector is in the cache
+  void ReadSector(int sectorNumber, char *data);
+  void WriteSector(int sectorNumber, const char *data);
+
+  void Sync(); // write every dirty buffer back, and wait for it
+
+  void Flusher(); // body of the flusher thread, never returns
+
+private:
+  CacheBuffer buffers[NumCacheBuffers];
+  CacheBuffer *buckets[NumCacheBuffers]; // hash table, by sector
+  int clock;                             // accesses, for lastUsed
+  int numDirty;
+  bool flusherStarted;
+  Lock *lock;            // protects everything above
+  Condition *ioDone;     // a buffer stopped being busy
+  Condition *dirtied;    // the flusher waits here, for numDirty > 0
+
+  CacheBuffer *Find(int sectorNumber);
+  CacheBuffer *Get(int sectorNumber, bool fill); // find, or make room
+  void WriteBack(CacheBuffer *buffer);
+};
+
+#endif // BUFFERCACHE_H
@@ -117,8 +117,8 @@ int OpenFile::ReadAt(char *into, int numBytes, int position) {
   // read in all the full and partial sectors that we need
   buf = new char[numSectors * SectorSize];
   for (i = firstSector; i <= lastSector; i++)
-    synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize),
-                          &buf[(i - firstSector) * SectorSize]);
+    bufferCache->ReadSector(hdr->ByteToSector(i * SectorSize),
+                            &buf[(i - firstSector) * SectorSize]);
 
   // copy the part we want
   bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
@@ -160,8 +160,8 @@ int OpenFile::WriteAt(const char *from, int numBytes, int position) {
 
   // write modified sectors back
   for (i = firstSector; i <= lastSector; i++)
-    synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize),
-                           &buf[(i - firstSector) * SectorSize]);
+    bufferCache->WriteSector(hdr->ByteToSector(i * SectorSize),
+                             &buf[(i - firstSector) * SectorSize]);
   delete[] buf;
   return numBytes;
 }
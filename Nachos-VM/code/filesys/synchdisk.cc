@@ -5,10 +5,12 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	Each request has its own semaphore, for the interrupt handler to
+//	wake up the thread that made it.  Because the physical disk can
+//	only handle one operation at a time, the others wait in a queue;
+//	the interrupt handler sends the next one to the disk as soon as
+//	the current one is done.  The queue is shared with the interrupt
+//	handler, so it is protected by disabling interrupts.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -16,6 +18,7 @@
 
 #include "copyright.h"
 #include "synchdisk.h"
+#include "system.h"
 
 //----------------------------------------------------------------------
 // DiskRequestDone
@@ -31,6 +34,44 @@ DiskRequestDone (void* arg)
     disk->RequestDone();
 }
 
+//----------------------------------------------------------------------
+// DiskPolicyNamed
+// 	Find the scheduling policy called "name", for the -ds flag.
+//----------------------------------------------------------------------
+
+static const char *policyNames[] = {"fcfs", "sstf", "scan", "clook"};
+
+bool
+DiskPolicyNamed(const char *name, DiskPolicy *policy)
+{
+    for (int i = DiskFCFS; i <= DiskCLOOK; i++)
+	if (!strcmp(name, policyNames[i])) {
+	    *policy = (DiskPolicy)i;
+	    return true;
+	}
+    return false;
+}
+
+//----------------------------------------------------------------------
+// DiskRequest::DiskRequest
+// 	Initialize a request to read into, or write from, "data".
+//----------------------------------------------------------------------
+
+DiskRequest::DiskRequest(int sectorNumber, char* data, bool isWrite)
+{
+    sector = sectorNumber;
+    buffer = data;
+    writing = isWrite;
+    arrival = stats->totalTicks;
+    done = new Semaphore("disk request", 0);
+    next = NULL;
+}
+
+DiskRequest::~DiskRequest()
+{
+    delete done;
+}
+
 //----------------------------------------------------------------------
 // SynchDisk::SynchDisk
 // 	Initialize the synchronous interface to the physical disk, in turn
@@ -38,12 +79,18 @@ DiskRequestDone (void* arg)
 //
 //	"name" -- UNIX file name to be used as storage for the disk data
 //	   (usually, "DISK")
+//	"whichPolicy" -- how to pick the next request, of those waiting
 //----------------------------------------------------------------------
 
-SynchDisk::SynchDisk(const char* name)
+SynchDisk::SynchDisk(const char* name, DiskPolicy whichPolicy)
 {
-    semaphore = new Semaphore("synch disk", 0);
-    lock = new Lock("synch disk lock");
+    policy = whichPolicy;
+    queue = current = NULL;
+    headTrack = 0;			// the Disk starts at sector 0
+    movingUp = true;
+    started = 0;
+    numRequests = 0;
+    seekTracks = serviceTicks = responseTicks = 0;
     disk = new Disk(name, DiskRequestDone, this);
 }
 
@@ -56,8 +103,6 @@ SynchDisk::SynchDisk(const char* name)
 SynchDisk::~SynchDisk()
 {
     delete disk;
-    delete lock;
-    delete semaphore;
 }
 
 //----------------------------------------------------------------------
@@ -72,10 +117,9 @@ SynchDisk::~SynchDisk()
 void
 SynchDisk::ReadSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->ReadRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    DiskRequest request(sectorNumber, data, false);
+
+    Request(&request);
 }
 
 //----------------------------------------------------------------------
@@ -90,20 +134,150 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
 void
 SynchDisk::WriteSector(int sectorNumber, const char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->WriteRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    DiskRequest request(sectorNumber, (char *)data, true);
+
+    Request(&request);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Request
+// 	Send "request" to the disk, or queue it if the disk is busy, and
+//	wait until it is done.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Request(DiskRequest *request)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    if (current == NULL)
+	Start(request);
+    else {
+	DiskRequest **last = &queue;
+	while (*last != NULL)
+	    last = &(*last)->next;
+	*last = request;
+    }
+    (void) interrupt->SetLevel(oldLevel);
+    request->done->P();			// wait for interrupt
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Start
+// 	Send "request" to the idle disk.  Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Start(DiskRequest *request)
+{
+    int track = request->sector / SectorsPerTrack;
+
+    seekTracks += abs(track - headTrack);
+    if (track != headTrack)
+	movingUp = track > headTrack;
+    headTrack = track;
+    current = request;
+    started = stats->totalTicks;
+    if (request->writing)
+	disk->WriteRequest(request->sector, request->buffer);
+    else
+	disk->ReadRequest(request->sector, request->buffer);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::TakeNext
+// 	Remove from the queue the request the policy serves next, and
+//	return it; NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+DiskRequest *
+SynchDisk::TakeNext()
+{
+    DiskRequest **best = NULL;
+    int bestDistance = 0;
+
+    if (queue == NULL)
+	return NULL;
+    if (policy == DiskSCAN) {		// turn around if nothing is ahead
+	bool ahead = false;
+	for (DiskRequest *r = queue; r != NULL && !ahead; r = r->next) {
+	    int track = r->sector / SectorsPerTrack;
+	    ahead = movingUp ? track >= headTrack : track <= headTrack;
+	}
+	if (!ahead)
+	    movingUp = !movingUp;
+    }
+
+    for (DiskRequest **r = &queue; *r != NULL; r = &(*r)->next) {
+	int track = (*r)->sector / SectorsPerTrack;
+	int distance;
+	switch (policy) {
+	  case DiskFCFS:
+	    distance = 0;
+	    break;
+	  case DiskSSTF:
+	    distance = abs(track - headTrack);
+	    break;
+	  case DiskSCAN:
+	    distance = movingUp ? track - headTrack : headTrack - track;
+	    if (distance < 0)
+		continue;		// behind the head
+	    break;
+	  default:			// DiskCLOOK
+	    // INFO: los que quedaron atras se atienden en la proxima vuelta
+	    distance = track - headTrack;
+	    if (distance < 0)
+		distance += NumTracks;
+	    break;
+	}
+	if (best == NULL || distance < bestDistance) {
+	    best = r;
+	    bestDistance = distance;
+	}
+    }
+
+    DiskRequest *request = *best;
+    *best = request->next;
+    request->next = NULL;
+    return request;
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::RequestDone
-// 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+// 	Disk interrupt handler.  Wake up the thread waiting for the disk
+//	request that finished, and send the next one to the disk.
 //----------------------------------------------------------------------
 
 void
 SynchDisk::RequestDone()
 { 
-    semaphore->V();
+    DiskRequest *request = current;
+
+    numRequests++;
+    serviceTicks += stats->totalTicks - started;
+    responseTicks += stats->totalTicks - request->arrival;
+    current = NULL;
+    request->done->V();
+
+    DiskRequest *next = TakeNext();
+    if (next != NULL)
+	Start(next);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Print
+// 	Print how far the head moved, and how long the requests took,
+//	on average, with the policy in use.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Print()
+{
+    if (numRequests == 0)
+	return;
+    printf("Disk scheduling (%s): %d requests, average seek %.2f tracks, "
+	"service %.1f ticks, response %.1f ticks\n", policyNames[policy],
+	numRequests, (double)seekTracks / numRequests,
+	(double)serviceTicks / numRequests,
+	(double)responseTicks / numRequests);
 }
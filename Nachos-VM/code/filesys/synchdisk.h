@@ -24,9 +24,46 @@
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
 // returning.
+//
+// Requests that arrive while the disk is busy wait in a queue; when
+// the disk finishes one, the scheduling policy picks the next:
+//
+//	FCFS  -- in arrival order
+//	SSTF  -- the one closest to the track of the head
+//	SCAN  -- the closest one in the direction the head moves, turning
+//		 around when there is none (the head only moves to serve
+//		 a request, so it turns at the last one, as LOOK does)
+//	CLOOK -- the closest one towards the higher tracks; after the
+//		 highest, the head goes back to the lowest request
+//
+// Ties are broken in arrival order.  Each thread wakes up when its own
+// request is done.
+
+enum DiskPolicy { DiskFCFS, DiskSSTF, DiskSCAN, DiskCLOOK };
+
+// The policy called "name" ("fcfs", "sstf", "scan" or "clook"), for
+// the -ds flag; false if there is none
+bool DiskPolicyNamed(const char *name, DiskPolicy *policy);
+
+// A thread waiting for the disk
+
+class DiskRequest {
+  public:
+    DiskRequest(int sectorNumber, char *data, bool isWrite);
+    ~DiskRequest();
+
+    int sector;
+    char *buffer;			// where to read to, or write from
+    bool writing;
+    int arrival;			// when it was queued, in ticks
+    Semaphore *done;			// V'ed when the disk is done with it
+    DiskRequest *next;			// in the queue, in arrival order
+};
+
 class SynchDisk {
   public:
-    SynchDisk(const char* name);    	// Initialize a synchronous disk,
+    SynchDisk(const char* name, DiskPolicy whichPolicy = DiskFCFS);
+					// Initialize a synchronous disk,
 					// by initializing the raw Disk.
     ~SynchDisk();			// De-allocate the synch disk data
     
@@ -42,12 +79,27 @@ class SynchDisk {
 					// handler, to signal that the
 					// current disk operation is complete.
 
+    void Print();			// Report the requests served
+
   private:
     Disk *disk;		  		// Raw disk device
-    Semaphore *semaphore; 		// To synchronize requesting thread 
-					// with the interrupt handler
-    Lock *lock;		  		// Only one read/write request
-					// can be sent to the disk at a time
+    DiskPolicy policy;
+    DiskRequest *queue;			// Waiting for the disk, oldest first
+    DiskRequest *current;		// At the disk, NULL if it is idle
+    int headTrack;			// Where the last request left the head
+    bool movingUp;			// Direction of the head, for SCAN
+    int started;			// When "current" went to the disk
+
+    int numRequests;			// Served, for Print
+    long long seekTracks;		// Tracks the head moved to them
+    long long serviceTicks;		// Time at the disk
+    long long responseTicks;		// Time since they were asked for
+
+    void Request(DiskRequest *request);	// Queue it, wait for it
+    void Start(DiskRequest *request);	// Send it to the disk
+    DiskRequest *TakeNext();		// Remove the next one from the queue
 };
 
+extern SynchDisk *synchDisk;		// Only with FILESYS
+
 #endif // SYNCHDISK_H
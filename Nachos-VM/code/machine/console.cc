@@ -82,6 +82,9 @@ Console::~Console()
 //	character has been grabbed out of the buffer by the Nachos kernel).
 //	Invoke the "read" interrupt handler, once the character has been 
 //	put into the buffer. 
+//
+//	At the end of the input file nobody is ever going to type
+//	again, so stop polling.
 //----------------------------------------------------------------------
 
 void
@@ -89,16 +92,19 @@ Console::CheckCharAvail()
 {
     char c;
 
-    // schedule the next time to poll for a packet
-    interrupt->Schedule(ConsoleReadPoll, this, ConsoleTime, 
-			ConsoleReadInt);
-
     // do nothing if character is already buffered, or none to be read
-    if ((incoming != EOF) || !PollFile(readFileNo))
+    if ((incoming != EOF) || !PollFile(readFileNo)) {
+	// schedule the next time to poll for a packet
+	interrupt->Schedule(ConsoleReadPoll, this, ConsoleTime, 
+			    ConsoleReadInt);
 	return;	  
+    }
 
     // otherwise, read character and tell user about it
-    Read(readFileNo, &c, sizeof(char));
+    if (ReadPartial(readFileNo, &c, sizeof(char)) != sizeof(char))
+	return;				// end of the input
+    interrupt->Schedule(ConsoleReadPoll, this, ConsoleTime, 
+			ConsoleReadInt);
     incoming = c ;
     stats->numConsoleCharsRead++;
     (*readHandler)(handlerArg);	
@@ -28,7 +28,8 @@
 
 static const char *intLevelNames[] = { "off", "on"};
 static const char *intTypeNames[] = { "timer", "disk", "console write", 
-				      "console read", "network send", "network recv"};
+				      "console read", "network send", "network recv",
+				      "alarm"};
 
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
@@ -48,6 +49,8 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, void* param, int time,
     arg = param;
     when = time;
     type = kind;
+    seq = 0;
+    next = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -60,7 +63,13 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, void* param, int time,
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List<PendingInterrupt*>;
+    maxPending = InitialPendingInterrupts;
+    pending = new PendingInterrupt*[maxPending];
+    numPending = 0;
+    nextSeq = 0;
+    freeNodes = NULL;
+    for (int i = 0; i < InitialPendingInterrupts; i++)
+	FreePending(new PendingInterrupt(NULL, NULL, 0, TimerInt));
     inHandler = false;
     yieldOnReturn = false;
     status = SystemMode;
@@ -73,9 +82,139 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty())
-	delete pending->Remove();
-    delete pending;
+    while (numPending > 0)
+	delete pending[--numPending];
+    delete [] pending;
+    while (freeNodes != NULL) {
+	PendingInterrupt *p = freeNodes;
+	freeNodes = p->next;
+	delete p;
+    }
+}
+
+//----------------------------------------------------------------------
+// Interrupt::NewPending, Interrupt::FreePending
+// 	Get a PendingInterrupt node from the free list (allocating one
+//	only if the list is empty), and give it back once it has fired.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+Interrupt::NewPending(VoidFunctionPtr func, void* param, int time, 
+			IntType kind)
+{
+    PendingInterrupt *p = freeNodes;
+
+    if (p == NULL)
+	return new PendingInterrupt(func, param, time, kind);
+    freeNodes = p->next;
+    p->handler = func;
+    p->arg = param;
+    p->when = time;
+    p->type = kind;
+    p->next = NULL;
+    return p;
+}
+
+void
+Interrupt::FreePending(PendingInterrupt *p)
+{
+    p->next = freeNodes;
+    freeNodes = p;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Earlier
+// 	Heap order: true if "a" must fire before "b".
+//----------------------------------------------------------------------
+
+bool
+Interrupt::Earlier(PendingInterrupt *a, PendingInterrupt *b)
+{
+    if (a->when != b->when)
+	return a->when < b->when;
+    return (int)(a->seq - b->seq) < 0;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::PushPending
+// 	Put an interrupt in the heap, growing it if needed.
+//----------------------------------------------------------------------
+
+void
+Interrupt::PushPending(PendingInterrupt *p)
+{
+    if (numPending == maxPending) {
+	PendingInterrupt **bigger = new PendingInterrupt*[maxPending * 2];
+	for (int i = 0; i < numPending; i++)
+	    bigger[i] = pending[i];
+	delete [] pending;
+	pending = bigger;
+	maxPending *= 2;
+    }
+
+    int i = numPending++;
+    while (i > 0) {			// sift up
+	int parent = (i - 1) / 2;
+	if (!Earlier(p, pending[parent]))
+	    break;
+	pending[i] = pending[parent];
+	i = parent;
+    }
+    pending[i] = p;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::PopPending
+// 	Remove the interrupt that has to fire first from the heap.
+//	Returns NULL if there are no pending interrupts.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+Interrupt::PopPending()
+{
+    if (numPending == 0)
+	return NULL;
+
+    PendingInterrupt *first = pending[0];
+    PendingInterrupt *last = pending[--numPending];
+    int i = 0;
+
+    while (2 * i + 1 < numPending) {	// sift down
+	int child = 2 * i + 1;
+	if (child + 1 < numPending && Earlier(pending[child + 1], pending[child]))
+	    child++;
+	if (!Earlier(pending[child], last))
+	    break;
+	pending[i] = pending[child];
+	i = child;
+    }
+    if (numPending > 0)
+	pending[i] = last;
+    return first;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::OnlyPolling
+// 	Returns true if every pending interrupt just checks whether a
+//	device has something to do: the timer, or the keyboard of the
+//	console while no thread waits for input.  None of those can make
+//	a thread runnable, so once the ready list is empty, Nachos is done.
+//----------------------------------------------------------------------
+
+bool
+Interrupt::OnlyPolling()
+{
+    for (int i = 0; i < numPending; i++) {
+	if (pending[i]->type == TimerInt)
+	    continue;
+#ifdef USER_PROGRAM
+	if (pending[i]->type == ConsoleReadInt && synchConsole != NULL
+				&& !synchConsole->WaitingForInput())
+	    continue;
+#endif
+	return false;
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------
@@ -169,6 +308,9 @@ Interrupt::OneTick()
     while (CheckIfDue(false))		// check for pending interrupts
 	;
     ChangeLevel(IntOff, IntOn);		// re-enable interrupts
+    if (preemptiveScheduler != NULL && status != IdleMode &&
+	preemptiveScheduler->CheckPreemption())
+	yieldOnReturn = true;		// the host timer says time is up
     if (yieldOnReturn) {		// if the timer device handler asked 
 					// for a context switch, ok to do it now
 	yieldOnReturn = false;
@@ -212,6 +354,9 @@ Interrupt::Idle()
 {
     DEBUG('i', "Machine idling; checking for interrupts.\n");
     status = IdleMode;
+#ifdef USER_PROGRAM
+    consoleWriter->Flush();		// nobody is going to add to it now
+#endif
     if (CheckIfDue(true)) {		// check for any pending interrupts
     	while (CheckIfDue(false))	// check for any other pending 
 	    ;				// interrupts
@@ -225,7 +370,8 @@ Interrupt::Idle()
     // if there are no pending interrupts, and nothing is on the ready
     // queue, it is time to stop.   If the console or the network is 
     // operating, there are *always* pending interrupts, so this code
-    // is not reached.  Instead, the halt must be invoked by the user program.
+    // is not reached.  Instead, the halt must be invoked by the user program
+    // (except for the polling of the SynchConsole, see OnlyPolling).
 
     DEBUG('i', "Machine idle.  No interrupts to do.\n");
     printf("No threads ready or runnable, and no pending interrupts.\n");
@@ -240,6 +386,9 @@ Interrupt::Idle()
 void
 Interrupt::Halt()
 {
+#ifdef USER_PROGRAM
+    consoleWriter->Flush();
+#endif
     printf("Machine halting!\n\n");
     stats->Print();
     Cleanup();     // Never returns.
@@ -250,7 +399,7 @@ Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it on a heap, ordered by time.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -265,13 +414,14 @@ void
 Interrupt::Schedule(VoidFunctionPtr handler, void* arg, int fromNow, IntType type)
 {
     int when = stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
+    PendingInterrupt *toOccur = NewPending(handler, arg, when, type);
 
     DEBUG('i', "Scheduling interrupt handler the %s at time = %d\n", 
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    toOccur->seq = nextSeq++;
+    PushPending(toOccur);
 }
 
 //----------------------------------------------------------------------
@@ -291,32 +441,30 @@ bool
 Interrupt::CheckIfDue(bool advanceClock)
 {
     MachineStatus old = status;
-    int when;
 
     ASSERT(level == IntOff);		// interrupts need to be disabled,
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		pending->SortedRemove(&when);
 
-    if (toOccur == NULL)		// no pending interrupts
+    if (numPending == 0)		// no pending interrupts
 	return false;			
 
+    PendingInterrupt *toOccur = pending[0];	// just peek at the first one
+    int when = toOccur->when;
+
     if (advanceClock && when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
 	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks) {	// not time yet, leave it there
 	return false;
     }
 
 // Check if there is nothing more to do, and if so, quit
-    if ((status == IdleMode) && (toOccur->type == TimerInt) 
-				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+    if ((status == IdleMode) && OnlyPolling())
 	 return false;
-    }
+
+    (void) PopPending();
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n", 
 			intTypeNames[toOccur->type], toOccur->when);
@@ -331,7 +479,7 @@ Interrupt::CheckIfDue(bool advanceClock)
     (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
     status = old;				// restore the machine status
     inHandler = false;
-    delete toOccur;
+    FreePending(toOccur);
     return true;
 }
 
@@ -361,7 +509,8 @@ Interrupt::DumpState()
 					intLevelNames[level]);
     printf("Pending interrupts:\n");
     fflush(stdout);
-    pending->Apply(PrintPending);
+    for (int i = 0; i < numPending; i++)	// heap order, not time order
+	PrintPending(pending[i]);
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
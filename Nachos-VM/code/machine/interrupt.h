@@ -55,7 +55,8 @@ enum IntType {
   ConsoleWriteInt,
   ConsoleReadInt,
   NetworkSendInt,
-  NetworkRecvInt
+  NetworkRecvInt,
+  AlarmInt
 };
 
 // The following class defines an interrupt that is scheduled
@@ -73,8 +74,14 @@ public:
   void *arg;    // The argument to the function.
   int when;     // When the interrupt is supposed to fire
   IntType type; // for debugging
+  unsigned seq; // Order of scheduling, breaks ties in "when"
+  PendingInterrupt *next; // Next free node, while not scheduled
 };
 
+// Number of PendingInterrupt nodes allocated up front; devices rarely
+// have more than a few interrupts scheduled at once.
+const int InitialPendingInterrupts = 32;
+
 // The following class defines the data structures for the simulation
 // of hardware interrupts.  We record whether interrupts are enabled
 // or disabled, and any hardware interrupts that are scheduled to occur
@@ -121,9 +128,24 @@ public:
   void OneTick(); // Advance simulated time
 
 private:
-  IntStatus level;                   // are interrupts enabled or disabled?
-  List<PendingInterrupt *> *pending; // the list of interrupts scheduled
-                                     // to occur in the future
+  IntStatus level; // are interrupts enabled or disabled?
+
+  // The interrupts scheduled to occur in the future are kept in a
+  // binary min-heap, ordered by "when" (and "seq", so that interrupts
+  // scheduled for the same time fire in the order they were scheduled).
+  PendingInterrupt **pending; // the heap
+  int numPending;             // interrupts in the heap
+  int maxPending;             // size of the heap array
+  unsigned nextSeq;           // sequence number for the next Schedule
+  PendingInterrupt *freeNodes; // nodes not in use, to avoid new/delete
+
+  PendingInterrupt *NewPending(VoidFunctionPtr func, void *param, int time,
+                               IntType kind);
+  void FreePending(PendingInterrupt *p);
+  bool Earlier(PendingInterrupt *a, PendingInterrupt *b);
+  void PushPending(PendingInterrupt *p); // add to the heap
+  PendingInterrupt *PopPending();        // remove the earliest one
+  bool OnlyPolling(); // can no pending interrupt wake up a thread?
   bool inHandler;     // true if we are running an interrupt handler
   bool yieldOnReturn; // true if we are to context switch
                       // on return from the interrupt handler
@@ -33,7 +33,8 @@ const int PageSize = SectorSize; // set the page size equal to
                                  // the disk sector size, for
                                  // simplicity
 
-const int MaxNumProcesses = 128;
+// Upper bound for the process table, it starts small and grows as needed
+const int MaxNumProcesses = 1 << 16;
 #ifdef VM
 const int NumPhysPages = 64;
 #else
@@ -174,12 +175,12 @@ public:
   // NOTE: the hardware translation of virtual addresses in the user program
   // to physical addresses (relative to the beginning of "mainMemory")
   // can be controlled by one of:
-  //	a traditional linear page table
+  //	a two-level page table (see translate.h)
   //  	a software-loaded translation lookaside buffer (tlb) -- a cache
   //  of
   //	  mappings of virtual page #'s to physical page #'s
   //
-  // If "tlb" is NULL, the linear page table is used
+  // If "tlb" is NULL, the page table is used
   // If "tlb" is non-NULL, the Nachos kernel is responsible for managing
   //	the contents of the TLB.  But the kernel can use any data structure
   //	it wants (eg, segmented paging) for handling TLB cache misses.
@@ -196,8 +197,7 @@ public:
   int nextTLB;
   int nextMem;
 
-  TranslationEntry *pageTable;
-  unsigned int pageTableSize;
+  PageTable *pageTable;
 
 private:
   bool singleStep;  // drop back into the debugger after each
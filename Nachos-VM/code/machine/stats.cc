@@ -10,6 +10,13 @@
 #include "copyright.h"
 #include "utility.h"
 #include "stats.h"
+#include "syncprofile.h"
+#ifdef USER_PROGRAM
+#include "syscalltable.h"
+#endif
+#ifdef FILESYS
+#include "synchdisk.h"
+#endif
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -22,6 +29,16 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numThreadsCreated = numStacksMapped = numStacksReused = 0;
+    maxStackUsage = numPreemptions = 0;
+    numUserBytesCopied = numUserCopyTranslations = 0;
+    numConsoleBytesBuffered = numConsoleFlushes = 0;
+    numIoRequests = numIoEnters = numIoBatches = 0;
+    numPipeBytes = 0;
+    numMappedPagesIn = numMappedPagesOut = 0;
+    numExecCacheHits = numExecCacheMisses = 0;
+    numBatches = numBatchedSyscalls = 0;
+    numBufferCacheHits = numBufferCacheMisses = numBufferWritesBack = 0;
 }
 
 //----------------------------------------------------------------------
@@ -41,4 +58,43 @@ Statistics::Print()
     printf("Paging: faults %d\n", numPageFaults);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
+    if (numStacksMapped > 0)
+	printf("Threads: created %d, stacks mapped %d, reused %d, "
+	    "max stack used %d bytes\n", numThreadsCreated, numStacksMapped,
+	    numStacksReused, maxStackUsage);
+    if (numPreemptions > 0)
+	printf("Preemptions: %d\n", numPreemptions);
+    if (numUserCopyTranslations > 0)
+	printf("User memory: %d bytes moved, %d page translations\n",
+	    numUserBytesCopied, numUserCopyTranslations);
+    if (numConsoleFlushes > 0)
+	printf("Console output: %d bytes in %d host writes\n",
+	    numConsoleBytesBuffered, numConsoleFlushes);
+    if (numIoRequests > 0)
+	printf("Asynchronous I/O: %d operations, %d IoEnter calls, "
+	    "%d worker batches\n", numIoRequests, numIoEnters, numIoBatches);
+    if (numPipeBytes > 0)
+	printf("Pipes: %d bytes\n", numPipeBytes);
+    if (numMappedPagesIn > 0)
+	printf("Mapped files: %d pages read, %d written back\n",
+	    numMappedPagesIn, numMappedPagesOut);
+    if (numExecCacheHits > 0)
+	printf("Exec cache: %d hits, %d misses\n", numExecCacheHits,
+	    numExecCacheMisses);
+    if (numBatches > 0)
+	printf("Batches: %d, with %d system calls\n", numBatches,
+	    numBatchedSyscalls);
+    if (numBufferCacheHits + numBufferCacheMisses + numBufferWritesBack > 0)
+	printf("Buffer cache: %d hits, %d misses, %d sectors written back\n",
+	    numBufferCacheHits, numBufferCacheMisses, numBufferWritesBack);
+    if (syncProfiler != NULL)
+	syncProfiler->Print();
+#ifdef USER_PROGRAM
+    if (syscallProfiler != NULL)
+	syscallProfiler->Print();
+#endif
+#ifdef FILESYS
+    if (synchDisk != NULL)
+	synchDisk->Print();
+#endif
 }
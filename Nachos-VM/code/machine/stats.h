@@ -35,6 +35,28 @@ class Statistics {
     int numPageFaults;		// number of virtual memory page faults
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
+    int numThreadsCreated;	// number of Thread objects allocated
+    int numStacksMapped;	// stacks obtained from the host
+    int numStacksReused;	// stacks taken from the thread pool
+    int maxStackUsage;		// deepest any thread stack went (bytes)
+    int numPreemptions;		// time slices expired (-p)
+    int numUserBytesCopied;	// bytes moved in and out of user memory
+    int numUserCopyTranslations; // ... and pages translated to copy them
+    int numConsoleBytesBuffered; // console output written by user programs
+    int numConsoleFlushes;	// ... and host writes done for it
+    int numIoRequests;		// asynchronous I/O operations submitted
+    int numIoEnters;		// ... IoEnter calls that submitted them
+    int numIoBatches;		// ... batches the I/O worker took
+    int numPipeBytes;		// bytes written to pipes
+    int numMappedPagesIn;	// pages of mapped files read on faults
+    int numMappedPagesOut;	// ... and written back to them
+    int numExecCacheHits;	// Exec of a program already read
+    int numExecCacheMisses;	// ... and of one read from its file
+    int numBatches;		// Batch system calls
+    int numBatchedSyscalls;	// ... and the calls they made
+    int numBufferCacheHits;	// sectors read from the buffer cache
+    int numBufferCacheMisses;	// ... and from the disk
+    int numBufferWritesBack;	// dirty sectors written to the disk
 
     Statistics(); 		// initialize everything to zero
 
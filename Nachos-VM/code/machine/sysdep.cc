@@ -33,7 +33,9 @@ extern "C" {
 #include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
+#include <time.h>
 #ifdef HOST_i386
 #include <sys/time.h>
 #endif
@@ -156,6 +158,41 @@ void WriteFile(int fd, const char *buffer, int nBytes) {
   ASSERT(retVal == nBytes);
 }
 
+//----------------------------------------------------------------------
+// ReadScatter, WriteGather
+// 	Read into, or write from, "count" buffers with a single host
+//	system call.  Buffer i has "sizes[i]" bytes.  If "offset" is not
+//	-1, the transfer happens at that position of the file, and the
+//	file position is left alone.  Returns the number of bytes
+//	transferred, or -1 on error.
+//----------------------------------------------------------------------
+
+static struct iovec *HostIoVecs(char **buffers, int *sizes, int count) {
+  struct iovec *iov = new struct iovec[count > 0 ? count : 1];
+
+  for (int i = 0; i < count; i++) {
+    iov[i].iov_base = buffers[i];
+    iov[i].iov_len = sizes[i];
+  }
+  return iov;
+}
+
+int ReadScatter(int fd, char **buffers, int *sizes, int count, int offset) {
+  struct iovec *iov = HostIoVecs(buffers, sizes, count);
+  int retVal = (offset == -1) ? readv(fd, iov, count)
+                              : preadv(fd, iov, count, offset);
+  delete[] iov;
+  return retVal;
+}
+
+int WriteGather(int fd, char **buffers, int *sizes, int count, int offset) {
+  struct iovec *iov = HostIoVecs(buffers, sizes, count);
+  int retVal = (offset == -1) ? writev(fd, iov, count)
+                              : pwritev(fd, iov, count, offset);
+  delete[] iov;
+  return retVal;
+}
+
 //----------------------------------------------------------------------
 // Lseek
 // 	Change the location within an open file.  Abort on error.
@@ -196,6 +233,16 @@ void Close(int fd) {
 
 bool Unlink(const char *name) { return unlink(name); }
 
+//----------------------------------------------------------------------
+// CurrentDirectory
+// 	Put the absolute path of the working directory in "buffer", of
+//	"size" bytes.  Returns false if it does not fit.
+//----------------------------------------------------------------------
+
+bool CurrentDirectory(char *buffer, int size) {
+  return getcwd(buffer, size) != NULL;
+}
+
 //----------------------------------------------------------------------
 // OpenSocket
 // 	Open an interprocess communication (IPC) connection.  For now,
@@ -325,6 +372,19 @@ void CallOnUserAbort(VoidNoArgFunctionPtr func) {
 
 void Delay(int seconds) { (void)sleep((unsigned)seconds); }
 
+//----------------------------------------------------------------------
+// HostNanoseconds
+// 	Return the host monotonic clock, in nanoseconds.  Only the
+//	difference between two readings means anything.
+//----------------------------------------------------------------------
+
+long long HostNanoseconds() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
@@ -363,17 +423,22 @@ int Random() { return rand(); }
 //
 //	Note: Just return the useful part!
 //
+//	The array is mapped on its own, so that the boundary pages are
+//	page aligned and can be protected on every host.  Thread stacks
+//	are recycled by the ThreadPool, so this is not done very often.
+//
 //	"size" -- amount of useful space needed (in bytes)
 //----------------------------------------------------------------------
 
 char *AllocBoundedArray(int size) {
   int pgSize = getpagesize();
-  char *ptr = new char[pgSize * 2 + size];
+  int length = (size + pgSize - 1) / pgSize * pgSize;
+  char *ptr = (char *)mmap(NULL, pgSize * 2 + length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
-#ifndef HOST_LINUX
-  mprotect(ptr, pgSize, 0);
-  mprotect(ptr + pgSize + size, pgSize, 0);
-#endif
+  ASSERT(ptr != MAP_FAILED);
+  mprotect(ptr, pgSize, PROT_NONE);
+  mprotect(ptr + pgSize + length, pgSize, PROT_NONE);
   return ptr + pgSize;
 }
 
@@ -387,10 +452,7 @@ char *AllocBoundedArray(int size) {
 
 void DeallocBoundedArray(const char *ptr, int size) {
   int pgSize = getpagesize();
+  int length = (size + pgSize - 1) / pgSize * pgSize;
 
-#ifndef HOST_LINUX
-  mprotect(ptr - pgSize, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-  mprotect(ptr + size, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-#endif
-  delete[] (ptr - pgSize);
+  munmap((char *)ptr - pgSize, pgSize * 2 + length);
 }
@@ -24,10 +24,15 @@ extern int OpenForReadWrite(const char *name, bool crashOnError);
 extern void Read(int fd, char *buffer, int nBytes);
 extern int ReadPartial(int fd, char *buffer, int nBytes);
 extern void WriteFile(int fd, const char *buffer, int nBytes);
+extern int ReadScatter(int fd, char **buffers, int *sizes, int count,
+                       int offset);
+extern int WriteGather(int fd, char **buffers, int *sizes, int count,
+                       int offset);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
 extern void Close(int fd);
 extern bool Unlink(const char *name);
+extern bool CurrentDirectory(char *buffer, int size);
 
 // Interprocess communication operations, for simulating the network
 extern int OpenSocket();
@@ -43,6 +48,9 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Host monotonic clock, in nanoseconds, for measuring real time
+extern long long HostNanoseconds();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 
@@ -6,8 +6,10 @@
 //
 // Two types of translation are supported here.
 //
-//	Linear page table -- the virtual page # is used as an index
-//	into the table, to find the physical page #.
+//	Two-level page table -- the high bits of the virtual page # are
+//	an index into the page directory, to find the table of the page,
+//	and the low bits are an index into that table, to find the
+//	physical page #.
 //
 //	Translation lookaside buffer -- associative lookup in the table
 //	to find an entry with the same virtual page #.  If found,
@@ -78,6 +80,109 @@ unsigned short ShortToMachine(unsigned short shortword) {
   return ShortToHost(shortword);
 }
 
+//----------------------------------------------------------------------
+// PageTable::PageTable
+// 	Initialize a page table with no pages mapped: an empty page
+//	directory.
+//----------------------------------------------------------------------
+
+PageTable::PageTable() {
+  for (int i = 0; i < PageDirectoryEntries; i++) {
+    directory[i] = NULL;
+    used[i] = 0;
+  }
+  numMapped = 0;
+}
+
+PageTable::~PageTable() {
+  for (int i = 0; i < PageDirectoryEntries; i++)
+    delete[] directory[i];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Lookup
+// 	Walk the two levels of the table to find the entry of "vpn".
+//	Returns NULL if "vpn" is not mapped.
+//----------------------------------------------------------------------
+
+TranslationEntry *PageTable::Lookup(unsigned int vpn) {
+  if (vpn >= (unsigned)NumVirtPages)
+    return NULL;
+  TranslationEntry *table = directory[vpn / PageTableEntries];
+  if (table == NULL || table[vpn % PageTableEntries].virtualPage == -1)
+    return NULL;
+  return &table[vpn % PageTableEntries];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Map
+// 	Add "vpn" to the table, allocating its second level table if
+//	needed.  The entry is returned cleared and not valid, for the
+//	caller to fill in.  Returns NULL if "vpn" is out of range.
+//----------------------------------------------------------------------
+
+TranslationEntry *PageTable::Map(unsigned int vpn) {
+  if (vpn >= (unsigned)NumVirtPages)
+    return NULL;
+  int dir = vpn / PageTableEntries;
+  if (directory[dir] == NULL) {
+    directory[dir] = new TranslationEntry[PageTableEntries];
+    for (int i = 0; i < PageTableEntries; i++)
+      directory[dir][i].virtualPage = -1;
+  }
+  TranslationEntry *entry = &directory[dir][vpn % PageTableEntries];
+  if (entry->virtualPage == -1) {
+    used[dir]++;
+    numMapped++;
+  }
+  entry->virtualPage = vpn;
+  entry->physicalPage = -1;
+  entry->swapSector = -1;
+  entry->valid = false;
+  entry->readOnly = false;
+  entry->use = false;
+  entry->dirty = false;
+  return entry;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Unmap
+// 	Take "vpn" out of the table.  A second level table left without
+//	pages is de-allocated.
+//----------------------------------------------------------------------
+
+void PageTable::Unmap(unsigned int vpn) {
+  if (Lookup(vpn) == NULL)
+    return;
+  int dir = vpn / PageTableEntries;
+  directory[dir][vpn % PageTableEntries].virtualPage = -1;
+  numMapped--;
+  if (--used[dir] == 0) {
+    delete[] directory[dir];
+    directory[dir] = NULL;
+  }
+}
+
+//----------------------------------------------------------------------
+// PageTable::NextMapped
+// 	Find the first mapped page from "vpn" on, skipping the empty
+//	second level tables; to go through the mapped pages in order.
+//----------------------------------------------------------------------
+
+int PageTable::NextMapped(unsigned int vpn) {
+  while (vpn < (unsigned)NumVirtPages) {
+    TranslationEntry *table = directory[vpn / PageTableEntries];
+    if (table == NULL) {
+      vpn = (vpn / PageTableEntries + 1) * PageTableEntries;
+      continue;
+    }
+    if (table[vpn % PageTableEntries].virtualPage != -1)
+      return vpn;
+    vpn++;
+  }
+  return -1;
+}
+
 //----------------------------------------------------------------------
 // Machine::ReadMem
 //      Read "size" (1, 2, or 4) bytes of virtual memory at "addr" into
@@ -266,17 +371,18 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
 
 #endif
 
-  if (tlb == NULL) { // => page table => vpn is index into table
-    if (vpn >= pageTableSize) {
-      DEBUG('a', "virtual page # %d too large for page table size %d!\n",
-            virtAddr, pageTableSize);
-      return AddressErrorException;
-    } else if (!pageTable[vpn].valid) {
+  if (tlb == NULL) { // => page table => walk its two levels
+    entry = pageTable->Lookup(vpn);
+    if (entry == NULL) {
+      // INFO: el kernel decide si la pagina es parte del espacio (el stack
+      // que crece) o es un error de direccion
+      DEBUG('a', "virtual page # %d not mapped!\n", virtAddr);
+      return PageFaultException;
+    } else if (!entry->valid) {
       DEBUG('a', "virtual page # %d not valid!\n", virtAddr);
       // MapitaBits->Print();
       return PageFaultException;
     }
-    entry = currentThread->space->EntryFromVirtPage(vpn);
     DEBUG('l', "Encontrada la pagina virtual %d\n", vpn);
 
   } else {
@@ -293,8 +399,9 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
       DEBUG('2', "\t-- NOT ON TLB [VPN %d]\n", vpn);
       TranslationEntry *page = currentThread->space->EntryFromVirtPage(vpn);
       if (page == NULL) {
-        DEBUG('2', "\t-- NOT ON MAHCINE [VPN %d]!!!!\n", vpn);
-        return BusErrorException;
+        // INFO: no es parte del espacio, el kernel decide (ver HandleFault)
+        DEBUG('2', "\t-- NOT MAPPED [VPN %d]\n", vpn);
+        return PageFaultException;
       }
       if (page->valid) {
         DEBUG('3', "\t-- ON MEM[%d] : [VPN %d]\n", page->physicalPage,
@@ -309,75 +416,45 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
         int mem_frame = MapitaBits->Find();
         if (mem_frame == -1) {
           DEBUG('3', "\t-- NOT SPACE FOR [VPN %d] ON MEM\n", page->virtualPage);
-          int tlb_f;
           mem_frame = secondChance(MemRef, nextMem, NumPhysPages, "FOR MEM");
           nextMem = mem_frame;
-          TranslationEntry *e =
-              currentThread->space->EntryFromPhysPage(mem_frame);
-          if (e != NULL) {
-            for (tlb_f = 0; tlb_f < TLBSize; tlb_f++) {
-              if (this->tlb[tlb_f].physicalPage == mem_frame &&
-                  this->tlb[tlb_f].valid) {
-                break;
-              }
-            }
-            DEBUG('4', "\t>> Checking if [VPN %d] DIRTY: %s\n", e->virtualPage,
-                  (e->dirty) ? "TRUE" : "FALSE");
-
-            if (e->dirty == true) {
-              int mem_offset = e->physicalPage * PageSize;
-              int swap_offset = e->swapSector * SectorSize;
-
-              DEBUG('4', "\t-- MEM[%d] : [VPN %d] -> SWAP [%d]\n",
-                    e->physicalPage, e->virtualPage, e->swapSector);
-              DEBUG('4', "MEM:");
-              for (int byte = 0; byte < PageSize; byte++) {
-                DEBUG('4', "%x", this->mainMemory[mem_offset + byte]);
-              }
-              DEBUG('4', " >> SWAP:");
-              for (int byte = 0; byte < PageSize; byte++) {
-                DEBUG('4', "%x", swapSpace[swap_offset + byte]);
-              }
-              DEBUG('4', "\n");
-
-              for (int byte = 0; byte < PageSize; byte++) {
-                swapSpace[swap_offset + byte] =
-                    this->mainMemory[mem_offset + byte];
-              }
-
-              e->dirty = false;
-              this->tlb[tlb_f].dirty = false;
-            }
-            DEBUG('5', "\t-- TLB[%d] : VPN[%d] -> INVALID\n", tlb_f,
-                  e->virtualPage);
-            this->tlb[tlb_f].valid = false;
-            this->tlb[tlb_f].physicalPage = -1;
-            DEBUG('5', "\t-- MEM[%d] : VPN[%d] -> INVALID\n", mem_frame,
-                  e->virtualPage);
-            e->valid = false;
-            e->physicalPage = -1;
-          }
+          // INFO: el core map sabe quien usa el marco, aunque sea otro
+          // proceso o un segmento compartido, y lo invalida donde este
+          coreMap->Evict(mem_frame);
         }
-        page->physicalPage = mem_frame;
-        page->valid = true;
-        DEBUG('3', "\t-- NOT ON MEM [VPN %d]\n", vpn);
-        int mem_offset = page->physicalPage * PageSize;
-        int swap_offset = page->swapSector * SectorSize;
-        DEBUG('4', "\t-- SWAP [%d] : [VPN %d] -> MEM[%d]\n", page->swapSector,
-              page->virtualPage, page->physicalPage);
-
-        DEBUG('4', "SWAP:");
-        for (int byte = 0; byte < PageSize; byte++) {
-          DEBUG('4', "%x", swapSpace[swap_offset + byte]);
-        }
-        DEBUG('4', " >> MEM:");
-        for (int byte = 0; byte < PageSize; byte++) {
-          DEBUG('4', "%x", this->mainMemory[mem_offset + byte]);
-        }
-        DEBUG('4', "\n");
+        SharedSegment *segment;
+        MappedFile *file;
+        int segmentPage;
+        if (currentThread->space->SharedPageOf(vpn, &segment, &segmentPage)) {
+          // INFO: se carga una vez para todos los procesos que la comparten
+          segment->Load(segmentPage, mem_frame);
+        } else if (currentThread->space->MappedPageOf(vpn, &file,
+                                                      &segmentPage)) {
+          // INFO: la pagina de un archivo mapeado viene del archivo
+          currentThread->space->LoadMappedPage(vpn, mem_frame);
+        } else {
+          page->physicalPage = mem_frame;
+          page->valid = true;
+          DEBUG('3', "\t-- NOT ON MEM [VPN %d]\n", vpn);
+          int mem_offset = page->physicalPage * PageSize;
+          int swap_offset = page->swapSector * SectorSize;
+          DEBUG('4', "\t-- SWAP [%d] : [VPN %d] -> MEM[%d]\n", page->swapSector,
+                page->virtualPage, page->physicalPage);
+
+          DEBUG('4', "SWAP:");
+          for (int byte = 0; byte < PageSize; byte++) {
+            DEBUG('4', "%x", swapSpace[swap_offset + byte]);
+          }
+          DEBUG('4', " >> MEM:");
+          for (int byte = 0; byte < PageSize; byte++) {
+            DEBUG('4', "%x", this->mainMemory[mem_offset + byte]);
+          }
+          DEBUG('4', "\n");
 
-        for (int byte = 0; byte < PageSize; byte++) {
-          this->mainMemory[mem_offset + byte] = swapSpace[swap_offset + byte];
+          for (int byte = 0; byte < PageSize; byte++) {
+            this->mainMemory[mem_offset + byte] = swapSpace[swap_offset + byte];
+          }
+          coreMap->MapPrivate(mem_frame, currentThread->space, vpn);
         }
       }
     }
@@ -461,7 +538,8 @@ ExceptionType Machine::Translate(int virtAddr, int *physAddr, int size,
 #endif
 
     DEBUG('1', "PT:\n");
-    for (i = 0; i < currentThread->space->numPages; i++) {
+    for (i = currentThread->space->NextPage(0); i != -1;
+         i = currentThread->space->NextPage(i + 1)) {
       TranslationEntry pt = *currentThread->space->EntryFromVirtPage(i);
       DEBUG('1', "[%d] VP %d | PP %d | SWP %d | VAL %d | DTY %d : ", i,
             pt.virtualPage, pt.physicalPage, pt.swapSector, pt.valid, pt.dirty);
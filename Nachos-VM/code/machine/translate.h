@@ -45,4 +45,34 @@ public:
   int swapSector;
 };
 
+// The page table of an address space, as the hardware walks it: a
+// directory whose entries point to second level tables of
+// PageTableEntries translations each.  A second level table is only
+// allocated once one of its pages is mapped, so an address space can
+// leave big holes in its NumVirtPages pages (between the heap and the
+// stack, for instance) without paying for them.
+
+const int PageDirectoryEntries = 64;
+const int PageTableEntries = 64;
+const int NumVirtPages = PageDirectoryEntries * PageTableEntries;
+
+class PageTable {
+public:
+  PageTable();  // nothing mapped
+  ~PageTable(); // de-allocate the second level tables
+
+  TranslationEntry *Lookup(unsigned int vpn); // NULL if not mapped
+  TranslationEntry *Map(unsigned int vpn);    // add "vpn", not valid
+                                              // yet; NULL if too big
+  void Unmap(unsigned int vpn);               // take "vpn" out
+  int NextMapped(unsigned int vpn); // first mapped page from "vpn"
+                                    // on, -1 if none
+  int NumMapped() { return numMapped; }
+
+private:
+  TranslationEntry *directory[PageDirectoryEntries]; // NULL if empty
+  int used[PageDirectoryEntries]; // pages mapped in each table
+  int numMapped;
+};
+
 #endif
@@ -0,0 +1,82 @@
+#include "syscall.h"
+
+/*
+ * Prueba de la E/S asincrona: pone varias escrituras de bloques en el
+ * anillo y las entrega todas con un solo IoEnter, despues las lee de
+ * vuelta en orden inverso y compara lo leido con lo escrito.
+ */
+
+#define BLOCKS 8
+#define BLOCK_SIZE 32
+
+IoRing ring;
+char blocks[BLOCKS][BLOCK_SIZE];
+char check[BLOCKS][BLOCK_SIZE];
+
+void Submit(int opcode, OpenFileId file, char *buffer, int block) {
+  IoSubmission *sub = &ring.sq[ring.sqTail % IoRingEntries];
+
+  sub->opcode = opcode;
+  sub->id = file;
+  sub->buffer = buffer;
+  sub->size = BLOCK_SIZE;
+  sub->offset = block * BLOCK_SIZE;
+  sub->userData = block;
+  ring.sqTail++;
+}
+
+/* Consume las completaciones, cuenta las que transfirieron un bloque */
+int Drain(int expected) {
+  int good = 0;
+  IoCompletion *cqe;
+
+  IoEnter(0, expected);
+  while (ring.cqHead != ring.cqTail) {
+    cqe = &ring.cq[ring.cqHead % IoRingEntries];
+    if (cqe->result == BLOCK_SIZE)
+      good++;
+    ring.cqHead++;
+  }
+  return good;
+}
+
+int main() {
+  OpenFileId file;
+  int i, j, ok = 1;
+
+  Create("aio.dat");
+  file = Open("aio.dat");
+  if (file < 0 || IoSetup(&ring) < 0) {
+    Write("aio: no se pudo preparar\n", 25, ConsoleOutput);
+    Exit(1);
+  }
+
+  for (i = 0; i < BLOCKS; i++) {
+    for (j = 0; j < BLOCK_SIZE - 1; j++)
+      blocks[i][j] = 'A' + i;
+    blocks[i][BLOCK_SIZE - 1] = '\n';
+    Submit(IO_WRITE, file, blocks[i], i);
+  }
+  if (IoEnter(BLOCKS, 0) != BLOCKS)
+    ok = 0;
+  if (Drain(BLOCKS) != BLOCKS)
+    ok = 0;
+
+  for (i = BLOCKS - 1; i >= 0; i--)
+    Submit(IO_READ, file, check[i], i);
+  if (IoEnter(BLOCKS, BLOCKS) != BLOCKS)
+    ok = 0;
+  if (Drain(BLOCKS) != BLOCKS)
+    ok = 0;
+  for (i = 0; i < BLOCKS; i++)
+    for (j = 0; j < BLOCK_SIZE; j++)
+      if (blocks[i][j] != check[i][j])
+        ok = 0;
+  Close(file);
+
+  if (ok)
+    Write("aio: ok\n", 8, ConsoleOutput);
+  else
+    Write("aio: FALLO\n", 11, ConsoleOutput);
+  Halt();
+}
@@ -0,0 +1,54 @@
+#include "syscall.h"
+
+/*
+ * Prueba de Batch: crea, escribe y vuelve a leer un archivo con dos
+ * Batch, y verifica que el segundo se detiene en la llamada que falla,
+ * y el tercero en un ShmAttach que falla.
+ */
+
+char line[] = "batch: una linea\n";
+char check[32];
+SyscallDesc calls[4];
+
+void Set(int i, int type, int a0, int a1, int a2) {
+  calls[i].type = type;
+  calls[i].args[0] = a0;
+  calls[i].args[1] = a1;
+  calls[i].args[2] = a2;
+  calls[i].result = 0;
+}
+
+int main() {
+  int ok = 1, file;
+
+  Create("batch.dat");
+  file = Open("batch.dat");
+  Set(0, SC_Write, (int)line, 17, file);
+  Set(1, SC_Write, (int)line, 17, ConsoleOutput);
+  Set(2, SC_Close, file, 0, 0);
+  Set(3, SC_Open, (int)"batch.dat", 0, 0);
+  if (Batch(calls, 4) != 4 || calls[0].result != 17 || calls[3].result < 0)
+    ok = 0;
+
+  file = calls[3].result;
+  Set(0, SC_Read, (int)check, 17, file);
+  Set(1, SC_Close, file, 0, 0);
+  Set(2, SC_Read, (int)check, 17, file); /* ya esta cerrado */
+  Set(3, SC_Halt, 0, 0, 0);
+  if (Batch(calls, 4) != 2 || calls[0].result != 17 || calls[2].result != -1 ||
+      calls[3].result != 0)
+    ok = 0;
+  if (check[0] != 'b' || check[16] != '\n')
+    ok = 0;
+
+  Set(0, SC_ShmAttach, 12345, 0, 0); /* no hay tal segmento */
+  Set(1, SC_Halt, 0, 0, 0);
+  if (Batch(calls, 2) != 0 || calls[0].result != -1 || calls[1].result != 0)
+    ok = 0;
+
+  if (ok)
+    Write("batch: ok\n", 10, ConsoleOutput);
+  else
+    Write("batch: FALLO\n", 13, ConsoleOutput);
+  Halt();
+}
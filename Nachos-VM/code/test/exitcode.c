@@ -0,0 +1,4 @@
+#include "syscall.h"
+
+/* Termina de inmediato con un estado conocido, lo usa procstress */
+int main() { Exit(7); }
@@ -0,0 +1,106 @@
+#include "syscall.h"
+
+/*
+ * Prueba de Sbrk y del stack que crece: arma una lista con nodos pedidos
+ * al heap, la recorre, devuelve la memoria, y hace una recursion que usa
+ * bastante mas que el stack inicial.  Un hilo de Fork mueve el mismo
+ * heap que el principal.  Un Read a un arreglo local que todavia no esta
+ * en el stack lo tiene que hacer crecer el kernel.
+ */
+
+#define NODES 100
+#define DEPTH 40
+#define FRAME 64
+#define DEEP 2048 /* mas que el stack inicial */
+
+typedef struct Node {
+  int value;
+  struct Node *next;
+} Node;
+
+char *fromThread;
+Sem_t grown;
+
+/* Corre en otro hilo del mismo proceso */
+void Grow() {
+  fromThread = Sbrk(NODES);
+  fromThread[0] = 'h';
+  SemSignal(grown);
+  Exit(0);
+}
+
+/* Cada marco de la recursion ocupa mas de FRAME bytes de stack */
+int Depth(int n) {
+  char frame[FRAME];
+  int i;
+
+  for (i = 0; i < FRAME; i++)
+    frame[i] = n;
+  if (n == 0)
+    return 0;
+  if (frame[FRAME - 1] != n)
+    return -DEPTH;
+  return 1 + Depth(n - 1);
+}
+
+/* El Read escribe en paginas del stack que nadie toco todavia */
+int ReadDeep() {
+  char deep[DEEP];
+  OpenFileId fds[2];
+  int n;
+
+  if (Pipe(fds) < 0)
+    return 0;
+  Write("profundo", 8, fds[1]);
+  n = Read(deep, 8, fds[0]);
+  Close(fds[0]);
+  Close(fds[1]);
+  return n == 8 && deep[0] == 'p' && deep[7] == 'o';
+}
+
+int main() {
+  char *start, *memory;
+  Node *list = 0, *node;
+  int i, sum = 0, ok = 1;
+
+  start = Sbrk(0);
+  memory = Sbrk(NODES * sizeof(Node));
+  if (memory != start)
+    ok = 0;
+  node = (Node *)memory;
+  for (i = 0; ok && i < NODES; i++, node++) {
+    if (node->value != 0 || node->next != 0) /* memoria nueva, en cero */
+      ok = 0;
+    node->value = i;
+    node->next = list;
+    list = node;
+  }
+  for (node = list; ok && node != 0; node = node->next)
+    sum += node->value;
+  if (sum != NODES * (NODES - 1) / 2)
+    ok = 0;
+
+  /* Mas de lo que hay entre el heap y el stack */
+  if (Sbrk(1 << 20) != (char *)-1)
+    ok = 0;
+  if (Sbrk(-NODES * (int)sizeof(Node)) != start + NODES * sizeof(Node) ||
+      Sbrk(0) != start)
+    ok = 0;
+
+  grown = SemCreate(0);
+  Fork(Grow);
+  SemWait(grown);
+  if (fromThread != start || Sbrk(0) != start + NODES || *start != 'h')
+    ok = 0;
+
+  if (!ReadDeep())
+    ok = 0;
+  if (Depth(DEPTH) != DEPTH)
+    ok = 0;
+
+  if (ok)
+    Write("heap: ok\n", 9, ConsoleOutput);
+  else
+    Write("heap: FALLO\n", 12, ConsoleOutput);
+  Halt();
+}
@@ -0,0 +1,73 @@
+#include "syscall.h"
+
+/*
+ * Prueba de Mmap y Munmap: escribe un archivo de varias paginas, lo
+ * mapea, lo recorre y lo cambia a traves de la memoria (desde otro hilo
+ * del proceso), y verifica con Read que los cambios llegaron al archivo
+ * despues del Munmap.
+ */
+
+#define SIZE 1000 /* mas de 7 paginas, la ultima a medias */
+
+char data[SIZE];
+char check[SIZE];
+char *map;
+Sem_t done;
+
+/* Corre en otro hilo, que ve el mismo mapeo */
+void Upcase() {
+  int i;
+
+  for (i = 0; i < SIZE; i += 2)
+    map[i] = map[i] - 'a' + 'A';
+  SemSignal(done);
+  Exit(0);
+}
+
+int main() {
+  OpenFileId file;
+  int i, sum = 0, expected = 0, ok = 1;
+
+  Create("mmap.dat");
+  file = Open("mmap.dat");
+  if (file < 0) {
+    Write("mmap: no se pudo abrir\n", 23, ConsoleOutput);
+    Exit(1);
+  }
+  for (i = 0; i < SIZE; i++) {
+    data[i] = 'a' + i % 26;
+    expected += data[i];
+  }
+  Write(data, SIZE, file);
+
+  map = Mmap(file, 0, SIZE);
+  if (map == (char *)-1)
+    ok = 0;
+  Close(file); /* el mapeo sigue */
+
+  for (i = 0; ok && i < SIZE; i++)
+    sum += map[i];
+  if (sum != expected)
+    ok = 0;
+  if (ok) {
+    done = SemCreate(0);
+    Fork(Upcase);
+    SemWait(done);
+  }
+  if (Munmap(map) != 0 || Munmap(map) != -1)
+    ok = 0;
+
+  file = Open("mmap.dat");
+  if (Read(check, SIZE, file) != SIZE)
+    ok = 0;
+  for (i = 0; ok && i < SIZE; i++)
+    if (check[i] != (i % 2 == 0 ? 'A' : 'a') + i % 26)
+      ok = 0;
+  Close(file);
+
+  if (ok)
+    Write("mmap: ok\n", 9, ConsoleOutput);
+  else
+    Write("mmap: FALLO\n", 12, ConsoleOutput);
+  Halt();
+}
@@ -0,0 +1,33 @@
+#include "syscall.h"
+
+/*
+ * Lector de la prueba de pipes: el primer Read tiene que esperar al
+ * escritor, que todavia duerme, en vez de volver sin nada.  Despues lee
+ * de a poco hasta que Read devuelve 0, cuando el escritor ya termino.
+ * Sale con 0 si llego todo, en orden: los pedazos de PIECE bytes que
+ * manda pipewriter.
+ */
+
+#define PIECE 100
+#define TOTAL (PIECE * 15)
+#define CHUNK 64
+
+char buffer[CHUNK];
+
+int main() {
+  int i, n, total = 0, ok = 1;
+
+  n = Read(buffer, CHUNK, ConsoleInput);
+  if (n <= 0)
+    ok = 0;
+  while (n > 0) {
+    for (i = 0; i < n; i++)
+      if (buffer[i] != 'a' + (total + i) % PIECE % 26)
+        ok = 0;
+    total += n;
+    n = Read(buffer, CHUNK, ConsoleInput);
+  }
+  if (n != 0 || total != TOTAL)
+    ok = 0;
+  Exit(ok ? 0 : 1);
+}
@@ -0,0 +1,35 @@
+#include "syscall.h"
+
+/*
+ * Prueba de pipes entre procesos, armada como lo hace el shell con
+ * "pipewriter | pipereader": Pipe, Dup2 de cada extremo sobre la consola
+ * del hijo, y Exec.  Cada hijo termina con 0 si todo lo que vio estuvo
+ * bien (ver pipewriter.c y pipereader.c).
+ */
+
+int main() {
+  OpenFileId fds[2];
+  SpaceId writer = -1, reader = -1;
+  int ok = 1;
+
+  if (Pipe(fds) < 0)
+    ok = 0;
+  if (ok) {
+    Dup2(fds[1], ConsoleOutput);
+    writer = Exec("../test/pipewriter");
+    Close(ConsoleOutput);
+    Close(fds[1]); /* para que el lector vea el fin de los datos */
+    Dup2(fds[0], ConsoleInput);
+    reader = Exec("../test/pipereader");
+    Close(ConsoleInput);
+    Close(fds[0]);
+  }
+  if (writer < 0 || reader < 0 || Join(writer) != 0 || Join(reader) != 0)
+    ok = 0;
+
+  if (ok)
+    Write("pipes: ok\n", 10, ConsoleOutput);
+  else
+    Write("pipes: FALLO\n", 13, ConsoleOutput);
+  Halt();
+}
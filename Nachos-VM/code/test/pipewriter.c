@@ -0,0 +1,28 @@
+#include "syscall.h"
+
+/*
+ * Escritor de la prueba de pipes: duerme, para que el lector ya este
+ * esperando, y escribe con un solo WriteV mas de lo que cabe en el pipe
+ * (1 KB): PIECES veces el mismo pedazo.  El WriteV solo puede terminar
+ * completo si espera a que el lector saque datos.  Sale con 0 si se
+ * escribio todo.
+ */
+
+#define PIECE 100
+#define PIECES 15
+
+char data[PIECE];
+IoVec iov[PIECES];
+
+int main() {
+  int i;
+
+  for (i = 0; i < PIECE; i++)
+    data[i] = 'a' + i % 26;
+  for (i = 0; i < PIECES; i++) {
+    iov[i].base = data;
+    iov[i].len = PIECE;
+  }
+  Sleep(5000);
+  Exit(WriteV(iov, PIECES, ConsoleOutput) == PIECE * PIECES ? 0 : 1);
+}
@@ -0,0 +1,93 @@
+#include "syscall.h"
+
+/*
+ * Lanza muchos procesos hijos por rondas y espera a cada uno con Join,
+ * para probar que la tabla de procesos reutiliza sus entradas.
+ * Join devuelve el estado de salida del hijo (exitcode termina con 7),
+ * y un Join sobre un hijo ya recogido debe devolver -1.  Corre como el
+ * primer proceso, que es el 0: un Join sobre si mismo tambien devuelve -1.
+ *
+ * Luego deja mas de 128 hijos terminados sin recoger, para que la tabla
+ * tenga que crecer, y prueba que una entrada reutilizada tiene otro
+ * identificador: los 16 bits bajos son la entrada, los altos la
+ * generacion.
+ */
+
+#define ROUNDS 64
+#define BATCH 4
+#define ZOMBIES 136    /* mas que las 128 entradas con que empieza la tabla */
+#define SLOT 0xffff    /* la entrada dentro del identificador */
+
+SpaceId zombies[ZOMBIES];
+
+int main() {
+  SpaceId ids[BATCH], reused;
+  OpenFileId fds[2];
+  int round, i, errors, grown;
+  char c;
+
+  errors = 0;
+  if (Join(0) != -1) {
+    errors++;
+  }
+  for (round = 0; round < ROUNDS; round++) {
+    for (i = 0; i < BATCH; i++) {
+      ids[i] = Exec("../test/exitcode");
+    }
+    for (i = 0; i < BATCH; i++) {
+      if (ids[i] < 0 || Join(ids[i]) != 7) {
+        errors++;
+      }
+      if (Join(ids[i]) != -1) {
+        errors++;
+      }
+    }
+  }
+
+  /* Cada hijo hereda el extremo de escritura de un pipe, el Read da 0
+   * cuando termina: asi hay uno solo corriendo, pero ninguno se recoge */
+  grown = 0;
+  for (i = 0; i < ZOMBIES; i++) {
+    zombies[i] = -1;
+    if (Pipe(fds) < 0) {
+      errors++;
+      break;
+    }
+    zombies[i] = Exec("../test/exitcode");
+    Close(fds[1]);
+    if (zombies[i] < 0 || Read(&c, 1, fds[0]) != 0) {
+      errors++;
+    }
+    Close(fds[0]);
+    if ((zombies[i] & SLOT) >= 128) {
+      grown = 1;
+    }
+  }
+  if (!grown) {
+    errors++;
+  }
+  for (i = 0; i < ZOMBIES; i++) {
+    if (zombies[i] < 0 || Join(zombies[i]) != 7) {
+      errors++;
+    }
+  }
+
+  /* El nuevo hijo cae en una entrada que ya uso otro, con otro id */
+  reused = Exec("../test/exitcode");
+  for (i = 0; i < ZOMBIES; i++) {
+    if ((zombies[i] & SLOT) == (reused & SLOT)) {
+      break;
+    }
+  }
+  if (reused < 0 || i == ZOMBIES || zombies[i] == reused ||
+      Join(zombies[i]) != -1 || Join(reused) != 7) {
+    errors++;
+  }
+
+  if (errors == 0) {
+    Write("procstress: ok\n", 15, 1);
+  } else {
+    Write("procstress: errores\n", 20, 1);
+  }
+  Exit(errors);
+}
@@ -0,0 +1,127 @@
+#include "syscall.h"
+
+/*
+ * Prueba de ReadV, WriteV, PRead y PWrite: escribe un archivo de
+ * registros de tamano fijo con un solo WriteV, los lee de vuelta de a
+ * varios por llamada con PRead, reescribe uno en su lugar con PWrite y
+ * verifica todo con un ReadV desde el inicio.  Despues pasa unos
+ * registros por un pipe con WriteV y ReadV, y un WriteV que se sale de
+ * la memoria no debe dejar nada en el pipe.
+ */
+
+#define RECORDS 16
+#define RECORD_SIZE 8
+
+char records[RECORDS][RECORD_SIZE];
+char check[RECORDS][RECORD_SIZE];
+IoVec iov[RECORDS];
+
+void Fill(int i, char c) {
+  int j;
+  for (j = 0; j < RECORD_SIZE - 1; j++)
+    records[i][j] = c;
+  records[i][RECORD_SIZE - 1] = '\n';
+}
+
+int Same(int i) {
+  int j;
+  for (j = 0; j < RECORD_SIZE; j++)
+    if (records[i][j] != check[i][j])
+      return 0;
+  return 1;
+}
+
+int main() {
+  OpenFileId file, fds[2];
+  int i, n, ok = 1;
+  char *edge;
+
+  Create("records.dat");
+  file = Open("records.dat");
+  if (file < 0) {
+    Write("records: no se pudo abrir\n", 26, ConsoleOutput);
+    Exit(1);
+  }
+
+  for (i = 0; i < RECORDS; i++) {
+    Fill(i, 'a' + i);
+    iov[i].base = records[i];
+    iov[i].len = RECORD_SIZE;
+  }
+  if (WriteV(iov, RECORDS, file) != RECORDS * RECORD_SIZE)
+    ok = 0;
+
+  /* Los registros 4..7, sin mover la posicion del archivo */
+  for (i = 0; i < 4; i++) {
+    iov[i].base = check[4 + i];
+    iov[i].len = RECORD_SIZE;
+  }
+  if (PRead(iov, 4, 4 * RECORD_SIZE, file) != 4 * RECORD_SIZE)
+    ok = 0;
+  for (i = 4; i < 8; i++)
+    if (!Same(i))
+      ok = 0;
+
+  /* Reescribe el registro 9 en su lugar */
+  Fill(9, 'Z');
+  iov[0].base = records[9];
+  iov[0].len = RECORD_SIZE;
+  if (PWrite(iov, 1, 9 * RECORD_SIZE, file) != RECORD_SIZE)
+    ok = 0;
+
+  /* Todo de vuelta: la posicion quedo al final del WriteV */
+  for (i = 0; i < RECORDS; i++) {
+    iov[i].base = check[i];
+    iov[i].len = RECORD_SIZE;
+  }
+  n = PRead(iov, RECORDS, 0, file);
+  if (n != RECORDS * RECORD_SIZE)
+    ok = 0;
+  for (i = 0; i < RECORDS; i++)
+    if (!Same(i))
+      ok = 0;
+  if (ReadV(iov, RECORDS, file) != 0) /* ya en el final */
+    ok = 0;
+  Close(file);
+
+  /* Tres registros por el pipe; el ReadV pide mas de lo que hay */
+  if (Pipe(fds) < 0)
+    ok = 0;
+  for (i = 0; i < 3; i++) {
+    iov[i].base = records[i];
+    iov[i].len = RECORD_SIZE;
+  }
+  if (WriteV(iov, 3, fds[1]) != 3 * RECORD_SIZE ||
+      PWrite(iov, 1, 0, fds[1]) != -1)
+    ok = 0;
+  for (i = 0; i < 4; i++) {
+    iov[i].base = check[i];
+    iov[i].len = RECORD_SIZE;
+  }
+  if (ReadV(iov, 4, fds[0]) != 3 * RECORD_SIZE)
+    ok = 0;
+  for (i = 0; i < 3; i++)
+    if (!Same(i))
+      ok = 0;
+
+  /* La pagina que sigue al heap no existe: el WriteV copia los 10 bytes
+   * de antes, falla, y el pipe queda vacio
+   */
+  edge = (char *)(((int)Sbrk(0) + 127) / 128 * 128);
+  iov[0].base = edge - 10;
+  iov[0].len = 200;
+  if (WriteV(iov, 1, fds[1]) != -1)
+    ok = 0;
+  Close(fds[1]);
+  if (Read(check[0], RECORD_SIZE, fds[0]) != 0)
+    ok = 0;
+  Close(fds[0]);
+
+  /* Con el '\0' del final: la consola termina ahi, como con Write */
+  iov[0].base = ok ? "records: ok\n" : "records: FALLO\n";
+  iov[0].len = ok ? 13 : 16;
+  iov[1].base = "no se ve\n";
+  iov[1].len = 9;
+  WriteV(iov, 2, ConsoleOutput);
+  Halt();
+}
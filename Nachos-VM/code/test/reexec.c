@@ -0,0 +1,68 @@
+#include "syscall.h"
+
+/*
+ * Prueba que el cache de ejecutables no corre una imagen vieja: copia
+ * exitcode a reexec.dat y lo corre, y despues lo reescribe (con Write y
+ * con Create) usando otra forma de escribir el mismo camino.  El Exec
+ * que sigue, con el camino de antes, tiene que ver el archivo nuevo, que
+ * ya no es un programa: el hijo termina sin correr y Join devuelve -1.
+ */
+
+#define MAX_SIZE 2048
+
+char program[MAX_SIZE];
+
+/* Copia exitcode en "name", devuelve si pudo */
+int CopyProgram(char *name) {
+  OpenFileId file;
+  int size;
+
+  file = Open("../test/exitcode");
+  if (file < 0)
+    return 0;
+  size = Read(program, MAX_SIZE, file);
+  Close(file);
+  Create(name);
+  file = Open(name);
+  if (size <= 0 || file < 0)
+    return 0;
+  Write(program, size, file);
+  Close(file);
+  return 1;
+}
+
+/* Corre "name", devuelve lo que da Join */
+int Run(char *name) {
+  SpaceId child = Exec(name);
+
+  if (child < 0)
+    return -2;
+  return Join(child);
+}
+
+int main() {
+  OpenFileId file;
+  int ok = 1;
+
+  /* Con Write, por otro camino al mismo archivo */
+  if (!CopyProgram("../test/reexec.dat") || Run("../test/./reexec.dat") != 7)
+    ok = 0;
+  file = Open("../vm/../test/reexec.dat");
+  Write("basura", 6, file);
+  Close(file);
+  if (Run("../test/./reexec.dat") != -1)
+    ok = 0;
+
+  /* Con Create, que lo deja vacio */
+  if (!CopyProgram("../test/reexec.dat") || Run("../test//reexec.dat") != 7)
+    ok = 0;
+  Create("../test/../test/reexec.dat");
+  if (Run("../test//reexec.dat") != -1)
+    ok = 0;
+
+  if (ok)
+    Write("reexec: ok\n", 11, ConsoleOutput);
+  else
+    Write("reexec: FALLO\n", 14, ConsoleOutput);
+  Halt();
+}
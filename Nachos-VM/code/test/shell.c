@@ -1,11 +1,77 @@
 #include "syscall.h"
 
+/*
+ * Shell minimo: corre cada linea como un programa, o como una tuberia de
+ * programas separados por '|' ("sort | echo"), conectados con pipes.
+ */
+
+#define MaxCommands 8
+
+SpaceId procs[MaxCommands];
+char *commands[MaxCommands];
+
+/* Separa la linea en comandos, sin los espacios de los bordes */
+int Split(char *line) {
+  int n = 0;
+  char *end;
+
+  while (n < MaxCommands) {
+    while (*line == ' ')
+      line++;
+    commands[n++] = line;
+    while (*line != '\0' && *line != '|')
+      line++;
+    for (end = line; end > commands[n - 1] && end[-1] == ' '; end--)
+      ;
+    if (*line == '\0') {
+      *end = '\0';
+      break;
+    }
+    *end = '\0';
+    line++;
+  }
+  return n;
+}
+
+/* Corre los "n" comandos a la vez, cada uno con su salida conectada a la
+ * entrada del siguiente, y espera a que terminen todos
+ */
+void Run(int n) {
+  OpenFileId fds[2];
+  int c, previous = -1; /* lectura del pipe anterior */
+
+  for (c = 0; c < n; c++) {
+    if (c + 1 < n && Pipe(fds) < 0)
+      n = c + 1; /* sin pipe, el resto de la tuberia no corre */
+    /* INFO: el hijo hereda la consola redirigida */
+    if (previous != -1)
+      Dup2(previous, ConsoleInput);
+    if (c + 1 < n)
+      Dup2(fds[1], ConsoleOutput);
+    procs[c] = Exec(commands[c]);
+    /* El shell vuelve a su consola, y suelta sus extremos de los pipes
+     * para que el fin de los datos llegue al siguiente comando
+     */
+    if (previous != -1) {
+      Close(ConsoleInput);
+      Close(previous);
+      previous = -1;
+    }
+    if (c + 1 < n) {
+      Close(ConsoleOutput);
+      Close(fds[1]);
+      previous = fds[0];
+    }
+  }
+  for (c = 0; c < n; c++)
+    Join(procs[c]);
+}
+
 int main() {
-  SpaceId newProc;
   // INFO: no genera el ouput para errores
   OpenFileId input = ConsoleInput;
   OpenFileId output = ConsoleOutput;
-  char prompt[2], ch, buffer[60];
+  char prompt[2], buffer[60];
   int i;
   prompt[0] = '-';
   prompt[1] = '-';
@@ -13,12 +79,11 @@ int main() {
     Write(prompt, 2, output);
     i = 0;
     do {
-      Read(&buffer[i], 1, input);
+      if (Read(&buffer[i], 1, input) <= 0)
+        Exit(0); /* se acabo la entrada */
     } while (buffer[i++] != '\n');
     buffer[--i] = '\0';
-    if (i > 0) {
-      newProc = Exec(buffer);
-      Join(newProc);
-    }
+    if (i > 0)
+      Run(Split(buffer));
   }
 }
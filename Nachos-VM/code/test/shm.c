@@ -0,0 +1,57 @@
+#include "syscall.h"
+
+/*
+ * Prueba de la memoria compartida: el primer proceso crea un segmento,
+ * lo llena y se ejecuta de nuevo a si mismo con Exec.  El segundo lo
+ * encuentra ya lleno (por la misma llave), verifica los datos y deja su
+ * respuesta en el segmento, que el primero lee despues del Join.
+ *
+ * El segmento ocupa varias paginas, para que con memoria virtual algunas
+ * se desalojen y se vuelvan a cargar mientras los dos lo usan.
+ */
+
+#define KEY 1234
+#define WORDS 256
+
+typedef struct {
+  int state; /* 0: nuevo, 1: lleno por el padre, 2: verificado por el hijo */
+  int data[WORDS];
+  int sum;
+} Shared;
+
+int main() {
+  Shared *shared;
+  int id, i, sum = 0;
+  SpaceId child;
+
+  id = ShmCreate(KEY, sizeof(Shared));
+  shared = (Shared *)ShmAttach(id);
+  if (id < 0 || shared == (Shared *)-1) {
+    Write("shm: no se pudo crear el segmento\n", 34, ConsoleOutput);
+    Exit(1);
+  }
+
+  if (shared->state == 1) { /* el hijo */
+    for (i = 0; i < WORDS; i++)
+      sum += shared->data[i];
+    shared->sum = sum;
+    shared->state = 2;
+    ShmDetach((char *)shared);
+    Exit(0);
+  }
+
+  for (i = 0; i < WORDS; i++) {
+    shared->data[i] = i;
+    sum += i;
+  }
+  shared->state = 1;
+  child = Exec("../test/shm");
+  Join(child);
+
+  if (shared->state == 2 && shared->sum == sum)
+    Write("shm: ok\n", 8, ConsoleOutput);
+  else
+    Write("shm: FALLO\n", 11, ConsoleOutput);
+  ShmDetach((char *)shared);
+  Halt();
+}
@@ -0,0 +1,47 @@
+#include "syscall.h"
+
+/*
+ * Prueba Sleep: cada hilo mide con Ticks que durmio al menos lo pedido.
+ * El hijo duerme menos que el principal, por lo que debe despertar
+ * primero aunque haya sido creado despues, mientras el principal sigue
+ * dormido.  Un Sleep de 0 o negativo no espera.
+ */
+
+#define LONG 5000
+#define SHORT 1000
+
+int ok = 1, childDone;
+
+void Dormilon();
+
+int main() {
+  int start;
+
+  Fork(Dormilon);
+  start = Ticks();
+  Sleep(LONG);
+  if (Ticks() - start < LONG || !childDone)
+    ok = 0;
+
+  start = Ticks();
+  Sleep(0);
+  Sleep(-LONG);
+  if (Ticks() - start >= SHORT)
+    ok = 0;
+
+  if (ok)
+    Write("sleep: ok\n", 10, ConsoleOutput);
+  else
+    Write("sleep: FALLO\n", 13, ConsoleOutput);
+  Halt();
+}
+
+void Dormilon() {
+  int start = Ticks();
+
+  Sleep(SHORT);
+  if (Ticks() - start < SHORT)
+    ok = 0;
+  childDone = 1;
+  Exit(0);
+}
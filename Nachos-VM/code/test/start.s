@@ -132,6 +132,70 @@ Yield:
 	j	$31
 	.end Yield
 
+	.globl Sleep
+	.ent	Sleep
+Sleep:
+	addiu $2,$0,SC_Sleep
+	syscall
+	j	$31
+	.end Sleep
+
+	.globl Ticks
+	.ent	Ticks
+Ticks:
+	addiu $2,$0,SC_Ticks
+	syscall
+	j	$31
+	.end Ticks
+
+	.globl ReadV
+	.ent	ReadV
+ReadV:
+	addiu $2,$0,SC_ReadV
+	syscall
+	j	$31
+	.end ReadV
+
+	.globl WriteV
+	.ent	WriteV
+WriteV:
+	addiu $2,$0,SC_WriteV
+	syscall
+	j	$31
+	.end WriteV
+
+	.globl PRead
+	.ent	PRead
+PRead:
+	addiu $2,$0,SC_PRead
+	syscall
+	j	$31
+	.end PRead
+
+	.globl PWrite
+	.ent	PWrite
+PWrite:
+	addiu $2,$0,SC_PWrite
+	syscall
+	j	$31
+	.end PWrite
+
+	.globl Pipe
+	.ent	Pipe
+Pipe:
+	addiu $2,$0,SC_Pipe
+	syscall
+	j	$31
+	.end Pipe
+
+	.globl Dup2
+	.ent	Dup2
+Dup2:
+	addiu $2,$0,SC_Dup2
+	syscall
+	j	$31
+	.end Dup2
+
 	.globl SemCreate
 	.ent	SemCreate
 SemCreate:
@@ -212,16 +276,16 @@ CondDestroy:
 	j	$31
 	.end CondDestroy
 
-	.globl CondAcquire
-	.ent	CondAcquire
+	.globl CondSignal
+	.ent	CondSignal
 CondSignal:
 	addiu $2,$0,SC_CondSignal
 	syscall
 	j	$31
-	.end CondAcquire
+	.end CondSignal
 
-	.globl CondSignal
-	.ent	CondSignal
+	.globl CondWait
+	.ent	CondWait
 CondWait:
 	addiu $2,$0,SC_CondWait
 	syscall
@@ -230,7 +294,7 @@ CondWait:
 
 	.globl CondBroadcast
 	.ent	CondBroadcast
-CondBroadCast:
+CondBroadcast:
 	addiu $2,$0,SC_CondBroadcast
 	syscall
 	j	$31
@@ -284,6 +348,78 @@ Shutdown:
 	j	$31
 	.end Shutdown
 
+	.globl IoSetup
+	.ent	IoSetup
+IoSetup:
+	addiu $2,$0,SC_IoSetup
+	syscall
+	j	$31
+	.end IoSetup
+
+	.globl IoEnter
+	.ent	IoEnter
+IoEnter:
+	addiu $2,$0,SC_IoEnter
+	syscall
+	j	$31
+	.end IoEnter
+
+	.globl ShmCreate
+	.ent	ShmCreate
+ShmCreate:
+	addiu $2,$0,SC_ShmCreate
+	syscall
+	j	$31
+	.end ShmCreate
+
+	.globl ShmAttach
+	.ent	ShmAttach
+ShmAttach:
+	addiu $2,$0,SC_ShmAttach
+	syscall
+	j	$31
+	.end ShmAttach
+
+	.globl ShmDetach
+	.ent	ShmDetach
+ShmDetach:
+	addiu $2,$0,SC_ShmDetach
+	syscall
+	j	$31
+	.end ShmDetach
+
+	.globl Sbrk
+	.ent	Sbrk
+Sbrk:
+	addiu $2,$0,SC_Sbrk
+	syscall
+	j	$31
+	.end Sbrk
+
+	.globl Mmap
+	.ent	Mmap
+Mmap:
+	addiu $2,$0,SC_Mmap
+	syscall
+	j	$31
+	.end Mmap
+
+	.globl Munmap
+	.ent	Munmap
+Munmap:
+	addiu $2,$0,SC_Munmap
+	syscall
+	j	$31
+	.end Munmap
+
+	.globl Batch
+	.ent	Batch
+Batch:
+	addiu $2,$0,SC_Batch
+	syscall
+	j	$31
+	.end Batch
+
 /* dummy function to keep gcc happy */
         .globl  __main
         .ent    __main
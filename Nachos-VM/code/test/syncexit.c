@@ -0,0 +1,18 @@
+#include "syscall.h"
+
+/*
+ * Prueba de la salida de un proceso con hilos esperando: el hilo
+ * principal de syncwaiters sale mientras los demas esperan en sus
+ * semaforos, locks y condiciones.  El Join tiene que volver, con el
+ * estado del principal.
+ */
+
+int main() {
+  SpaceId child = Exec("../test/syncwaiters");
+
+  if (child >= 0 && Join(child) == 3)
+    Write("syncexit: ok\n", 13, ConsoleOutput);
+  else
+    Write("syncexit: FALLO\n", 16, ConsoleOutput);
+  Halt();
+}
@@ -0,0 +1,48 @@
+#include "syscall.h"
+
+/*
+ * Ayudante de syncexit: el hilo principal termina mientras otros tres
+ * esperan en un semaforo, en un lock que el tiene y en una condicion.
+ * Al salir el principal, sus objetos se destruyen y los tres despiertan
+ * con -1; el proceso termina con el estado del principal (3), y no se
+ * queda colgado el Join del padre.
+ */
+
+Sem_t never;
+Lock_t held, guard;
+Cond_t nobody;
+Sem_t waiting;
+
+void OnSemaphore() {
+  SemSignal(waiting);
+  Exit(SemWait(never) == -1 ? 0 : 1);
+}
+
+void OnLock() {
+  SemSignal(waiting);
+  Exit(LckAcquire(held) == -1 ? 0 : 1);
+}
+
+void OnCondition() {
+  LckAcquire(guard);
+  SemSignal(waiting);
+  Exit(CondWait(nobody, guard) == -1 ? 0 : 1);
+}
+
+int main() {
+  never = SemCreate(0);
+  waiting = SemCreate(0);
+  held = LckCreate();
+  guard = LckCreate();
+  nobody = CondCreate();
+
+  LckAcquire(held);
+  Fork(OnSemaphore);
+  Fork(OnLock);
+  Fork(OnCondition);
+  SemWait(waiting);
+  SemWait(waiting);
+  SemWait(waiting);
+  Sleep(1000); /* que ya esten bloqueados */
+  Exit(3);
+}
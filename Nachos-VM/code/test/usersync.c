@@ -0,0 +1,95 @@
+#include "syscall.h"
+
+/*
+ * Prueba de los semaforos, locks y condiciones de usuario: dos hilos del
+ * mismo proceso juegan ping pong con semaforos (sin Yield), y luego el
+ * hijo produce items que el principal consume con un lock y una
+ * condicion.  Al final se prueba que los identificadores destruidos ya
+ * no sirven, y que destruir un lock tomado no deja colgado al que lo
+ * tenia: sigue pudiendo liberar sus otros locks.  Imprime una sola linea
+ * con el resultado de todo.
+ */
+
+#define ROUNDS 4
+#define ITEMS 10
+
+Sem_t ping, pong, done;
+Lock_t lock;
+Cond_t notEmpty;
+int items, produced, turn, ok = 1;
+
+void Jugador();
+
+int main() {
+  int i, consumed = 0;
+  Lock_t other, doomed;
+
+  ping = SemCreate(0);
+  pong = SemCreate(0);
+  done = SemCreate(0);
+  lock = LckCreate();
+  notEmpty = CondCreate();
+
+  Fork(Jugador);
+  for (i = 0; i < ROUNDS; i++) {
+    turn = 2 * i; /* le toca al hijo */
+    SemSignal(ping);
+    SemWait(pong);
+    if (turn != 2 * i + 1)
+      ok = 0;
+  }
+
+  while (consumed < ITEMS) {
+    LckAcquire(lock);
+    while (items == 0)
+      CondWait(notEmpty, lock);
+    items--;
+    consumed++;
+    LckRelease(lock);
+  }
+  SemWait(done);
+  if (produced != ITEMS || items != 0)
+    ok = 0;
+
+  /* Identificadores invalidos */
+  SemDestroy(ping);
+  if (SemSignal(ping) != -1 || LckAcquire(lock + 1000) != -1)
+    ok = 0;
+
+  /* Lock tomado destruido */
+  other = LckCreate();
+  doomed = LckCreate();
+  LckAcquire(other);
+  LckAcquire(doomed);
+  LckDestroy(doomed);
+  if (LckRelease(other) != 0 || LckRelease(doomed) != -1)
+    ok = 0;
+
+  if (ok)
+    Write("usersync: ok\n", 13, 1);
+  else
+    Write("usersync: FALLO\n", 16, 1);
+  Exit(0);
+}
+
+void Jugador() {
+  int i;
+
+  for (i = 0; i < ROUNDS; i++) {
+    SemWait(ping);
+    if (turn != 2 * i)
+      ok = 0;
+    turn = 2 * i + 1;
+    SemSignal(pong);
+  }
+
+  for (i = 0; i < ITEMS; i++) {
+    LckAcquire(lock);
+    items++;
+    produced++;
+    CondSignal(notEmpty, lock);
+    LckRelease(lock);
+  }
+  SemSignal(done);
+  Exit(0);
+}
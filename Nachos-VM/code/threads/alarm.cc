@@ -0,0 +1,104 @@
+// alarm.cc
+//	Routines to put threads to sleep for a while, in simulated time.
+//
+//	The sleeper queue is kept sorted by wake up time, so the interrupt
+//	handler only looks at its front.  At most one alarm interrupt is
+//	needed at any time, for the earliest sleeper; if a thread wants to
+//	wake up before that, another interrupt is scheduled, and the old
+//	one is simply ignored when it goes off.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "alarm.h"
+#include "copyright.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// AlarmHandler
+// 	Interrupt handler for the alarm.  Since interrupt handlers take a
+//	single argument, we pass the Alarm object.
+//----------------------------------------------------------------------
+
+static void AlarmHandler(void *arg) { ((Alarm *)arg)->CallBack(); }
+
+//----------------------------------------------------------------------
+// Alarm::Alarm
+// 	Initialize the alarm clock, with no sleeping threads.
+//----------------------------------------------------------------------
+
+Alarm::Alarm() {
+  sleepers = new WaitQueue;
+  armedFor = -1;
+}
+
+//----------------------------------------------------------------------
+// Alarm::~Alarm
+// 	De-allocate the alarm clock.  Any thread still sleeping is
+//	never woken up.
+//----------------------------------------------------------------------
+
+Alarm::~Alarm() { delete sleepers; }
+
+//----------------------------------------------------------------------
+// Alarm::Arm
+// 	Make sure the alarm interrupt goes off no later than "when".
+//	Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void Alarm::Arm(int when) {
+  if (armedFor != -1 && armedFor <= when)
+    return; // an earlier interrupt is already on its way
+
+  armedFor = when;
+  interrupt->Schedule(AlarmHandler, this, when - stats->totalTicks, AlarmInt);
+}
+
+//----------------------------------------------------------------------
+// Alarm::WaitUntil
+// 	Put the current thread to sleep until "howLong" simulated ticks
+//	from now.  Other threads run in the meantime; if there are none,
+//	the simulated clock jumps ahead.
+//
+//	"howLong" is the number of ticks to sleep; nothing is done if it
+//	is not positive.
+//----------------------------------------------------------------------
+
+void Alarm::WaitUntil(int howLong) {
+  if (howLong <= 0)
+    return;
+
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  int when = stats->totalTicks + howLong;
+
+  DEBUG('t', "Thread \"%s\" sleeping until tick %d\n",
+        currentThread->getName(), when);
+  sleepers->SortedInsert(currentThread, when);
+  Arm(when);
+  currentThread->Sleep();
+
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Alarm::CallBack
+// 	The alarm interrupt went off.  Wake up every thread whose time
+//	has come, and schedule the interrupt for the next one.
+//----------------------------------------------------------------------
+
+void Alarm::CallBack() {
+  int now = stats->totalTicks;
+
+  if (armedFor != -1 && armedFor <= now)
+    armedFor = -1; // this is the interrupt we were waiting for
+
+  while (!sleepers->IsEmpty() && sleepers->FirstKey() <= now) {
+    Thread *thread = sleepers->Remove();
+    DEBUG('t', "Waking up thread \"%s\" at tick %d\n", thread->getName(), now);
+    scheduler->ReadyToRun(thread);
+  }
+
+  if (!sleepers->IsEmpty())
+    Arm(sleepers->FirstKey());
+}
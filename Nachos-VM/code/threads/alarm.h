@@ -0,0 +1,48 @@
+// alarm.h
+//	Data structures for a software alarm clock.
+//
+//	Threads can ask to be put to sleep for a number of simulated
+//	ticks.  Sleeping threads are kept in a queue sorted by wake up
+//	time, and an interrupt is scheduled for the earliest one; when it
+//	goes off, every thread whose time has come is put back on the
+//	ready list.
+//
+//	We don't use the periodic hardware timer for this: the machine
+//	stops when the only pending interrupt is the timer's, so sleeping
+//	threads would never wake up once everybody else is asleep.
+//	Instead, the alarm interrupt is a one-shot event of its own kind
+//	(AlarmInt), and the simulated clock jumps straight to it when
+//	there is nothing else to do.  Sleeping costs no host time at all.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "copyright.h"
+#include "thread.h"
+#include "waitqueue.h"
+
+// The following class defines the alarm clock.
+
+class Alarm {
+public:
+  Alarm();  // no sleeping threads
+  ~Alarm(); // de-allocate the sleeper queue
+
+  // Put the current thread to sleep for "howLong" simulated ticks
+  void WaitUntil(int howLong);
+
+  // Called from the alarm interrupt handler
+  void CallBack();
+
+private:
+  WaitQueue *sleepers; // sorted by the tick to wake up at
+  int armedFor;        // time of the next alarm interrupt, or -1
+
+  void Arm(int when); // make sure an interrupt happens at "when"
+};
+
+#endif // ALARM_H
@@ -37,6 +37,10 @@ class ListElement {
 //
 // By using the "Sorted" functions, the list can be kept in sorted
 // in increasing order by "key" in ListElement.
+//
+// List elements that are removed are kept in a free list, so that a
+// list that is used as a queue (a SynchList, for instance) stops
+// allocating once it has reached its usual length.
 
 template <class Item>
 class List {
@@ -56,11 +60,17 @@ class List {
     // Routines to put/get items on/off list in order (sorted by key)
     void SortedInsert(Item item, int sortKey);	// Put item into list
     Item SortedRemove(int *keyPtr); 	  	// Remove first item from list
+    int FirstKey();			// Key of the first item (list must
+					// not be empty)
 
   private:
     typedef ListElement<Item> ListNode;
     ListNode *first;  		// Head of the list, NULL if list is empty
     ListNode *last;		// Last element of list
+    ListNode *freeNodes;	// Elements ready to be reused
+
+    ListNode *NewNode(Item item, int sortKey);	// reuse or allocate
+    void FreeNode(ListNode *element);		// keep for reuse
 };
 
 //----------------------------------------------------------------------
@@ -89,6 +99,7 @@ template <class Item>
 List<Item>::List()
 { 
     first = last = NULL; 
+    freeNodes = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -108,13 +119,52 @@ List<Item>::~List()
     while ( !IsEmpty() ) {
       Remove();
     }
+    while (freeNodes != NULL) {
+	ListNode *element = freeNodes;
+	freeNodes = element->next;
+	delete element;
+    }
+}
+
+//----------------------------------------------------------------------
+// List::NewNode
+//	Return a ListElement for "item", taken from the free list if
+//	there is one there.
+//----------------------------------------------------------------------
+
+template <class Item>
+ListElement<Item> *
+List<Item>::NewNode(Item item, int sortKey)
+{
+    ListNode *element = freeNodes;
+
+    if (element == NULL)
+	return new ListNode(item, sortKey);
+    freeNodes = element->next;
+    element->next = NULL;
+    element->key = sortKey;
+    element->item = item;
+    return element;
+}
+
+//----------------------------------------------------------------------
+// List::FreeNode
+//	Keep a ListElement that was removed from the list, for reuse.
+//----------------------------------------------------------------------
+
+template <class Item>
+void
+List<Item>::FreeNode(ListNode *element)
+{
+    element->next = freeNodes;
+    freeNodes = element;
 }
 
 //----------------------------------------------------------------------
 // List::Append
 //      Append an "item" to the end of the list.
 //      
-//	Allocate a ListElement to keep track of the item.
+//	Get a ListElement to keep track of the item.
 //      If the list is empty, then this will be the only element.
 //	Otherwise, put it at the end.
 //
@@ -126,7 +176,7 @@ template <class Item>
 void
 List<Item>::Append(Item item)
 {
-    ListNode *element = new ListNode(item, 0);
+    ListNode *element = NewNode(item, 0);
 
     if (IsEmpty()) {		// list is empty
 	first = element;
@@ -141,7 +191,7 @@ List<Item>::Append(Item item)
 // List::Prepend
 //      Put an "item" on the front of the list.
 //      
-//	Allocate a ListElement to keep track of the item.
+//	Get a ListElement to keep track of the item.
 //      If the list is empty, then this will be the only element.
 //	Otherwise, put it at the beginning.
 //
@@ -153,7 +203,7 @@ template <class Item>
 void
 List<Item>::Prepend(Item item)
 {
-    ListNode *element = new ListNode(item, 0);
+    ListNode *element = NewNode(item, 0);
 
     if (IsEmpty()) {		// list is empty
 	first = element;
@@ -211,12 +261,26 @@ List<Item>::IsEmpty()
 	return false; 
 }
 
+//----------------------------------------------------------------------
+// List::FirstKey
+//      Returns the key of the item at the front of the list, without
+//	removing it.  The list must not be empty.
+//----------------------------------------------------------------------
+
+template <class Item>
+int
+List<Item>::FirstKey() 
+{ 
+    ASSERT(!IsEmpty());
+    return first->key;
+}
+
 //----------------------------------------------------------------------
 // List::SortedInsert
 //      Insert an "item" into a list, so that the list elements are
 //	sorted in increasing order by "sortKey".
 //      
-//	Allocate a ListElement to keep track of the item.
+//	Get a ListElement to keep track of the item.
 //      If the list is empty, then this will be the only element.
 //	Otherwise, walk through the list, one element at a time,
 //	to find where the new item should be placed.
@@ -230,7 +294,7 @@ template <class Item>
 void
 List<Item>::SortedInsert(Item item, int sortKey)
 {
-    ListNode *element = new ListNode(item, sortKey);
+    ListNode *element = NewNode(item, sortKey);
     ListNode *ptr;		// keep track
 
     if (IsEmpty()) {	// if list is empty, put
@@ -284,7 +348,7 @@ List<Item>::SortedRemove(int *keyPtr)
     }
     if (keyPtr != NULL)
         *keyPtr = element->key;
-    delete element;
+    FreeNode(element);
     return thing;
 }
 
@@ -18,12 +18,23 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -cs reports the contention of semaphores, locks and conditions
+//    -p [usecs] preempts kernel threads every "usecs" microseconds of
+//       CPU time, using a host timer
+//    -pt [instrs] preempts kernel threads every "instrs" native
+//       instructions, single-stepping Nachos with ptrace (slow)
 //    -z prints the copyright message
 //
+//  THREADS
+//    -tt <test> selects the kernel thread test to run (threadtest.cc)
+//
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
 //    -x runs a user program
 //    -c tests the console
+//    -sc runs the console I/O of user programs through the console device
+//    -ss [json file] counts the system calls and how long they take, and
+//       reports them at halt, also as JSON (syscalls.json by default)
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
@@ -33,6 +44,8 @@
 //    -l lists the contents of the Nachos directory
 //    -D prints the contents of the entire file system 
 //    -t tests the performance of the Nachos file system
+//    -ds <policy> orders the waiting disk requests: fcfs (the default),
+//       sstf, scan or clook
 //
 //  NETWORK
 //    -n sets the network reliability
@@ -56,7 +69,7 @@
 
 // External functions used by this file
 
-void ThreadTest();
+void ThreadTest(const char *name);
 void Copy(const char *unixFile, const char *nachosFile);
 void Print(const char *file);
 void PerformanceTest(void);
@@ -88,7 +101,11 @@ main(int argc, char **argv)
     (void) Initialize(argc, argv);
     
 #ifdef THREADS
-    ThreadTest();
+    const char *testName = "philo";	// kernel test to run, see -tt
+    for (int i = 1; i < argc - 1; i++)
+	if (!strcmp(argv[i], "-tt"))
+	    testName = argv[i + 1];
+    ThreadTest(testName);
 #endif
 
     for (argc--, argv++; argc > 0; argc -= argCount, argv += argCount) {
@@ -16,16 +16,24 @@
 
 // UNIX and Linux-specific headers
 #include <unistd.h>
+#include <signal.h>
 #include <sys/ptrace.h>
+#include <sys/time.h>
 #include <sys/wait.h>
 #include <sys/user.h>
 
 static void ContextSwitch ();
 static void MonitorProcess ( int childPid, unsigned long timeSliceLength );
 static void LetMeBeMonitored ();
+static void TimeSliceExpired ( int sig );
 
 static bool inContextSwitch = false;
 
+// Set by the host timer signal, cleared when the kernel preempts the
+// current thread
+static volatile sig_atomic_t sliceExpired = 0;
+static bool timerArmed = false;
+
 // Set up the preemptive scheduler
 // The 'timeSliceLength' argument means how many machine instructions
 // will last the time slice for every kernel thread
@@ -169,3 +177,74 @@ static void ContextSwitch (void)
 
 }
 
+
+
+// Set up the preemptive scheduler, with a host timer
+// The 'timeSliceLength' argument means how many microseconds of CPU
+// time will last the time slice for every kernel thread
+
+void PreemptiveScheduler::SetUpTimer ( unsigned long timeSliceLength )
+{
+  struct sigaction action;
+  struct itimerval slice;
+
+  action.sa_handler = TimeSliceExpired;
+  sigemptyset ( &action.sa_mask );
+  // don't make host system calls (reads from files, etc.) fail
+  action.sa_flags = SA_RESTART;
+  sigaction ( SIGVTALRM, &action, NULL );
+
+  slice.it_interval.tv_sec = timeSliceLength / 1000000;
+  slice.it_interval.tv_usec = timeSliceLength % 1000000;
+  slice.it_value = slice.it_interval;
+  setitimer ( ITIMER_VIRTUAL, &slice, NULL );
+  timerArmed = true;
+
+  DEBUG ( 'p', "Preemptive scheduler: time slice of %lu microseconds\n",
+          timeSliceLength );
+}
+
+
+// Stop the host timer, if it was started
+
+PreemptiveScheduler::~PreemptiveScheduler ()
+{
+  if ( timerArmed ) {
+    struct itimerval stop;
+    timerclear ( &stop.it_interval );
+    timerclear ( &stop.it_value );
+    setitimer ( ITIMER_VIRTUAL, &stop, NULL );
+    signal ( SIGVTALRM, SIG_IGN );
+    timerArmed = false;
+  }
+}
+
+
+// Signal handler for the host timer
+// It can interrupt Nachos anywhere, even in the middle of a list
+// operation, so it only leaves a note for the kernel
+
+static void TimeSliceExpired ( int sig )
+{
+  sliceExpired = 1;
+}
+
+
+// Check whether the time slice expired
+// Interrupt::OneTick calls this each time interrupts are enabled,
+// which is a point where it is always safe to switch threads.
+// As with the ptrace monitor, nothing is done while a forced
+// context switch is already on its way.
+
+bool PreemptiveScheduler::CheckPreemption ()
+{
+  if ( !sliceExpired || inContextSwitch )
+    return false;
+
+  sliceExpired = 0;
+  stats->numPreemptions++;
+
+  DEBUG ( 'p', "Preemptive scheduler: time slice of \"%s\" expired\n",
+          currentThread->getName() );
+  return true;
+}
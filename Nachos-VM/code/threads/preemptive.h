@@ -16,13 +16,28 @@ class PreemptiveScheduler
 {
   public:
     PreemptiveScheduler() {}
-    ~PreemptiveScheduler() {}
+    ~PreemptiveScheduler();
     
     // Set up time slicing between kernel threads.
     //   'timeSliceLength' is the time slice duration,
-    //   measured in native x86 machine instructions
+    //   measured in native x86 machine instructions.
+    // The process is single-stepped with ptrace, so this is very slow.
     
     void SetUp ( unsigned long timeSliceLength );
+
+    // Set up time slicing driven by a host interval timer.
+    //   'timeSliceLength' is the time slice duration,
+    //   measured in microseconds of CPU time used by Nachos.
+    // The signal handler only records that the slice expired; the
+    // switch is done later, at a safe point (see CheckPreemption).
+
+    void SetUpTimer ( unsigned long timeSliceLength );
+
+    // Called by the kernel at safe points, with interrupts enabled.
+    // Returns true if the time slice of the current thread expired,
+    // and the caller should Yield.
+
+    bool CheckPreemption ();
 };
 
 #endif
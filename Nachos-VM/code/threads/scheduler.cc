@@ -11,8 +11,10 @@
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	Threads run highest priority first, FIFO among threads of the
+//	same priority.  Since every thread starts with DefaultPriority,
+//	this is plain FIFO unless someone calls Thread::setPriority, or a
+//	thread inherits a priority through a Lock.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -29,7 +31,7 @@
 
 Scheduler::Scheduler()
 { 
-    readyList = new List<Thread*>; 
+    readyList = new WaitQueue(PRIORITY_ORDER); 
 } 
 
 //----------------------------------------------------------------------
@@ -12,6 +12,7 @@
 #include "copyright.h"
 #include "list.h"
 #include "thread.h"
+#include "waitqueue.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
@@ -29,7 +30,7 @@ class Scheduler {
     void Print();			// Print contents of ready list
     
   private:
-    List<Thread*> *readyList;  		// queue of threads that are ready to run,
+    WaitQueue *readyList;  		// queue of threads that are ready to run,
 					// but not running
 };
 
@@ -130,17 +130,21 @@ SWITCH:
 **      rbx     contains initial argument to thread function [InitialArg]
 **      rsi     points to thread function [InitialPC]
 **      rdi     point to Thread::Finish() [WhenDonePCState]
+**
+** the ABI wants rsp 16-byte aligned at every call (printf of a double
+** faults otherwise), so the three calls are made from the same depth
 */
 ThreadRoot:
         push   %rbp
         mov    %rsp,%rbp
         push   %rdi
         push   %rsi
+        sub    $8,%rsp		# keep rsp 16-byte aligned
         callq  *%rax		# StartupPC ()
         mov    %rbx,%rdi
-        pop    %rsi
+        mov    8(%rsp),%rsi
         callq  *%rsi		# InitialPC (InitialArg)
-        pop    %rsi
+        mov    16(%rsp),%rsi
         callq  *%rsi		# WhenDonePC ()
 
         # NOT REACHED
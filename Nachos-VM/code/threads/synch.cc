@@ -27,6 +27,20 @@
 #include "system.h"
 #include "thread.h"
 
+//----------------------------------------------------------------------
+// ProfileOf
+// 	Return the contention counters for an object of "kind" called
+//	"name", looking them up the first time into "*cache".  Returns
+//	NULL if contention profiling (-cs) is off.
+//----------------------------------------------------------------------
+
+static SyncStats *ProfileOf(SyncStats **cache, const char *kind,
+                            const char *name) {
+  if (*cache == NULL && syncProfiler != NULL)
+    *cache = syncProfiler->Lookup(kind, name);
+  return *cache;
+}
+
 //----------------------------------------------------------------------
 // Semaphore::Semaphore
 // 	Initialize a semaphore, so that it can be used for synchronization.
@@ -38,7 +52,9 @@
 Semaphore::Semaphore(const char *debugName, int initialValue) {
   name = (char *)debugName;
   value = initialValue;
-  queue = new List<Thread *>;
+  queue = new WaitQueue;
+  destroyed = false;
+  profile = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -61,13 +77,24 @@ Semaphore::~Semaphore() { delete queue; }
 
 void Semaphore::P() {
   IntStatus oldLevel = interrupt->SetLevel(IntOff); // disable interrupts
+  SyncStats *prof = ProfileOf(&profile, "Semaphore", name);
+  bool contended = (value == 0);
+  int waitStart = stats->totalTicks;
 
-  while (value == 0) {            // semaphore not available
-    queue->Append(currentThread); // so go to sleep
+  if (prof != NULL) {
+    prof->acquisitions++;
+    if (contended)
+      prof->contended++;
+  }
+  while (value == 0 && !destroyed) { // semaphore not available
+    queue->Append(currentThread);    // so go to sleep
     currentThread->Sleep();
   }
-  value--; // semaphore available,
-           // consume its value
+  if (!destroyed)
+    value--; // semaphore available,
+             // consume its value
+  if (prof != NULL && contended)
+    prof->waitTicks += stats->totalTicks - waitStart;
 
   interrupt->SetLevel(oldLevel); // re-enable interrupts
 }
@@ -95,19 +122,61 @@ void Semaphore::V() {
 //----------------------------------------------------------------------
 // Semaphore::Destroy
 // 	Destroy the semaphore, freeing the waiting threads
-//	This is used to destroy a user semaphore
+//	This is used to destroy a user semaphore.  The threads return
+//	from P() without decrementing the value, and so does any thread
+//	calling P() later; they can tell with isDestroyed().
 //----------------------------------------------------------------------
 
 void Semaphore::Destroy() {
   Thread *thread;
   IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
+  destroyed = true;
   while ((thread = queue->Remove()) != NULL) // make thread ready
     scheduler->ReadyToRun(thread);
 
   interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Lock::Destroy
+// 	Destroy the lock, freeing the waiting threads, which return from
+//	Acquire() without the lock.  This is used to destroy a user lock.
+//	The holder, if any, no longer holds it, and gives back the
+//	priority the waiters lent it.
+//----------------------------------------------------------------------
+
+void Lock::Destroy() {
+  Thread *thread;
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  destroyed = true;
+  while ((thread = waiters->Remove()) != NULL) {
+    thread->waitingOn = NULL;
+    scheduler->ReadyToRun(thread);
+  }
+  Disown();
+
+  interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Condition::Destroy
+// 	Destroy the condition, freeing the waiting threads, as a
+//	Broadcast would.  This is used to destroy a user condition.
+//----------------------------------------------------------------------
+
+void Condition::Destroy() {
+  Thread *thread;
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  destroyed = true;
+  while ((thread = hilos_esperando->Remove()) != NULL)
+    scheduler->ReadyToRun(thread);
+
+  interrupt->SetLevel(oldLevel);
+}
+
 #endif
 
 // Dummy functions -- so we can compile our later assignments
@@ -115,23 +184,134 @@ void Semaphore::Destroy() {
 // the test case in the network assignment won't work!
 Lock::Lock(const char *debugName) {
   this->name = (char *)debugName;
-  // Inicializa el semaforo en 1 (libre)
-  this->semaforo = new Semaphore("LOCK", 1);
+  // Inicializa el Lock libre
+  this->waiters = new WaitQueue(PRIORITY_ORDER);
   this->hilo_en_poder = NULL;
+  this->nextHeld = NULL;
+  this->destroyed = false;
+  this->profile = NULL;
+  this->acquiredAt = 0;
 }
 
-Lock::~Lock() { delete this->semaforo; }
+Lock::~Lock() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  this->Disown();
+  interrupt->SetLevel(oldLevel);
+  delete this->waiters;
+}
 
 void Lock::Acquire() {
-  this->semaforo->P();
-  this->hilo_en_poder = currentThread;
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  SyncStats *prof = ProfileOf(&profile, "Lock", name);
+  bool contended = (this->hilo_en_poder != NULL);
+  int waitStart = stats->totalTicks;
+
+  if (this->destroyed) {
+    interrupt->SetLevel(oldLevel);
+    return;
+  }
+  if (prof != NULL) {
+    prof->acquisitions++;
+    if (contended)
+      prof->contended++;
+  }
+  if (contended) {
+    // Presta la prioridad al hilo en poder (y a quien este espere)
+    currentThread->waitingOn = this;
+    this->waiters->Append(currentThread);
+    this->hilo_en_poder->RecomputePriority();
+    // INFO: Release entrega el Lock directamente, no hay que volver a
+    // competir por el
+    currentThread->Sleep();
+    if (this->destroyed && this->hilo_en_poder != currentThread) {
+      // WARN: destruido mientras esperabamos, volvemos sin el Lock
+      interrupt->SetLevel(oldLevel);
+      return;
+    }
+    ASSERT(this->hilo_en_poder == currentThread);
+  } else {
+    this->hilo_en_poder = currentThread;
+    this->nextHeld = currentThread->heldLocks;
+    currentThread->heldLocks = this;
+  }
+  this->acquiredAt = stats->totalTicks;
+  if (prof != NULL && contended)
+    prof->waitTicks += this->acquiredAt - waitStart;
+  interrupt->SetLevel(oldLevel);
 }
 
 void Lock::Release() {
   if (isHeldByCurrentThread()) {
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    if (this->HandOver())
+      currentThread->Yield();
+    interrupt->SetLevel(oldLevel);
+  }
+}
+
+//----------------------------------------------------------------------
+// Lock::HandOver
+// 	Release the lock held by the current thread, giving it to the
+//	waiter with the highest priority, if any.  Returns true if that
+//	waiter now outranks the current thread, which should then yield;
+//	Condition::Wait, about to sleep, does not.  Interrupts must be
+//	disabled.
+//----------------------------------------------------------------------
+
+bool Lock::HandOver() {
+  if (this->profile != NULL)
+    this->profile->holdTicks += stats->totalTicks - this->acquiredAt;
+
+  this->Unlink();
+  Thread *next = this->waiters->Remove();
+  if (next != NULL) {
+    // Se lo entrega al de mayor prioridad; los demas le prestan la suya
+    next->waitingOn = NULL;
+    this->hilo_en_poder = next;
+    this->nextHeld = next->heldLocks;
+    next->heldLocks = this;
+    next->RecomputePriority();
+    scheduler->ReadyToRun(next);
+  } else {
     this->hilo_en_poder = NULL;
-    this->semaforo->V();
   }
+
+  // Devuelve la prioridad prestada por los que esperaban este Lock
+  currentThread->RecomputePriority();
+  return next != NULL && next->getPriority() > currentThread->getPriority();
+}
+
+//----------------------------------------------------------------------
+// Lock::Unlink
+// 	Take the lock out of the list of locks held by its holder.
+//	Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void Lock::Unlink() {
+  Lock **link = &this->hilo_en_poder->heldLocks;
+
+  while (*link != this)
+    link = &(*link)->nextHeld;
+  *link = this->nextHeld;
+  this->nextHeld = NULL;
+}
+
+//----------------------------------------------------------------------
+// Lock::Disown
+// 	Take the lock away from its holder, if any, so that the holder's
+//	list of held locks does not keep pointing to a deleted lock.
+//	Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void Lock::Disown() {
+  Thread *holder = hilo_en_poder;
+
+  if (holder == NULL)
+    return;
+  Unlink();
+  hilo_en_poder = NULL;
+  holder->RecomputePriority();
 }
 
 bool Lock::isHeldByCurrentThread() {
@@ -140,19 +320,30 @@ bool Lock::isHeldByCurrentThread() {
 
 Condition::Condition(const char *debugName) {
   this->name = (char *)debugName;
-  this->hilos_esperando = new List<Thread *>;
+  this->hilos_esperando = new WaitQueue;
+  this->destroyed = false;
+  this->profile = NULL;
 }
 
 Condition::~Condition() { delete this->hilos_esperando; }
 
 void Condition::Wait(Lock *conditionLock) {
   if (conditionLock->isHeldByCurrentThread()) {
-    // Libera el Lock
-    conditionLock->Release();
     // Se asegura de agregar y dormir solo el hilo actual
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    SyncStats *prof = ProfileOf(&profile, "Condition", name);
+    int waitStart = stats->totalTicks;
     this->hilos_esperando->Append(currentThread);
+    // WARN: se libera el Lock ya en la cola, y sin ceder el CPU: quien lo
+    // recibe puede hacer Signal antes de que este hilo duerma
+    conditionLock->HandOver();
     currentThread->Sleep();
+    if (prof != NULL) {
+      // INFO: toda espera en una condicion cuenta como contendida
+      prof->acquisitions++;
+      prof->contended++;
+      prof->waitTicks += stats->totalTicks - waitStart;
+    }
     interrupt->SetLevel(oldLevel);
     // Obtiene devuelta el lock
     conditionLock->Acquire();
@@ -186,10 +377,182 @@ void Condition::Broadcast(Lock *conditionLock) {
 // void Mutex::Lock() {}
 //
 // void Mutex::Unlock() {}
+
+//----------------------------------------------------------------------
+// RWLock::RWLock
+// 	Initialize a reader-writer lock, free.
 //
-// // Barrier class
-// Barrier::Barrier(const char *debugName, int count) {}
-//
-// Barrier::~Barrier() {}
-//
-// void Barrier::Wait() {}
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+RWLock::RWLock(const char *debugName) {
+  name = (char *)debugName;
+  readers = 0;
+  writer = NULL;
+  readQueue = new WaitQueue;
+  writeQueue = new WaitQueue;
+  profile = NULL;
+}
+
+//----------------------------------------------------------------------
+// RWLock::~RWLock
+// 	De-allocate the lock.  Assume no one holds it, or waits for it.
+//----------------------------------------------------------------------
+
+RWLock::~RWLock() {
+  delete readQueue;
+  delete writeQueue;
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReadAcquire
+// 	Wait until there is no writer holding the lock, nor waiting for
+//	it, and join the readers.  If we have to wait, the writer that
+//	lets us in counts us as a reader before waking us up.
+//----------------------------------------------------------------------
+
+void RWLock::ReadAcquire() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  SyncStats *prof = ProfileOf(&profile, "RWLock", name);
+  bool contended = (writer != NULL || !writeQueue->IsEmpty());
+  int waitStart = stats->totalTicks;
+
+  if (contended) {
+    readQueue->Append(currentThread);
+    currentThread->Sleep();
+  } else {
+    readers++;
+  }
+  if (prof != NULL) {
+    prof->acquisitions++;
+    if (contended) {
+      prof->contended++;
+      prof->waitTicks += stats->totalTicks - waitStart;
+    }
+  }
+  interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReadRelease
+// 	Leave the readers.  The last reader out lets the first waiting
+//	writer in.
+//----------------------------------------------------------------------
+
+void RWLock::ReadRelease() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  ASSERT(readers > 0);
+  if (--readers == 0 && !writeQueue->IsEmpty()) {
+    writer = writeQueue->Remove();
+    scheduler->ReadyToRun(writer);
+  }
+  interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// RWLock::WriteAcquire
+// 	Wait until no one holds the lock, and take it.
+//----------------------------------------------------------------------
+
+void RWLock::WriteAcquire() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  SyncStats *prof = ProfileOf(&profile, "RWLock", name);
+  bool contended = (writer != NULL || readers > 0);
+  int waitStart = stats->totalTicks;
+
+  ASSERT(writer != currentThread);
+  if (contended) {
+    writeQueue->Append(currentThread);
+    currentThread->Sleep();
+    ASSERT(writer == currentThread);
+  } else {
+    writer = currentThread;
+  }
+  if (prof != NULL) {
+    prof->acquisitions++;
+    if (contended) {
+      prof->contended++;
+      prof->waitTicks += stats->totalTicks - waitStart;
+    }
+  }
+  interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// RWLock::WriteRelease
+// 	Give up the lock: to every waiting reader, as one batch, if
+//	there are any; otherwise to the next writer.
+//----------------------------------------------------------------------
+
+void RWLock::WriteRelease() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  Thread *thread;
+
+  ASSERT(writer == currentThread);
+  writer = NULL;
+  if (!readQueue->IsEmpty()) {
+    while ((thread = readQueue->Remove()) != NULL) {
+      readers++;
+      scheduler->ReadyToRun(thread);
+    }
+  } else if (!writeQueue->IsEmpty()) {
+    writer = writeQueue->Remove();
+    scheduler->ReadyToRun(writer);
+  }
+  interrupt->SetLevel(oldLevel);
+}
+
+bool RWLock::isWriteHeldByCurrentThread() { return writer == currentThread; }
+
+//----------------------------------------------------------------------
+// Barrier::Barrier
+// 	Initialize a barrier for "count" threads.
+//----------------------------------------------------------------------
+
+Barrier::Barrier(const char *debugName, int barrierCount) {
+  ASSERT(barrierCount > 0);
+  name = (char *)debugName;
+  count = barrierCount;
+  arrived = 0;
+  waiting = new WaitQueue;
+  profile = NULL;
+}
+
+//----------------------------------------------------------------------
+// Barrier::~Barrier
+// 	De-allocate the barrier.  Assume no one is waiting in it.
+//----------------------------------------------------------------------
+
+Barrier::~Barrier() { delete waiting; }
+
+//----------------------------------------------------------------------
+// Barrier::Wait
+// 	Wait until "count" threads have called Wait.  The last one to
+//	arrive wakes up the others, and starts a new phase; threads that
+//	call Wait again meanwhile wait for the next "count" arrivals.
+//----------------------------------------------------------------------
+
+void Barrier::Wait() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  SyncStats *prof = ProfileOf(&profile, "Barrier", name);
+  int waitStart = stats->totalTicks;
+  Thread *thread;
+
+  if (++arrived == count) {
+    arrived = 0;
+    while ((thread = waiting->Remove()) != NULL)
+      scheduler->ReadyToRun(thread);
+    if (prof != NULL)
+      prof->acquisitions++;
+  } else {
+    waiting->Append(currentThread);
+    currentThread->Sleep();
+    if (prof != NULL) {
+      prof->acquisitions++;
+      prof->contended++;
+      prof->waitTicks += stats->totalTicks - waitStart;
+    }
+  }
+  interrupt->SetLevel(oldLevel);
+}
@@ -5,7 +5,8 @@
 //	locks, and condition variables.  The implementation for
 //	semaphores is given; for the latter two, only the procedure
 //	interface is given -- they are to be implemented as part of
-//	the first assignment.
+//	the first assignment.  Reader-writer locks and barriers are
+//	built the same way, directly on wait queues.
 //
 //	Note that all the synchronization objects take a "name" as
 //	part of the initialization.  This is solely for debugging purposes.
@@ -19,7 +20,9 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "syncprofile.h"
 #include "thread.h"
+#include "waitqueue.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
@@ -42,7 +45,8 @@ public:
   ~Semaphore();                                       // de-allocate semaphore
   char *getName() { return name; }                    // debugging assist
   int getValue() { return value; }
-  void Destroy();
+  void Destroy(); // wake up every waiter, P() returns from now on
+  bool isDestroyed() { return destroyed; }
 
   void P(); // these are the only operations on a semaphore
   void V(); // they are both *atomic*
@@ -50,7 +54,9 @@ public:
 private:
   char *name;            // useful for debugging
   int value;             // semaphore value, always >= 0
-  List<Thread *> *queue; // threads waiting in P() for the value to be > 0
+  WaitQueue *queue;      // threads waiting in P() for the value to be > 0
+  bool destroyed;        // no more waiting, see Destroy
+  SyncStats *profile;    // contention counters, looked up on first use
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -64,6 +70,13 @@ private:
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).
+//
+// Locks lend priorities: while a thread waits for a lock, the holder
+// runs with at least the waiter's priority, and so on down the chain
+// if the holder is itself waiting for another lock.  Otherwise a low
+// priority holder could be kept off the CPU by medium priority threads
+// for as long as they like, and the high priority waiter with it.  On
+// Release, the lock is handed straight to the highest priority waiter.
 
 class Lock {
 public:
@@ -79,14 +92,30 @@ public:
                                 // checking in Release, and in
                                 // Condition variable ops below.
 
+  void Destroy(); // wake up every waiter, Acquire returns from now on
+  bool isDestroyed() { return destroyed; }
+
 private:
   char *name; // for debugging
               // plus some other stuff you'll need to define
 
-  // Semafoto binario para controlar el Lock
-  Semaphore *semaforo;
+  // Hilos esperando el Lock, el de mayor prioridad primero
+  WaitQueue *waiters;
   // Instancia del hilo a cargo del Lock
   Thread *hilo_en_poder;
+  // Siguiente Lock en poder del mismo hilo (Thread::heldLocks)
+  Lock *nextHeld;
+  friend class Thread;    // para calcular la prioridad heredada
+  friend class Condition; // Wait libera el Lock sin ceder el CPU
+
+  bool HandOver(); // liberar el Lock; true si hay que ceder el CPU
+  void Disown();   // quitarle el Lock a su duenio (al destruirlo)
+
+  void Unlink(); // quitar de la lista de locks de hilo_en_poder
+  bool destroyed; // ver Destroy
+
+  SyncStats *profile; // contention counters (-cs)
+  int acquiredAt;     // when the lock was acquired, for the hold time
 };
 
 // The following class defines a "condition variable".  A condition
@@ -136,12 +165,18 @@ public:
   void Broadcast(Lock *conditionLock); // the currentThread for all of
                                        // these operations
 
+  void Destroy(); // wake up every waiter, as a Broadcast would
+  bool isDestroyed() { return destroyed; }
+
 private:
   char *name;
   // plus some other stuff you'll need to define
 
   // Lista de los hilos que están esperando la variable de condicion
-  List<Thread *> *hilos_esperando;
+  WaitQueue *hilos_esperando;
+  bool destroyed; // ver Destroy
+
+  SyncStats *profile; // contention counters (-cs)
   // List<Semaphore *> *waitQueue; // list of waiting threads
 };
 
@@ -159,16 +194,66 @@ private:
 //   // plus some other stuff you'll need to define
 // };
 //
-// // The following class define a Barrier, each barrier will suspend "count"
-// // threads Once the required threads arrive at barrier point, they can
-// continue class Barrier { public:
-//   Barrier(const char *, int = 1);
-//   ~Barrier();
-//   void Wait();
+// The following class defines a "reader-writer lock".  Any number of
+// readers may hold it at the same time, or a single writer:
 //
-// private:
-//   char *name;
-//   // plus some other stuff you'll need to define
-// };
+//	ReadAcquire / ReadRelease -- share the lock with other readers
+//
+//	WriteAcquire / WriteRelease -- hold the lock alone
+//
+// The lock is fair to both sides.  A reader that arrives while a writer
+// holds the lock, or is waiting for it, waits too, so that a steady
+// flow of readers cannot starve the writers.  When a writer releases
+// the lock, every reader waiting at that point is let in as one batch,
+// ahead of the next writer; the next writer goes in when the batch is
+// done.  Readers and writers thus take turns, and no thread waits for
+// more than one batch of the other kind.
+//
+// As with Lock, the thread releasing the lock hands it to the threads
+// it wakes up, so they never have to compete for it again.
+
+class RWLock {
+public:
+  RWLock(const char *debugName); // initialize the lock to be FREE
+  ~RWLock();                     // deallocate the lock
+  char *getName() { return name; }
+
+  void ReadAcquire();  // wait until no writer has or wants the lock
+  void ReadRelease();
+  void WriteAcquire(); // wait until no one else has the lock
+  void WriteRelease();
+
+  bool isWriteHeldByCurrentThread(); // true if the current thread
+                                     // is the writer
+
+private:
+  char *name;
+  int readers;           // readers holding the lock
+  Thread *writer;        // writer holding the lock, or NULL
+  WaitQueue *readQueue;  // readers waiting for the current writer
+  WaitQueue *writeQueue; // writers waiting, in FIFO order
+  SyncStats *profile;    // contention counters (-cs)
+};
+
+// The following class defines a "barrier".  Each of "count" threads
+// calls Wait(); none of them returns until all of them have arrived.
+// The barrier then resets itself, so it can be used again for the next
+// phase of the computation.
+
+class Barrier {
+public:
+  Barrier(const char *debugName, int barrierCount = 1);
+  ~Barrier();
+  char *getName() { return name; }
+
+  void Wait(); // wait for the rest of the "count" threads
+
+private:
+  char *name;
+  int count;          // threads to wait for, in every phase
+  int arrived;        // threads already waiting in this phase
+  WaitQueue *waiting; // ... here
+  SyncStats *profile; // contention counters (-cs)
+};
 
 #endif // SYNCH_H
@@ -0,0 +1,131 @@
+// syncprofile.cc
+//	Routines to keep, and report, the contention counters of the
+//	synchronization objects.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "syncprofile.h"
+#include "copyright.h"
+#include "utility.h"
+
+//----------------------------------------------------------------------
+// SyncStats::SyncStats
+// 	Initialize the counters for objects of kind "objectKind" called
+//	"objectName".  The name is copied, since the objects may not
+//	outlive the report.
+//----------------------------------------------------------------------
+
+SyncStats::SyncStats(const char *objectKind, const char *objectName) {
+  kind = objectKind;
+  name = new char[strlen(objectName) + 1];
+  strcpy(name, objectName);
+  objects = acquisitions = contended = 0;
+  waitTicks = holdTicks = 0;
+  next = NULL;
+}
+
+SyncStats::~SyncStats() { delete[] name; }
+
+//----------------------------------------------------------------------
+// SyncProfiler::SyncProfiler
+// 	Initialize an empty table of counters.
+//----------------------------------------------------------------------
+
+SyncProfiler::SyncProfiler() {
+  for (int i = 0; i < SyncProfileBuckets; i++)
+    buckets[i] = NULL;
+  numEntries = 0;
+}
+
+//----------------------------------------------------------------------
+// SyncProfiler::~SyncProfiler
+// 	De-allocate the table.  Objects still holding a pointer to an
+//	entry must not be used after this.
+//----------------------------------------------------------------------
+
+SyncProfiler::~SyncProfiler() {
+  for (int i = 0; i < SyncProfileBuckets; i++) {
+    while (buckets[i] != NULL) {
+      SyncStats *entry = buckets[i];
+      buckets[i] = entry->next;
+      delete entry;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// SyncProfiler::Lookup
+// 	Find the entry for "kind" and "name", creating it if needed.
+//	Every caller counts as one more object sharing the entry.
+//----------------------------------------------------------------------
+
+SyncStats *SyncProfiler::Lookup(const char *kind, const char *name) {
+  unsigned hash = 5381;
+
+  if (name == NULL)
+    name = "(unnamed)";
+  for (const char *p = kind; *p != '\0'; p++)
+    hash = hash * 33 + (unsigned char)*p;
+  for (const char *p = name; *p != '\0'; p++)
+    hash = hash * 33 + (unsigned char)*p;
+
+  SyncStats **bucket = &buckets[hash % SyncProfileBuckets];
+  SyncStats *entry;
+  for (entry = *bucket; entry != NULL; entry = entry->next)
+    if (!strcmp(entry->kind, kind) && !strcmp(entry->name, name))
+      break;
+
+  if (entry == NULL) {
+    entry = new SyncStats(kind, name);
+    entry->next = *bucket;
+    *bucket = entry;
+    numEntries++;
+  }
+  entry->objects++;
+  return entry;
+}
+
+//----------------------------------------------------------------------
+// CompareEntries
+// 	Order for the report: longest total wait first, then most
+//	contended acquisitions, then most acquisitions.
+//----------------------------------------------------------------------
+
+static int CompareEntries(const void *a, const void *b) {
+  SyncStats *x = *(SyncStats **)a;
+  SyncStats *y = *(SyncStats **)b;
+
+  if (x->waitTicks != y->waitTicks)
+    return (x->waitTicks > y->waitTicks) ? -1 : 1;
+  if (x->contended != y->contended)
+    return y->contended - x->contended;
+  return y->acquisitions - x->acquisitions;
+}
+
+//----------------------------------------------------------------------
+// SyncProfiler::Print
+// 	Print every entry, the most contended first.
+//----------------------------------------------------------------------
+
+void SyncProfiler::Print() {
+  SyncStats **entries = new SyncStats *[numEntries];
+  int n = 0;
+
+  for (int i = 0; i < SyncProfileBuckets; i++)
+    for (SyncStats *entry = buckets[i]; entry != NULL; entry = entry->next)
+      entries[n++] = entry;
+  qsort(entries, n, sizeof(SyncStats *), CompareEntries);
+
+  printf("Synchronization contention (%d entries):\n", n);
+  printf("  %-10s %-24s %5s %9s %9s %11s %11s\n", "kind", "name", "objs",
+         "acquired", "contended", "wait ticks", "hold ticks");
+  for (int i = 0; i < n; i++) {
+    SyncStats *e = entries[i];
+    printf("  %-10s %-24s %5d %9d %9d %11lld %11lld\n", e->kind, e->name,
+           e->objects, e->acquisitions, e->contended, e->waitTicks,
+           e->holdTicks);
+  }
+  delete[] entries;
+}
@@ -0,0 +1,62 @@
+// syncprofile.h
+//	Data structures to find out which synchronization objects are
+//	contended.
+//
+//	When Nachos is started with the -cs flag, every Semaphore, Lock,
+//	Condition, RWLock and Barrier counts how many times it was used, how many of
+//	those times the caller had to wait, for how long (in simulated
+//	ticks), and, for locks, for how long they were held.  The
+//	counters are kept per kind of object and debug name, so that all
+//	the semaphores called "process exited", say, add up together.
+//
+//	Each object looks its entry up once, the first time it is used,
+//	and keeps a pointer to it.  Without -cs, the only cost is a test
+//	for NULL.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCPROFILE_H
+#define SYNCPROFILE_H
+
+#include "copyright.h"
+
+// Counters for all the objects with the same kind and name
+
+class SyncStats {
+public:
+  SyncStats(const char *objectKind, const char *objectName);
+  ~SyncStats();
+
+  const char *kind;  // "Semaphore", "Lock", "Condition", ...
+  char *name;        // debug name of the objects
+  int objects;       // how many objects share this entry
+  int acquisitions;  // P, Acquire or Wait calls
+  int contended;     // ... that had to wait
+  long long waitTicks; // simulated time spent waiting
+  long long holdTicks; // simulated time a lock was held
+  SyncStats *next;   // next entry in the same hash bucket
+};
+
+const int SyncProfileBuckets = 64;
+
+class SyncProfiler {
+public:
+  SyncProfiler();  // no entries
+  ~SyncProfiler(); // de-allocate every entry
+
+  // Return the entry for objects of "kind" called "name", creating it
+  // the first time
+  SyncStats *Lookup(const char *kind, const char *name);
+
+  void Print(); // report, most contended first
+
+private:
+  SyncStats *buckets[SyncProfileBuckets];
+  int numEntries;
+};
+
+extern SyncProfiler *syncProfiler; // NULL unless -cs was given
+
+#endif // SYNCPROFILE_H
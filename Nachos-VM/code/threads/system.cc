@@ -8,6 +8,7 @@
 #include "system.h"
 #include "copyright.h"
 #include "preemptive.h"
+#include <ctype.h>
 
 // This defines *all* of the global data structures used by Nachos.
 // These are all initialized and de-allocated by this file.
@@ -19,10 +20,14 @@ Interrupt *interrupt;        // interrupt status
 Statistics *stats;           // performance metrics
 Timer *timer;                // the hardware timer device,
                              // for invoking context switches
+ThreadPool *threadPool;      // recycled threads and stacks
+Alarm *alarmClock;           // threads sleeping for a while
+SyncProfiler *syncProfiler = NULL; // contention counters, with -cs
 
 // 2007, Jose Miguel Santos Espino
 PreemptiveScheduler *preemptiveScheduler = NULL;
-const long long DEFAULT_TIME_SLICE = 50000;
+const long long DEFAULT_TIME_SLICE = 50000;  // native instructions (-pt)
+const long long DEFAULT_TIMER_SLICE = 10000; // microseconds (-p)
 
 #ifdef FILESYS_NEEDED
 FileSystem *fileSystem;
@@ -30,6 +35,7 @@ FileSystem *fileSystem;
 
 #ifdef FILESYS
 SynchDisk *synchDisk;
+BufferCache *bufferCache;
 #endif
 
 // requires either FILESYS or FILESYS_STUB
@@ -37,14 +43,33 @@ SynchDisk *synchDisk;
 // user program memory and registers
 Machine *machine;
 
+// buffered console output of the user programs
+ConsoleWriter *consoleWriter;
+
+// interrupt-driven console of the user programs, with -sc
+SynchConsole *synchConsole = NULL;
+
+// kernel thread of the asynchronous I/O, started by the first IoEnter.
+// It is never deleted, its thread just sleeps until Nachos halts
+IoWorker *ioWorker = NULL;
+
 // Definicion del mapa de bits para la memoria
 BitMap *MapitaBits;
 
-// Definicion para tabla de archivso abiertos
-NachosOpenFilesTable *nachosTablita;
+// Que hay en cada marco de la memoria
+CoreMap *coreMap;
+
+// Segmentos de memoria compartida
+SharedMemoryTable *sharedMemory;
+
+// Programas ya leidos
+ExecCache *execCache;
+
+// contadores de las llamadas al sistema, con -ss
+SyscallProfiler *syscallProfiler = NULL;
 
-// Definicion de control para hilos abiertos
-BitMap *runningThreads;
+// Definicion de la tabla de procesos
+ProcessTable *processTable;
 
 // INFO: VM mantiene registro de paginas referenciadas de memoria
 BitMap *MemRef;
@@ -94,6 +119,9 @@ extern void Cleanup();
 //		whether it needs it or not.
 //----------------------------------------------------------------------
 static void TimerInterruptHandler(void *dummy) {
+#ifdef USER_PROGRAM
+  consoleWriter->Flush(); // output without a newline, such as a prompt
+#endif
   if (interrupt->getStatus() != IdleMode)
     interrupt->YieldOnReturn();
 }
@@ -116,17 +144,21 @@ void Initialize(int argc, char **argv) {
 
   // 2007, Jose Miguel Santos Espino
   bool preemptiveScheduling = false;
+  bool singleStepPreemption = false;
   long long timeSlice;
 
 #ifdef USER_PROGRAM
   // single step user program
   bool debugUserProg = false;
+  bool useSynchConsole = false;
   // INFO: Inicializacion mapa de bits para el procesador
   MapitaBits = new BitMap(NumPhysPages);
-  // INFO: Inicializacion de la tabla de archivos abiertos
-  nachosTablita = new NachosOpenFilesTable();
-  // INFO: Inicializacion de control para hilos abiertos
-  runningThreads = new BitMap(MaxNumProcesses);
+  coreMap = new CoreMap();
+  sharedMemory = new SharedMemoryTable();
+  execCache = new ExecCache();
+  // INFO: Inicializacion de la tabla de procesos
+  processTable = new ProcessTable();
+  consoleWriter = new ConsoleWriter(stdout);
   MemRef = new BitMap(NumPhysPages);
 #endif
 
@@ -151,6 +183,9 @@ void Initialize(int argc, char **argv) {
 #ifdef FILESYS_NEEDED
   bool format = false; // format disk
 #endif
+#ifdef FILESYS
+  DiskPolicy diskPolicy = DiskFCFS; // order of the waiting disk requests
+#endif
 #ifdef NETWORK
   double rely = 1; // network reliability
   int netname = 0; // UNIX socket name
@@ -165,6 +200,8 @@ void Initialize(int argc, char **argv) {
         debugArgs = *(argv + 1);
         argCount = 2;
       }
+    } else if (!strcmp(*argv, "-cs")) {
+      syncProfiler = new SyncProfiler(); // contention profiling
     } else if (!strcmp(*argv, "-rs")) {
       ASSERT(argc > 1);
       RandomInit(atoi(*(argv + 1))); // initialize pseudo-random
@@ -173,23 +210,49 @@ void Initialize(int argc, char **argv) {
       argCount = 2;
     }
     // 2007, Jose Miguel Santos Espino
-    else if (!strcmp(*argv, "-p")) {
+    // INFO: -p usa un timer del host, -pt el monitor con ptrace
+    else if (!strcmp(*argv, "-p") || !strcmp(*argv, "-pt")) {
       preemptiveScheduling = true;
-      if (argc == 1) {
-        timeSlice = DEFAULT_TIME_SLICE;
-      } else {
+      singleStepPreemption = !strcmp(*argv, "-pt");
+      if (argc > 1 && isdigit(**(argv + 1))) {
         timeSlice = atoi(*(argv + 1));
         argCount = 2;
+      } else {
+        timeSlice =
+            singleStepPreemption ? DEFAULT_TIME_SLICE : DEFAULT_TIMER_SLICE;
       }
     }
 #ifdef USER_PROGRAM
     if (!strcmp(*argv, "-s"))
       debugUserProg = true;
+    else if (!strcmp(*argv, "-sc"))
+      useSynchConsole = true;
+    else if (!strcmp(*argv, "-ss")) {
+      // INFO: el reporte en JSON va al archivo que siga, si no es otra opcion
+      if (argc > 1 && **(argv + 1) != '-') {
+        syscallProfiler = new SyscallProfiler(*(argv + 1));
+        argCount = 2;
+      } else {
+        syscallProfiler = new SyscallProfiler("syscalls.json");
+      }
+    }
 #endif
 #ifdef FILESYS_NEEDED
     if (!strcmp(*argv, "-f"))
       format = true;
 #endif
+#ifdef FILESYS
+    if (!strcmp(*argv, "-ds")) {
+      ASSERT(argc > 1);
+      if (!DiskPolicyNamed(*(argv + 1), &diskPolicy)) {
+        printf("Unknown disk scheduling policy %s; try fcfs, sstf, scan or "
+               "clook\n",
+               *(argv + 1));
+        ASSERT(false);
+      }
+      argCount = 2;
+    }
+#endif
 #ifdef NETWORK
     if (!strcmp(*argv, "-l")) {
       ASSERT(argc > 1);
@@ -205,8 +268,10 @@ void Initialize(int argc, char **argv) {
 
   DebugInit(debugArgs);        // initialize DEBUG messages
   stats = new Statistics();    // collect statistics
+  threadPool = new ThreadPool(); // recycle thread stacks
   interrupt = new Interrupt;   // start up interrupt handling
   scheduler = new Scheduler(); // initialize the ready queue
+  alarmClock = new Alarm();    // nobody is sleeping yet
   if (randomYield)             // start the timer (if needed)
     timer = new Timer(TimerInterruptHandler, 0, randomYield);
 
@@ -224,15 +289,21 @@ void Initialize(int argc, char **argv) {
   // Jose Miguel Santos Espino, 2007
   if (preemptiveScheduling) {
     preemptiveScheduler = new PreemptiveScheduler();
-    preemptiveScheduler->SetUp(timeSlice);
+    if (singleStepPreemption)
+      preemptiveScheduler->SetUp(timeSlice);
+    else
+      preemptiveScheduler->SetUpTimer(timeSlice);
   }
 
 #ifdef USER_PROGRAM
   machine = new Machine(debugUserProg); // this must come first
+  if (useSynchConsole)
+    synchConsole = new SynchConsole(NULL, NULL);
 #endif
 
 #ifdef FILESYS
-  synchDisk = new SynchDisk("DISK");
+  synchDisk = new SynchDisk("DISK", diskPolicy);
+  bufferCache = new BufferCache();
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -260,9 +331,14 @@ void Cleanup() {
 #endif
 
 #ifdef USER_PROGRAM
+  delete consoleWriter;
+  delete synchConsole;
   delete machine;
-  delete nachosTablita;
-  delete runningThreads;
+  delete processTable;
+  delete execCache;
+  delete syscallProfiler;
+  delete sharedMemory;
+  delete coreMap;
   delete MapitaBits;
 #endif
 
@@ -277,12 +353,16 @@ void Cleanup() {
 #endif
 
 #ifdef FILESYS
+  delete bufferCache;
   delete synchDisk;
 #endif
 
   delete timer;
+  delete alarmClock;
+  delete syncProfiler;
   delete scheduler;
   delete interrupt;
+  delete threadPool;
 
   Exit(0);
 }
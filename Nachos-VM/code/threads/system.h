@@ -8,11 +8,14 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include "alarm.h"
 #include "copyright.h"
 #include "interrupt.h"
 #include "scheduler.h"
 #include "stats.h"
+#include "syncprofile.h"
 #include "thread.h"
+#include "threadpool.h"
 #include "timer.h"
 #include "utility.h"
 
@@ -28,24 +31,53 @@ extern Scheduler *scheduler;        // the ready list
 extern Interrupt *interrupt;        // interrupt status
 extern Statistics *stats;           // performance metrics
 extern Timer *timer;                // the hardware alarm clock
+extern ThreadPool *threadPool;      // recycled threads and stacks
+extern Alarm *alarmClock;           // sleeping threads
+
+// 2007, Jose Miguel Santos Espino
+#include "preemptive.h"
+extern PreemptiveScheduler *preemptiveScheduler; // time slicing, or NULL
 
 #ifdef USER_PROGRAM
 #include "bitmap.h"
 #include "disk.h"
 #include "machine.h"
 #include "nachostablita.h"
+#include "consolewriter.h"
+#include "coremap.h"
+#include "execcache.h"
+#include "proctable.h"
+#include "sharedmem.h"
+#include "synchconsole.h"
+#include "syscalltable.h"
 
 // user program memory and registers
 extern Machine *machine;
 
+// buffered console output of the user programs
+extern ConsoleWriter *consoleWriter;
+
+// interrupt-driven console of the user programs, NULL unless -sc
+extern SynchConsole *synchConsole;
+
+// kernel thread of the asynchronous I/O, NULL until first needed
+class IoWorker;
+extern IoWorker *ioWorker;
+
 // Mapa de bits para la memoria del procesador
 extern BitMap *MapitaBits;
 
-// Tabla de archivos abiertos
-extern NachosOpenFilesTable *nachosTablita;
+// Que hay en cada marco de la memoria, y cuantas tablas lo mapean
+extern CoreMap *coreMap;
+
+// Segmentos de memoria compartida entre procesos
+extern SharedMemoryTable *sharedMemory;
+
+// Programas ya leidos, para el proximo Exec
+extern ExecCache *execCache;
 
-// Mapa con los IDs de los hilos corriendo
-extern BitMap *runningThreads;
+// Tabla de procesos, relaciona cada SpaceId con su PCB
+extern ProcessTable *processTable;
 
 // INFO: VM declaración de región de swap
 extern Disk *swap;
@@ -72,8 +104,10 @@ extern FileSystem *fileSystem;
 #endif
 
 #ifdef FILESYS
+#include "buffercache.h"
 #include "synchdisk.h"
 extern SynchDisk *synchDisk;
+extern BufferCache *bufferCache; // between the file system and synchDisk
 #endif
 
 #ifdef NETWORK
@@ -37,8 +37,14 @@ Thread::Thread(const char *threadName) {
   stackTop = NULL;
   stack = NULL;
   status = JUST_CREATED;
+  basePriority = priority = DefaultPriority;
+  heldLocks = waitingOn = NULL;
+  waitQueue = NULL;
+  waitNext = waitPrev = NULL;
+  waitKey = 0;
 #ifdef USER_PROGRAM
   space = NULL;
+  userStack = 0;
 #endif
 }
 
@@ -58,10 +64,30 @@ Thread::~Thread() {
   DEBUG('t', "Deleting thread \"%s\"\n", name);
 
   ASSERT(this != currentThread);
+  // WARN: los Locks que el hilo dejo tomados se quedan sin duenio, para
+  // que destruirlos despues no toque este hilo
+  while (heldLocks != NULL) {
+    Lock *lock = heldLocks;
+    heldLocks = lock->nextHeld;
+    lock->hilo_en_poder = NULL;
+    lock->nextHeld = NULL;
+  }
   if (stack != NULL)
-    DeallocBoundedArray((char *)stack, StackSize * sizeof(HostMemoryAddress));
+    threadPool->FreeStack(stack, name);
+}
+
+//----------------------------------------------------------------------
+// Thread::operator new, Thread::operator delete
+// 	Get the memory for a Thread object from the pool, and give it back
+//	there once the thread is destroyed.
+//----------------------------------------------------------------------
+
+void *Thread::operator new(size_t size) {
+  return threadPool->AllocThread(size);
 }
 
+void Thread::operator delete(void *p) { threadPool->FreeThread(p); }
+
 //----------------------------------------------------------------------
 // Thread::Fork
 // 	Invoke (*func)(arg), allowing caller and callee to execute
@@ -142,9 +168,6 @@ void Thread::Finish() {
   ASSERT(this == currentThread);
 
   DEBUG('t', "Finishing thread \"%s\" id: \n", getName());
-#ifdef USER_PROGRAM
-  runningThreads->SecureClear(currentThread->id);
-#endif
   threadToBeDestroyed = currentThread;
   Sleep(); // invokes SWITCH
            // not reached
@@ -156,9 +179,10 @@ void Thread::Finish() {
 //	If so, put the thread on the end of the ready list, so that
 //	it will eventually be re-scheduled.
 //
-//	NOTE: returns immediately if no other thread on the ready queue.
-//	Otherwise returns when the thread eventually works its way
-//	to the front of the ready list and gets re-scheduled.
+//	NOTE: returns immediately if no other thread on the ready queue
+//	has at least our priority.  Otherwise returns when the thread
+//	eventually works its way to the front of the ready list and gets
+//	re-scheduled.
 //
 //	NOTE: we disable interrupts, so that looking at the thread
 //	on the front of the ready list, and switching to it, can be done
@@ -176,14 +200,60 @@ void Thread::Yield() {
 
   DEBUG('t', "Yielding thread \"%s\"\n", getName());
 
+  // Go behind the threads of our priority first; if every other ready
+  // thread has a lower priority, we get picked again
+  scheduler->ReadyToRun(this);
   nextThread = scheduler->FindNextToRun();
-  if (nextThread != NULL) {
-    scheduler->ReadyToRun(this);
+  if (nextThread != this)
     scheduler->Run(nextThread);
-  }
+  else
+    setStatus(RUNNING);
+  interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Thread::setPriority
+// 	Change the base priority of the thread.  Its effective priority
+//	may stay higher, if it holds a lock that a more important thread
+//	is waiting for.
+//----------------------------------------------------------------------
+
+void Thread::setPriority(int p) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  basePriority = p;
+  RecomputePriority();
   interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Thread::RecomputePriority
+// 	Set the effective priority to the highest of the base priority and
+//	the priorities of the threads waiting for the locks we hold.
+//
+//	If it changes, the thread moves within the queue it is in (ready
+//	list or lock), and the holder of the lock it waits for, if any,
+//	is updated in turn; that is how a priority is lent down a chain
+//	of locks.  Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void Thread::RecomputePriority() {
+  int p = basePriority;
+
+  for (Lock *lock = heldLocks; lock != NULL; lock = lock->nextHeld)
+    if (!lock->waiters->IsEmpty() && lock->waiters->Front()->priority > p)
+      p = lock->waiters->Front()->priority;
+  if (p == priority)
+    return;
+
+  DEBUG('t', "Thread \"%s\" priority %d -> %d\n", name, priority, p);
+  priority = p;
+  if (waitQueue != NULL)
+    waitQueue->Requeue(this);
+  if (waitingOn != NULL && waitingOn->hilo_en_poder != NULL)
+    waitingOn->hilo_en_poder->RecomputePriority();
+}
+
 //----------------------------------------------------------------------
 // Thread::Sleep
 // 	Relinquish the CPU, because the current thread is blocked
@@ -243,8 +313,7 @@ static void InterruptEnable() { interrupt->Enable(); }
 //----------------------------------------------------------------------
 
 void Thread::StackAllocate(VoidFunctionPtr func, void *arg) {
-  stack = (HostMemoryAddress *)AllocBoundedArray(StackSize *
-                                                 sizeof(HostMemoryAddress));
+  stack = threadPool->AllocStack();
 
   // i386 & MIPS & SPARC stack works from high addresses to low addresses
   stackTop = stack + StackSize - 4; // -4 to be on the safe side!
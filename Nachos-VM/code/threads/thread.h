@@ -57,6 +57,12 @@ const int StackSize = 4 * 1024; // in words
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
 
+// Priority given to new threads
+const int DefaultPriority = 0;
+
+class Lock;
+class WaitQueue;
+
 // The following class defines a "thread control block" -- which
 // represents a single thread of execution.
 //
@@ -83,6 +89,10 @@ public:
                                  // must not be running when delete
                                  // is called
 
+  // Thread objects are recycled through the ThreadPool
+  static void *operator new(size_t size);
+  static void operator delete(void *p);
+
   // basic thread operations
   // Make thread run (*func)(arg)
   void Fork(VoidFunctionPtr func, void *arg);
@@ -100,6 +110,9 @@ public:
   void setStatus(ThreadStatus st) { status = st; }
   const char *getName() { return (name); }
   void Print() { printf("%s, ", name); }
+  int getPriority() { return priority; } // higher runs first
+  int getBasePriority() { return basePriority; }
+  void setPriority(int p); // change the base priority
 
 private:
   // some of the private data for this class is listed above
@@ -109,6 +122,23 @@ private:
                             // (If NULL, don't deallocate stack)
   ThreadStatus status;      // ready, running or blocked
   const char *name;
+  int basePriority; // priority given with setPriority
+  int priority;     // basePriority, or more if lent by lock waiters
+
+  // Priority inheritance: the locks this thread holds, and the one it
+  // is waiting for, if any
+  friend class Lock;
+  Lock *heldLocks;
+  Lock *waitingOn;
+  void RecomputePriority(); // interrupts must be disabled
+
+  // Links for the queue the thread is waiting in (ready list, semaphore,
+  // ...), so that blocking does not need to allocate anything
+  friend class WaitQueue;
+  WaitQueue *waitQueue; // NULL if not in any queue
+  Thread *waitNext;
+  Thread *waitPrev;
+  int waitKey; // for sorted queues
 
   void StackAllocate(VoidFunctionPtr func, void *arg);
   // Allocate a stack for thread.
@@ -127,6 +157,7 @@ public:
 
   AddrSpace *space; // User code this thread is running.
   int id; // Unique idenfiier for this user program
+  int userStack; // initial stack pointer of a Forked thread, 0 if not
 #endif
 };
 
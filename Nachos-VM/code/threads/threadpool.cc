@@ -0,0 +1,133 @@
+// threadpool.cc
+//	Routines to recycle thread objects and execution stacks.
+//
+//	The pool is only touched from Thread::operator new/delete,
+//	Thread::StackAllocate and Thread::~Thread.  Threads are destroyed by
+//	Scheduler::Run, with interrupts disabled, so the routines here do
+//	not need any further synchronization.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "threadpool.h"
+#include "copyright.h"
+#include "system.h"
+#include "thread.h"
+
+//----------------------------------------------------------------------
+// ThreadPool::ThreadPool
+// 	Initialize an empty pool.
+//----------------------------------------------------------------------
+
+ThreadPool::ThreadPool() {
+  numStacks = 0;
+  numThreads = 0;
+  threadSize = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::~ThreadPool
+// 	Give the pooled memory back to the host.
+//----------------------------------------------------------------------
+
+ThreadPool::~ThreadPool() {
+  while (numStacks > 0)
+    DeallocBoundedArray((char *)stacks[--numStacks],
+                        StackSize * sizeof(HostMemoryAddress));
+  while (numThreads > 0)
+    ::operator delete(threads[--numThreads]);
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::AllocStack
+// 	Return a stack of StackSize words, with every word painted.  A
+//	stack from the pool is already painted; a new one is obtained from
+//	AllocBoundedArray, so it has its guard pages on both sides.
+//----------------------------------------------------------------------
+
+HostMemoryAddress *ThreadPool::AllocStack() {
+  HostMemoryAddress *stack;
+
+  if (numStacks > 0) {
+    stats->numStacksReused++;
+    return stacks[--numStacks];
+  }
+
+  stack = (HostMemoryAddress *)AllocBoundedArray(StackSize *
+                                                 sizeof(HostMemoryAddress));
+  for (int i = 0; i < StackSize; i++)
+    stack[i] = STACK_PAINT;
+  stats->numStacksMapped++;
+  return stack;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::StackUsage
+// 	Return how many words of "stack" were written since it was last
+//	painted.  Stacks grow from high to low addresses, so we look for
+//	the first word, from the bottom, that still has the paint on it.
+//	Word 0 has the fence post, it is not part of the usable stack.
+//----------------------------------------------------------------------
+
+int ThreadPool::StackUsage(HostMemoryAddress *stack) {
+  int i = 1;
+
+  while (i < StackSize && stack[i] == STACK_PAINT)
+    i++;
+  return StackSize - i;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::FreeStack
+// 	Take back the stack of a finished thread.  Record how deep the
+//	thread went, and paint again only the words it used.
+//
+//	"stack" is the bottom of the stack, as returned by AllocStack.
+//	"name" is the name of the thread, for debugging.
+//----------------------------------------------------------------------
+
+void ThreadPool::FreeStack(HostMemoryAddress *stack, const char *name) {
+  int used = StackUsage(stack);
+  int bytes = used * sizeof(HostMemoryAddress);
+
+  DEBUG('t', "Thread \"%s\" used %d of %d bytes of stack\n", name, bytes,
+        (int)(StackSize * sizeof(HostMemoryAddress)));
+  if (bytes > stats->maxStackUsage)
+    stats->maxStackUsage = bytes;
+
+  if (numStacks == MaxPooledStacks) {
+    DeallocBoundedArray((char *)stack, StackSize * sizeof(HostMemoryAddress));
+    return;
+  }
+  for (int i = StackSize - used; i < StackSize; i++)
+    stack[i] = STACK_PAINT;
+  stacks[numStacks++] = stack;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::AllocThread
+// 	Return memory for a Thread object, reusing a finished one if
+//	possible.
+//----------------------------------------------------------------------
+
+void *ThreadPool::AllocThread(size_t size) {
+  stats->numThreadsCreated++;
+  if (numThreads > 0 && size == threadSize)
+    return threads[--numThreads];
+  threadSize = size;
+  return ::operator new(size);
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::FreeThread
+// 	Keep the memory of a destroyed Thread object for the next one.
+//----------------------------------------------------------------------
+
+void ThreadPool::FreeThread(void *p) {
+  if (numThreads == MaxPooledThreads) {
+    ::operator delete(p);
+    return;
+  }
+  threads[numThreads++] = p;
+}
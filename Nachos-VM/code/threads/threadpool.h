@@ -0,0 +1,60 @@
+// threadpool.h
+//	Data structures to recycle thread control blocks and execution
+//	stacks.
+//
+//	Creating a kernel thread used to cost one allocation for the
+//	Thread object, plus one allocation (and its boundary pages) for
+//	the stack; both were given back as soon as the thread finished.
+//	Programs that Exec and Fork a lot, like the shell, paid that
+//	price for every command.  Instead, finished threads leave their
+//	memory in this pool, with the guard pages of the stacks still
+//	mapped, and the next thread picks it up from there.
+//
+//	Stacks are painted with a known pattern.  When a stack comes back
+//	to the pool, the pattern tells how deep the thread went, which is
+//	kept as a high-water mark to help choose StackSize.  Only the part
+//	that was used needs to be painted again.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// Pattern written on every word of an unused stack
+const HostMemoryAddress STACK_PAINT = (HostMemoryAddress)0xcafebabecafebabeULL;
+
+// How many free stacks and thread objects we keep around; anything
+// beyond this is given back to the host.
+const int MaxPooledStacks = 64;
+const int MaxPooledThreads = 256;
+
+class ThreadPool {
+public:
+  ThreadPool();  // empty pool
+  ~ThreadPool(); // give everything back to the host
+
+  // Return a painted stack of StackSize words, bounded by guard pages
+  HostMemoryAddress *AllocStack();
+  // Take back a stack, measure how much of it was used
+  void FreeStack(HostMemoryAddress *stack, const char *name);
+
+  // Raw memory for Thread objects, see Thread::operator new
+  void *AllocThread(size_t size);
+  void FreeThread(void *p);
+
+private:
+  HostMemoryAddress *stacks[MaxPooledStacks]; // free stacks
+  int numStacks;
+  void *threads[MaxPooledThreads]; // free thread objects
+  int numThreads;
+  size_t threadSize; // size of the objects in "threads"
+
+  int StackUsage(HostMemoryAddress *stack); // words used, from the top
+};
+
+#endif // THREADPOOL_H
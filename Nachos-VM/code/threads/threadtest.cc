@@ -12,8 +12,8 @@
 
 #include "copyright.h"
 #include "diningph.h"
+#include "synchlist.h"
 #include "system.h"
-#include <unistd.h>
 
 DiningPh *dp;
 
@@ -33,13 +33,14 @@ void Philo(void *p) {
     eats = Random() % 6;
 
     currentThread->Yield();
-    sleep(eats);
+    // INFO: duerme en tiempo simulado, no detiene al simulador
+    alarmClock->WaitUntil(eats * TimerTicks);
 
     dp->putdown(who);
 
     thinks = Random() % 6;
     currentThread->Yield();
-    sleep(thinks);
+    alarmClock->WaitUntil(thinks * TimerTicks);
   }
 }
 
@@ -71,16 +72,395 @@ void SimpleThread(void *name) {
 }
 
 //----------------------------------------------------------------------
-// ThreadTest
-// 	Set up a ping-pong between several threads, by launching
-//	ten threads which call SimpleThread, and finally calling
-//	SimpleThread ourselves.
+// ProdConsTest
+// 	Producers and consumers sharing a SynchList.  Every item produced
+//	must be consumed exactly once; the consumers add up what they
+//	get, and the last one to finish checks the total.
+//
+//	Blocking and waking up goes through Lock, Condition and the
+//	wait queues in the threads, and the list reuses its elements, so
+//	once the list has grown nothing is allocated per item.
 //----------------------------------------------------------------------
 
-void ThreadTest() {
-  Thread *Ph;
+static const int NumProducers = 2;
+static const int NumConsumers = 3;
+static const int ItemsPerProducer = 1000;
+
+static SynchList<long> *buffer;
+static long consumedSum;
+static int consumersDone;
+
+static void Producer(void *arg) {
+  long who = (long)arg;
+
+  for (long i = 1; i <= ItemsPerProducer; i++) {
+    buffer->Append(i);
+    if (i % 100 == who)
+      currentThread->Yield();
+  }
+}
+
+static void Consumer(void *arg) {
+  long share = (long)arg;
+  long sum = 0;
+
+  for (long i = 0; i < share; i++)
+    sum += buffer->Remove();
+
+  consumedSum += sum;
+  if (++consumersDone == NumConsumers) {
+    long expected = (long)NumProducers * ItemsPerProducer *
+                    (ItemsPerProducer + 1) / 2;
+    printf("ProdCons: consumed %ld, expected %ld: %s\n", consumedSum, expected,
+           consumedSum == expected ? "ok" : "FAILED");
+  }
+}
+
+static void ProdConsTest() {
+  int total = NumProducers * ItemsPerProducer;
+
+  buffer = new SynchList<long>;
+  consumedSum = 0;
+  consumersDone = 0;
+  for (long k = 0; k < NumConsumers; k++) {
+    long share = total / NumConsumers + (k < total % NumConsumers ? 1 : 0);
+    (new Thread("consumer"))->Fork(Consumer, (void *)share);
+  }
+  for (long k = 0; k < NumProducers; k++)
+    (new Thread("producer"))->Fork(Producer, (void *)k);
+}
+
+//----------------------------------------------------------------------
+// PriorityTest
+// 	Priority inversion: a low priority thread holds a lock, medium
+//	priority threads keep the CPU busy, and a high priority thread
+//	wants the lock.  Without priority inheritance, the high priority
+//	thread waits until every medium priority thread is done; with it,
+//	only until the low priority thread finishes its critical section.
+//
+//	The high priority thread measures its wait for the lock over a
+//	few rounds, and checks the worst one against that bound.
+//----------------------------------------------------------------------
+
+static const int PriorityRounds = 5;
+static const int NumMedium = 3;
+static const int HoldYields = 10;  // work done by "low" holding the lock
+static const int SpinYields = 200; // work done by each "medium"
+
+static Lock *sharedLock;
+static Semaphore *lowHolds;  // "low" got the lock
+static Semaphore *roundDone; // one more low or medium thread finished
+
+static void LowPriority(void *) {
+  sharedLock->Acquire();
+  lowHolds->V();
+  for (int i = 0; i < HoldYields; i++)
+    currentThread->Yield();
+  sharedLock->Release();
+  roundDone->V();
+}
+
+static void MediumPriority(void *) {
+  for (int i = 0; i < SpinYields; i++)
+    currentThread->Yield();
+  roundDone->V();
+}
+
+static void HighPriority(void *) {
+  int worst = 0;
+  // the critical section, with room for context switches and timer
+  // interrupts (-rs); inversion would cost NumMedium * SpinYields
+  int bound = 2 * HoldYields * SystemTick;
+
+  for (int round = 0; round < PriorityRounds; round++) {
+    Thread *t = new Thread("low");
+    t->Fork(LowPriority, NULL);
+    lowHolds->P();
+
+    for (int k = 0; k < NumMedium; k++) {
+      t = new Thread("medium");
+      t->setPriority(DefaultPriority + 1);
+      t->Fork(MediumPriority, NULL);
+    }
+    // let the medium threads take over the CPU
+    alarmClock->WaitUntil(HoldYields * SystemTick / 2);
+
+    int start = stats->totalTicks;
+    sharedLock->Acquire();
+    int waited = stats->totalTicks - start;
+    sharedLock->Release();
+    if (waited > worst)
+      worst = waited;
+
+    for (int k = 0; k < NumMedium + 1; k++)
+      roundDone->P();
+  }
+  printf("Priority: worst wait %d ticks in %d rounds, bound %d: %s\n", worst,
+         PriorityRounds, bound, worst <= bound ? "ok" : "FAILED");
+}
+
+static void PriorityTest() {
+  sharedLock = new Lock("priority lock");
+  lowHolds = new Semaphore("low holds", 0);
+  roundDone = new Semaphore("round done", 0);
+
+  Thread *t = new Thread("high");
+  t->setPriority(DefaultPriority + 2);
+  t->Fork(HighPriority, NULL);
+}
+
+//----------------------------------------------------------------------
+// RWLockTest
+// 	Readers and writers sharing two counters, which writers always
+//	leave equal.  Readers must never see them differ, writers must
+//	never find a reader inside, and readers must get to share the
+//	lock now and then.
+//----------------------------------------------------------------------
+
+static const int NumReaders = 5;
+static const int NumWriters = 2;
+static const int RWRounds = 20;
+
+static RWLock *rwLock;
+static int sharedA, sharedB;
+static int activeReaders, maxReaders;
+static int rwFinished;
+static bool rwBroken;
+
+static void RWFinish() {
+  if (++rwFinished < NumReaders + NumWriters)
+    return;
+  bool ok = !rwBroken && sharedA == NumWriters * RWRounds && maxReaders > 1;
+  printf("RWLock: %d writes, up to %d readers at once: %s\n", sharedA,
+         maxReaders, ok ? "ok" : "FAILED");
+}
+
+static void Reader(void *) {
+  for (int i = 0; i < RWRounds; i++) {
+    rwLock->ReadAcquire();
+    if (++activeReaders > maxReaders)
+      maxReaders = activeReaders;
+    if (sharedA != sharedB)
+      rwBroken = true;
+    currentThread->Yield();
+    if (sharedA != sharedB)
+      rwBroken = true;
+    activeReaders--;
+    rwLock->ReadRelease();
+    currentThread->Yield();
+  }
+  RWFinish();
+}
+
+static void Writer(void *) {
+  for (int i = 0; i < RWRounds; i++) {
+    rwLock->WriteAcquire();
+    if (activeReaders != 0)
+      rwBroken = true;
+    sharedA++;
+    currentThread->Yield();
+    sharedB++;
+    rwLock->WriteRelease();
+    currentThread->Yield();
+  }
+  RWFinish();
+}
+
+static void RWLockTest() {
+  rwLock = new RWLock("rw test");
+  sharedA = sharedB = 0;
+  activeReaders = maxReaders = 0;
+  rwFinished = 0;
+  rwBroken = false;
+  for (int k = 0; k < NumReaders + NumWriters; k++)
+    (new Thread(k < NumReaders ? "reader" : "writer"))
+        ->Fork(k < NumReaders ? Reader : Writer, NULL);
+}
 
-  DEBUG('t', "Entering SimpleTest");
+//----------------------------------------------------------------------
+// BarrierTest
+// 	Threads going through several phases, in step.  After the
+//	barrier, every thread must have finished the phase; nobody can be
+//	more than one phase ahead.
+//----------------------------------------------------------------------
+
+static const int NumBarrierThreads = 4;
+static const int NumPhases = 5;
+
+static Barrier *barrier;
+static int phaseOf[NumBarrierThreads];
+static int barrierFinished;
+static bool barrierBroken;
+
+static void BarrierThread(void *arg) {
+  long me = (long)arg;
+
+  for (int phase = 0; phase < NumPhases; phase++) {
+    for (long i = 0; i <= (me + phase) % NumBarrierThreads; i++)
+      currentThread->Yield(); // uneven amounts of work
+    phaseOf[me] = phase;
+    barrier->Wait();
+    for (int k = 0; k < NumBarrierThreads; k++)
+      if (phaseOf[k] < phase || phaseOf[k] > phase + 1)
+        barrierBroken = true;
+  }
+  if (++barrierFinished == NumBarrierThreads)
+    printf("Barrier: %d threads through %d phases: %s\n", NumBarrierThreads,
+           NumPhases, barrierBroken ? "FAILED" : "ok");
+}
+
+static void BarrierTest() {
+  barrier = new Barrier("phase barrier", NumBarrierThreads);
+  barrierFinished = 0;
+  barrierBroken = false;
+  for (long k = 0; k < NumBarrierThreads; k++) {
+    phaseOf[k] = -1;
+    (new Thread("phase"))->Fork(BarrierThread, (void *)k);
+  }
+}
+
+//----------------------------------------------------------------------
+// RWBench
+// 	Read-mostly workload, such as lookups in a directory that has to
+//	be read from disk: every operation sleeps for a while, holding
+//	the lock.  The same operations are run first under a Lock, then
+//	under an RWLock, and the simulated time of each is reported.
+//----------------------------------------------------------------------
+
+static const int NumBenchThreads = 6;
+static const int BenchOps = 20;
+static const int BenchWriteEvery = 10; // one write every so many ops
+static const int BenchOpTicks = 50;    // time spent inside the lock
+
+static Lock *benchLock;
+static RWLock *benchRWLock;
+static Semaphore *benchDone;
+
+static void BenchThread(void *arg) {
+  bool shared = (arg != NULL);
+
+  for (int i = 1; i <= BenchOps; i++) {
+    bool write = (i % BenchWriteEvery == 0);
+    if (!shared)
+      benchLock->Acquire();
+    else if (write)
+      benchRWLock->WriteAcquire();
+    else
+      benchRWLock->ReadAcquire();
+
+    alarmClock->WaitUntil(BenchOpTicks);
+
+    if (!shared)
+      benchLock->Release();
+    else if (write)
+      benchRWLock->WriteRelease();
+    else
+      benchRWLock->ReadRelease();
+  }
+  benchDone->V();
+}
+
+static int BenchRun(bool shared) {
+  int start = stats->totalTicks;
+
+  for (int k = 0; k < NumBenchThreads; k++)
+    (new Thread("bench"))->Fork(BenchThread, shared ? (void *)1 : NULL);
+  for (int k = 0; k < NumBenchThreads; k++)
+    benchDone->P();
+  return stats->totalTicks - start;
+}
+
+static void BenchDriver(void *) {
+  int exclusive = BenchRun(false);
+  int shared = BenchRun(true);
+
+  printf("RWBench: %d threads, %d ops each, 1 in %d a write: "
+         "Lock %d ticks, RWLock %d ticks\n",
+         NumBenchThreads, BenchOps, BenchWriteEvery, exclusive, shared);
+}
+
+static void RWBench() {
+  benchLock = new Lock("bench lock");
+  benchRWLock = new RWLock("bench rwlock");
+  benchDone = new Semaphore("bench done", 0);
+  (new Thread("bench driver"))->Fork(BenchDriver, NULL);
+}
+
+#ifdef FILESYS
+//----------------------------------------------------------------------
+// DiskTest
+// 	Out of order requests to a disk of its own, with each scheduling
+//	policy: one thread keeps the disk busy at DiskStartTrack, the
+//	others queue behind it in the order of diskTracks, and each notes
+//	its track when its read is done.  The order they were served in
+//	must be the one the policy asks for.
+//----------------------------------------------------------------------
+
+static const int DiskStartTrack = 16;
+static const int NumDiskTracks = 6;
+static const int diskTracks[NumDiskTracks] = {20, 14, 30, 10, 25, 5};
+
+// The order of service of each policy, after DiskStartTrack; the head
+// comes from track 0, so SCAN goes up first
+static const int diskOrder[][NumDiskTracks] = {
+    {20, 14, 30, 10, 25, 5}, // FCFS
+    {14, 10, 5, 20, 25, 30}, // SSTF
+    {20, 25, 30, 14, 10, 5}, // SCAN
+    {20, 25, 30, 5, 10, 14}, // CLOOK
+};
+
+static SynchDisk *testDisk;
+static Semaphore *diskDone;
+static int diskServed[NumDiskTracks + 1];
+static int numDiskServed;
+
+static void DiskReader(void *arg) {
+  char data[SectorSize];
+
+  testDisk->ReadSector((long)arg * SectorsPerTrack, data);
+  diskServed[numDiskServed++] = (long)arg;
+  diskDone->V();
+}
+
+static void DiskDriver(void *) {
+  static const char *names[] = {"fcfs", "sstf", "scan", "clook"};
+
+  for (int p = DiskFCFS; p <= DiskCLOOK; p++) {
+    testDisk = new SynchDisk("DISK_SCHED", (DiskPolicy)p);
+    numDiskServed = 0;
+    (new Thread("disk"))->Fork(DiskReader, (void *)(long)DiskStartTrack);
+    for (int k = 0; k < NumDiskTracks; k++)
+      (new Thread("disk"))->Fork(DiskReader, (void *)(long)diskTracks[k]);
+    for (int k = 0; k <= NumDiskTracks; k++)
+      diskDone->P();
+
+    bool ok = diskServed[0] == DiskStartTrack;
+    printf("Disk test (%s): tracks", names[p]);
+    for (int k = 0; k <= NumDiskTracks; k++) {
+      printf(" %d", diskServed[k]);
+      if (k > 0 && diskServed[k] != diskOrder[p][k - 1])
+        ok = false;
+    }
+    printf(": %s\n", ok ? "ok" : "WRONG ORDER");
+    testDisk->Print();
+    delete testDisk;
+  }
+  Unlink("DISK_SCHED");
+}
+
+static void DiskTest() {
+  diskDone = new Semaphore("disk test done", 0);
+  (new Thread("disk driver"))->Fork(DiskDriver, NULL);
+}
+#endif
+
+//----------------------------------------------------------------------
+// PhiloTest
+// 	Five dining philosophers, sharing the DiningPh monitor.
+//----------------------------------------------------------------------
+
+static void PhiloTest() {
+  Thread *Ph;
 
   dp = new DiningPh();
 
@@ -88,6 +468,37 @@ void ThreadTest() {
     Ph = new Thread("dp");
     Ph->Fork(Philo, (void *)k);
   }
+}
+
+//----------------------------------------------------------------------
+// ThreadTest
+// 	Run the kernel thread test called "name" (see the -tt flag in
+//	main.cc).  The dining philosophers are the default.
+//----------------------------------------------------------------------
+
+void ThreadTest(const char *name) {
+  DEBUG('t', "Entering ThreadTest %s\n", name);
+
+  if (!strcmp(name, "philo"))
+    PhiloTest();
+  else if (!strcmp(name, "prodcons"))
+    ProdConsTest();
+  else if (!strcmp(name, "priority"))
+    PriorityTest();
+  else if (!strcmp(name, "rwlock"))
+    RWLockTest();
+  else if (!strcmp(name, "barrier"))
+    BarrierTest();
+  else if (!strcmp(name, "rwbench"))
+    RWBench();
+#ifdef FILESYS
+  else if (!strcmp(name, "disk"))
+    DiskTest();
+#endif
+  else
+    printf("Unknown thread test %s; try philo, prodcons, priority, rwlock, "
+           "barrier, rwbench or disk (with FILESYS)\n",
+           name);
 
   return;
   // for (int k = 1; k < 5; k++) {
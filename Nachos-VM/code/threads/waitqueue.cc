@@ -0,0 +1,169 @@
+// waitqueue.cc
+//	Routines to manage queues of threads, linked through the threads
+//	themselves.
+//
+//	None of these routines disable interrupts; like the List they
+//	replace, the caller is expected to do so.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "waitqueue.h"
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// WaitQueue::WaitQueue
+// 	Initialize an empty queue.
+//
+//	"queueOrder" tells whether Append keeps the threads in FIFO order
+//	or sorted by priority.
+//----------------------------------------------------------------------
+
+WaitQueue::WaitQueue(QueueOrder queueOrder) {
+  first = last = NULL;
+  length = 0;
+  order = queueOrder;
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::~WaitQueue
+// 	Forget about the threads still in the queue; they are not ours to
+//	delete.
+//----------------------------------------------------------------------
+
+WaitQueue::~WaitQueue() {
+  while (!IsEmpty())
+    Remove();
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::InsertBefore
+// 	Link "thread" in front of "next", or at the end of the queue if
+//	"next" is NULL.
+//----------------------------------------------------------------------
+
+void WaitQueue::InsertBefore(Thread *thread, Thread *next) {
+  ASSERT(thread->waitQueue == NULL); // on one queue at a time
+
+  thread->waitQueue = this;
+  thread->waitNext = next;
+  thread->waitPrev = (next != NULL) ? next->waitPrev : last;
+  if (thread->waitPrev != NULL)
+    thread->waitPrev->waitNext = thread;
+  else
+    first = thread;
+  if (next != NULL)
+    next->waitPrev = thread;
+  else
+    last = thread;
+  length++;
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::Append
+// 	Put "thread" in the queue.  In a FIFO queue it goes at the end;
+//	in a priority queue, after every thread with the same or higher
+//	priority.
+//----------------------------------------------------------------------
+
+void WaitQueue::Append(Thread *thread) {
+  Thread *next = NULL;
+
+  if (order == PRIORITY_ORDER) {
+    int priority = thread->getPriority();
+    // threads tend to have the same priority, so look from the end
+    Thread *prev = last;
+    while (prev != NULL && prev->getPriority() < priority)
+      prev = prev->waitPrev;
+    next = (prev != NULL) ? prev->waitNext : first;
+  }
+  InsertBefore(thread, next);
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::SortedInsert
+// 	Put "thread" in the queue, ordered by increasing "key"; threads
+//	with equal keys stay in FIFO order.
+//----------------------------------------------------------------------
+
+void WaitQueue::SortedInsert(Thread *thread, int key) {
+  Thread *prev = last;
+
+  while (prev != NULL && prev->waitKey > key)
+    prev = prev->waitPrev;
+  thread->waitKey = key;
+  InsertBefore(thread, (prev != NULL) ? prev->waitNext : first);
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::FirstKey
+// 	Return the key of the first thread.  The queue must not be empty.
+//----------------------------------------------------------------------
+
+int WaitQueue::FirstKey() {
+  ASSERT(first != NULL);
+  return first->waitKey;
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::RemoveThread
+// 	Take "thread" out of the queue, wherever it is.  Returns false if
+//	the thread was not in this queue.
+//----------------------------------------------------------------------
+
+bool WaitQueue::RemoveThread(Thread *thread) {
+  if (thread->waitQueue != this)
+    return false;
+
+  if (thread->waitPrev != NULL)
+    thread->waitPrev->waitNext = thread->waitNext;
+  else
+    first = thread->waitNext;
+  if (thread->waitNext != NULL)
+    thread->waitNext->waitPrev = thread->waitPrev;
+  else
+    last = thread->waitPrev;
+  thread->waitNext = thread->waitPrev = NULL;
+  thread->waitQueue = NULL;
+  length--;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::Requeue
+// 	The priority of "thread", which is in this queue, changed; move it
+//	to its new place.  Nothing to do unless the queue is by priority.
+//----------------------------------------------------------------------
+
+void WaitQueue::Requeue(Thread *thread) {
+  ASSERT(thread->waitQueue == this);
+  if (order == PRIORITY_ORDER) {
+    RemoveThread(thread);
+    Append(thread);
+  }
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::Remove
+// 	Take the first thread out of the queue.  Returns NULL if the queue
+//	is empty.
+//----------------------------------------------------------------------
+
+Thread *WaitQueue::Remove() {
+  Thread *thread = first;
+
+  if (thread != NULL)
+    RemoveThread(thread);
+  return thread;
+}
+
+//----------------------------------------------------------------------
+// WaitQueue::Apply
+// 	Call "func" on every thread in the queue, in order.
+//----------------------------------------------------------------------
+
+void WaitQueue::Apply(void (*func)(Thread *)) {
+  for (Thread *t = first; t != NULL; t = t->waitNext)
+    func(t);
+}
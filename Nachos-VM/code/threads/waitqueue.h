@@ -0,0 +1,57 @@
+// waitqueue.h
+//	Data structures for queues of threads.
+//
+//	A thread can only be waiting in one place at a time: on the ready
+//	list, on a semaphore, on a condition variable, or sleeping on the
+//	alarm clock.  So, instead of allocating a list element every time a
+//	thread blocks, the links are kept inside the Thread itself, and
+//	putting a thread on a queue (or taking it off) never allocates.
+//
+//	Threads can be kept in FIFO order, or by priority (highest first,
+//	FIFO among threads with the same priority).  SortedInsert keeps
+//	the queue ordered by an arbitrary key instead (lowest first), for
+//	queues such as the alarm's, sorted by wake up time.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef WAITQUEUE_H
+#define WAITQUEUE_H
+
+#include "copyright.h"
+#include "thread.h"
+
+// Order in which threads leave a queue
+enum QueueOrder { FIFO_ORDER, PRIORITY_ORDER };
+
+class WaitQueue {
+public:
+  WaitQueue(QueueOrder queueOrder = FIFO_ORDER); // empty queue
+  ~WaitQueue();                                  // forgets any threads left
+
+  void Append(Thread *thread);   // add, according to the queue order
+  Thread *Remove();              // take the first one, NULL if empty
+  Thread *Front() { return first; } // first one, without removing it
+  bool RemoveThread(Thread *thread); // take it out from anywhere
+  void Requeue(Thread *thread); // its priority changed, move it
+
+  void SortedInsert(Thread *thread, int key); // by increasing "key"
+  int FirstKey();                             // key of the first thread
+
+  bool IsEmpty() { return first == NULL; }
+  int Length() { return length; }
+  void Apply(void (*func)(Thread *)); // call "func" on every thread
+
+  QueueOrder getOrder() { return order; }
+
+private:
+  Thread *first; // head of the queue, NULL if empty
+  Thread *last;  // tail of the queue
+  int length;
+  QueueOrder order;
+
+  void InsertBefore(Thread *thread, Thread *next); // NULL: at the end
+};
+
+#endif // WAITQUEUE_H
@@ -19,89 +19,48 @@
 #include "bitmap.h"
 #include "copyright.h"
 #include "machine.h"
-#include "noff.h"
 #include "system.h"
 #include "utility.h"
 
-//----------------------------------------------------------------------
-// SwapHeader
-// 	Do little endian to big endian conversion on the bytes in the
-//	object file header, in case the file was generated on a little
-//	endian machine, and we're now running on a big endian machine.
-//----------------------------------------------------------------------
-
-static void SwapHeader(NoffHeader *noffH) {
-  noffH->noffMagic = WordToHost(noffH->noffMagic);
-  noffH->code.size = WordToHost(noffH->code.size);
-  noffH->code.virtualAddr = WordToHost(noffH->code.virtualAddr);
-  noffH->code.inFileAddr = WordToHost(noffH->code.inFileAddr);
-  noffH->initData.size = WordToHost(noffH->initData.size);
-  noffH->initData.virtualAddr = WordToHost(noffH->initData.virtualAddr);
-  noffH->initData.inFileAddr = WordToHost(noffH->initData.inFileAddr);
-  noffH->uninitData.size = WordToHost(noffH->uninitData.size);
-  noffH->uninitData.virtualAddr = WordToHost(noffH->uninitData.virtualAddr);
-  noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
-}
-
-void ReadPagesAtMachine(OpenFile *executable, int firstPage, int size,
-                        int startFileAddr, TranslationEntry *pageTable,
-                        int numPages) {
-  int page, sector, file_offset;
-  // char buff[SectorSize];
-
-  for (int i = firstPage; i < firstPage + numPages; i++) {
-    page = pageTable[i].physicalPage * PageSize;
-    sector = pageTable[i].swapSector * PageSize;
-    file_offset = startFileAddr + (i * PageSize);
-    // Lee de disco
-    // executable->ReadAt(buff, PageSize, file_offset);
+// Copia las paginas del programa a su marco (o a su sector en swap, con
+// VM): las que vienen del archivo desde la imagen, y las demas en cero
+static void CopyPagesToMachine(ExecImage *image, PageTable *pageTable) {
+  for (int i = 0; i < image->NumPages(); i++) {
+    TranslationEntry *entry = pageTable->Lookup(i);
 #ifndef VM
     // Escribe en marco
-    executable->ReadAt(&(machine->mainMemory[page]), PageSize, file_offset);
-    DEBUG('x', "En memoria %d [", pageTable[i].physicalPage);
-    for (int offset = 0; offset < SectorSize; offset++) {
-      DEBUG('x', "%x", machine->mainMemory[page + offset]);
-    }
-    DEBUG('x', "]\n");
+    char *page = &machine->mainMemory[entry->physicalPage * PageSize];
+    DEBUG('x', "En memoria %d [", entry->physicalPage);
 #else
-    executable->ReadAt(&(swapSpace[sector]), SectorSize, file_offset);
-    DEBUG('x', "En swap %d [", pageTable[i].swapSector);
+    char *page = &swapSpace[entry->swapSector * SectorSize];
+    DEBUG('x', "En swap %d [", entry->swapSector);
+#endif
+    if (i < image->numFilePages)
+      memcpy(page, &image->contents[i * PageSize], PageSize);
+    else
+      memset(page, 0, PageSize);
     for (int offset = 0; offset < SectorSize; offset++) {
-      DEBUG('x', "%x", swapSpace[sector + offset]);
+      DEBUG('x', "%x", page[offset]);
     }
     DEBUG('x', "]\n");
-#endif
   }
-  stats->numDiskWrites += numPages;
+  stats->numDiskWrites += image->numCodePages + image->numDataPages;
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
-//	Load the program from a file "executable", and set everything
-//	up so that we can start executing user instructions.
-//
-//	Assumes that the object code file is in NOFF format.
+//	Load the program from its "image" (see ExecCache), and set
+//	everything up so that we can start executing user instructions.
 //
 //	First, set up the translation from program memory to physical
-//	memory.  For now, this is really simple (1:1), since we are
-//	only uniprogramming, and we have a single unsegmented page table
+//	memory: code and data at the bottom of the address space, where
+//	the heap begins, and the stack at the top.
 //
-//	"executable" is the file containing the object code to load into memory
+//	"image" is the program, already read from its file
 //----------------------------------------------------------------------
-AddrSpace::AddrSpace(OpenFile *executable) {
-  NoffHeader noffH;
-  unsigned int i, size;
-
-  // NOTE: Lee el archivo desde el inicio del disco (0)
-  executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-
-  // NOTE: pasa los headers a big endian de ser necesario
-  if ((noffH.noffMagic != NOFFMAGIC) &&
-      (WordToHost(noffH.noffMagic) == NOFFMAGIC)) {
-    SwapHeader(&noffH);
-  }
-  ASSERT(noffH.noffMagic == NOFFMAGIC);
+AddrSpace::AddrSpace(ExecImage *image) {
+  int i, numPages, size;
 
   // how big is address space?
   // we need to increase the size to leave room for the stack
@@ -112,11 +71,11 @@ AddrSpace::AddrSpace(OpenFile *executable) {
 
   // NOTE: tamaño de página de 128 bytes (Sectorsize)
   // INFO: nueva forma de generar las páginas logicas
-  int numCodePages = divRoundUp(noffH.code.size, PageSize);
-  int numDataPages = divRoundUp(noffH.initData.size, PageSize);
-  int numUninitDataPages = divRoundUp(noffH.uninitData.size, PageSize);
   int numStackPages = divRoundUp(UserStackSize, PageSize);
-  numPages = numCodePages + numDataPages + numUninitDataPages + numStackPages;
+  int numImagePages = image->NumPages();
+  numPages = numImagePages + numStackPages;
+  // INFO: el programa no puede pisar el lugar del stack
+  ASSERT(numImagePages <= NumVirtPages - MaxStackSize / PageSize);
 #ifndef VM
   // check we're not trying to run anything too big -- at least until we have
   // virtual memory
@@ -128,50 +87,40 @@ AddrSpace::AddrSpace(OpenFile *executable) {
         size);
 
   // first, set up the translation
-  this->pageTable = new TranslationEntry[numPages];
+  this->pageTable = new PageTable();
+  this->heapStart = this->brk = numImagePages * PageSize;
+  this->stackBottom = NumVirtPages - numStackPages;
+  for (i = 0; i < MaxAttachedSegments; i++)
+    this->attached[i] = NULL;
+  for (i = 0; i < MaxMappedFiles; i++)
+    this->mapped[i] = NULL;
 
   // WARN: ensuciando páginas
   // for (int pagina = 0; pagina <= 10; pagina+=2) {
   //   MapitaBits->Mark(pagina);
   // }
 
-  for (i = 0; i < numPages; i++) {
-    this->pageTable[i].virtualPage = i;
-#ifndef VM
-    this->pageTable[i].swapSector = -1;
-    this->pageTable[i].physicalPage = MapitaBits->SecureFind();
-    this->pageTable[i].valid = true;
-#else
-    this->pageTable[i].swapSector = swapSectors->SecureFind();
-    this->pageTable[i].physicalPage = -1;
-    // NOTE: VM siempre inicia como falsa
-    this->pageTable[i].valid = false;
-#endif
-    // if the code segment was entirely on
-    // a separate page, we could set its
-    // pages to be read-only
-    this->pageTable[i].readOnly = false;
-    this->pageTable[i].use = false;
-    this->pageTable[i].dirty = false;
-  }
+  // NOTE: VM siempre inicia como falsa, con su sector en swap
+  // if the code segment was entirely on
+  // a separate page, we could set its
+  // pages to be read-only
+  bool ok = true;
+  for (i = 0; i < numImagePages; i++)
+    ok = ok && NewPage(i, false);
+  for (i = this->stackBottom; i < NumVirtPages; i++)
+    ok = ok && NewPage(i, false);
+  ASSERT(ok); // sin marcos (o sectores de swap) para el programa
 
   // zero out the entire address space, to zero the unitialized data segment and
   // the stack segment
   // bzero(machine->mainMemory, size);
 
   // then, copy in the code and data segments into memory
-  if (noffH.code.size > 0) {
-    ReadPagesAtMachine(executable, 0, noffH.code.size, noffH.code.inFileAddr,
-                       this->pageTable, numCodePages);
-  }
-  if (noffH.initData.size > 0) {
-    ReadPagesAtMachine(executable, numCodePages, noffH.initData.size,
-                       noffH.initData.inFileAddr, this->pageTable,
-                       numDataPages);
-  }
-  for (i = 0; i < numPages; i++) {
-    DEBUG('g', "[NEW] VPAG: %d, PAG: %d SEC: %d\n", pageTable[i].virtualPage,
-          pageTable[i].physicalPage, pageTable[i].swapSector);
+  CopyPagesToMachine(image, this->pageTable);
+  for (i = NextPage(0); i != -1; i = NextPage(i + 1)) {
+    TranslationEntry *entry = pageTable->Lookup(i);
+    DEBUG('g', "[NEW] VPAG: %d, PAG: %d SEC: %d\n", entry->virtualPage,
+          entry->physicalPage, entry->swapSector);
     // #ifdef VM
     //     DEBUG('g', "Escrito a swap [%d]", i);
     //     for (int offset = 0; offset < SectorSize; offset++) {
@@ -188,95 +137,26 @@ AddrSpace::AddrSpace(OpenFile *executable) {
     // #endif
   }
 }
-// Crea una copia de los segmentos compartidos y crea un nuevo stack
-AddrSpace::AddrSpace(const AddrSpace &source) : numPages(source.numPages) {
-  // Calcula el tamño del stack
-  int numStackPages = divRoundUp(UserStackSize, PageSize);
-  this->numPages += numStackPages;
-
-// check we're not trying to run anything too big -- at least until we have
-// virtual memory
-#ifndef VM
-  ASSERT(numPages <= NumPhysPages);
-#endif
-  this->pageTable = new TranslationEntry[numPages];
-
-  memcpy(pageTable, source.pageTable,
-         sizeof(TranslationEntry) * source.numPages);
-
-  int i;
-  for (i = numPages - numStackPages; i < numPages; i++) {
-    this->pageTable[i].virtualPage = i;
-#ifndef VM
-    this->pageTable[i].swapSector = -1;
-    this->pageTable[i].physicalPage = MapitaBits->SecureFind();
-    this->pageTable[i].valid = true;
-#else
-    this->pageTable[i].swapSector = swapSectors->SecureFind();
-    this->pageTable[i].physicalPage = -1;
-    // NOTE: VM siempre inicia como falsa
-    this->pageTable[i].valid = false;
-#endif
-    this->pageTable[i].readOnly = false;
-    this->pageTable[i].use = false;
-    this->pageTable[i].dirty = false;
-  }
-
-#ifdef VM
-  for (i = numPages - numStackPages; i < numPages; i++) {
-    // NOTE: VM siempre inicia como falsa
-    this->pageTable[i].valid = false;
-  }
-#endif
-  DEBUG('1', "PT FOR %s:\n", currentThread->getName());
-  for (i = 0; i < currentThread->space->numPages; i++) {
-    TranslationEntry pt = *currentThread->space->EntryFromVirtPage(i);
-    DEBUG('1', "[%d] VP %d | PP %d | SWP %d | VAL %d | DTY %d : ", i,
-          pt.virtualPage, pt.physicalPage, pt.swapSector, pt.valid, pt.dirty);
-    if (pt.valid == true) {
-      for (int j = 0; j < 15; j++) {
-        DEBUG('1', "%x", machine->mainMemory[pt.physicalPage * PageSize + j]);
-      }
-    }
-    DEBUG('1', "\n");
-  }
-
-  for (i = 0; i < numPages; i++) {
-    DEBUG('g', "[CPY] VPAG: %d, PAG: %d SEC: %d\n", pageTable[i].virtualPage,
-          pageTable[i].physicalPage, pageTable[i].swapSector);
-    // #ifdef VM
-    //     DEBUG('g', "Escrito a swap [%d]", i);
-    //     for (int offset = 0; offset < SectorSize; offset++) {
-    //       DEBUG('g', "%x", swapSpace[pageTable[i].swapSector + offset]);
-    //     }
-    //     DEBUG('g', "]\n");
-    // #else
-    //     DEBUG('g', "Escrito a memoria [%d]", i);
-    //     for (int offset = 0; offset < SectorSize; offset++) {
-    //       DEBUG('g', "%x", machine->mainMemory[pageTable[i].physicalPage +
-    //       offset]);
-    //     }
-    //     DEBUG('g', "]\n");
-    // #endif
-  }
-}
-
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space: detach its shared segments, unmap its
+//	files, and free its own frames and swap sectors.  This is done by
+//	the last thread of the process (see NachOS_Exit), so the stacks of
+//	the other threads are freed here too.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace() {
+  for (int i = 0; i < MaxAttachedSegments; i++)
+    if (this->attached[i] != NULL)
+      Detach(this->attachedAt[i] * PageSize);
+  for (int i = 0; i < MaxMappedFiles; i++)
+    if (this->mapped[i] != NULL)
+      Munmap(this->mapped[i]->firstPage * PageSize);
+
   DEBUG('x', "Marcando memoria como libre\n");
   // Marca como libre el espacio de memoria que se ocupaba
-  for (int page = 0; page < numPages; page++) {
-    if (this->pageTable[page].valid) {
-      MapitaBits->SecureClear(this->pageTable[page].physicalPage);
-    }
-#ifdef VM
-    swapSectors->SecureClear(this->pageTable[page].swapSector);
-#endif
-  }
+  for (int page = NextPage(0); page != -1; page = NextPage(page + 1))
+    FreePage(page);
   DEBUG('y', "\t||| DELETING ADDRESS SPACE ... {%s}\n",
         currentThread->getName());
   delete this->pageTable;
@@ -308,8 +188,9 @@ void AddrSpace::InitRegisters() {
   // Set the stack register to the end of the address space, where we
   // allocated the stack; but subtract off a bit, to make sure we don't
   // accidentally reference off the end!
-  machine->WriteRegister(StackReg, numPages * PageSize - 16);
-  DEBUG('a', "Initializing stack register to %d\n", numPages * PageSize - 16);
+  machine->WriteRegister(StackReg, NumVirtPages * PageSize - 16);
+  DEBUG('a', "Initializing stack register to %d\n",
+        NumVirtPages * PageSize - 16);
 }
 
 //----------------------------------------------------------------------
@@ -317,11 +198,25 @@ void AddrSpace::InitRegisters() {
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, nothing!
+//	With a TLB, the pages written to through it are marked dirty in
+//	the page table, since RestoreState drops every entry; otherwise
+//	evicting one of them later would not copy it to swap.
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState() {
   DEBUG('1', "\t||| SAVING ... {%s}\n", currentThread->getName());
+#ifdef USE_TLB
+  for (int i = 0; i < TLBSize; i++) {
+    if (!machine->tlb[i].valid)
+      continue;
+    TranslationEntry *entry = pageTable->Lookup(machine->tlb[i].virtualPage);
+    if (entry != NULL && entry->valid &&
+        entry->physicalPage == machine->tlb[i].physicalPage) {
+      entry->dirty = entry->dirty || machine->tlb[i].dirty;
+      entry->use = entry->use || machine->tlb[i].use;
+    }
+  }
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -344,11 +239,13 @@ void AddrSpace::RestoreState() {
 
 #ifndef USE_TLB
   machine->pageTable = pageTable;
-  machine->pageTableSize = numPages;
 #else
 
   DEBUG('1', "\t||| RESTORE TLB -> NULL {%s}\n", currentThread->getName());
-  machine->tlb = new TranslationEntry[TLBSize];
+  // WARN: las entradas son del espacio anterior, se invalidan todas (un
+  // arreglo nuevo sin inicializar podia traer entradas "validas" viejas)
+  for (int i = 0; i < TLBSize; i++)
+    machine->tlb[i].valid = false;
   machine->nextTLB = 0;
 
   // DEBUG('o', " ____ESTADO SWAP____\n");
@@ -362,24 +259,410 @@ void AddrSpace::RestoreState() {
 }
 
 TranslationEntry *AddrSpace::EntryFromVirtPage(unsigned virtpage) {
-  if (virtpage < numPages) {
-    return &this->pageTable[virtpage];
-  }
-  return NULL;
+  return this->pageTable->Lookup(virtpage);
 }
 TranslationEntry *AddrSpace::EntryFromPhysPage(unsigned physpage) {
-  for (int vp = 0; vp < numPages; vp++) {
-    TranslationEntry entry = this->pageTable[vp];
-    if (entry.physicalPage == physpage && entry.valid) {
-      return &this->pageTable[vp];
+  for (int vp = NextPage(0); vp != -1; vp = NextPage(vp + 1)) {
+    TranslationEntry *entry = this->pageTable->Lookup(vp);
+    if (entry->physicalPage == physpage && entry->valid) {
+      return entry;
     }
   }
   return NULL;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::NewPage
+// 	Map "virtpage" to memory of its own: a frame, or with virtual
+//	memory a swap sector, from where it is loaded on its first
+//	fault.  If "zero", the page starts out filled with zeros.
+//	Returns false if there is no memory left.
+//----------------------------------------------------------------------
+
+bool AddrSpace::NewPage(int virtpage, bool zero) {
+  TranslationEntry *entry;
+
+#ifndef VM
+  int frame = MapitaBits->SecureFind();
+  if (frame == -1)
+    return false;
+  entry = this->pageTable->Map(virtpage);
+  entry->physicalPage = frame;
+  entry->valid = true;
+  coreMap->MapPrivate(frame, this, virtpage);
+  if (zero)
+    memset(&machine->mainMemory[frame * PageSize], 0, PageSize);
+#else
+  int sector = swapSectors->SecureFind();
+  if (sector == -1)
+    return false;
+  entry = this->pageTable->Map(virtpage);
+  entry->swapSector = sector;
+  if (zero)
+    memset(&swapSpace[sector * SectorSize], 0, SectorSize);
+#endif
+  return true;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreePage
+// 	Take "virtpage" out of the address space, and free its frame and
+//	swap sector.
+//----------------------------------------------------------------------
+
+void AddrSpace::FreePage(int virtpage) {
+  TranslationEntry *entry = this->pageTable->Lookup(virtpage);
+
+  if (entry == NULL)
+    return;
+#ifdef USE_TLB
+  if (currentThread->space == this) {
+    for (int i = 0; i < TLBSize; i++)
+      if (machine->tlb[i].virtualPage == virtpage)
+        machine->tlb[i].valid = false;
+  }
+#endif
+  if (entry->valid) {
+    coreMap->Release(entry->physicalPage);
+  }
+#ifdef VM
+  swapSectors->SecureClear(entry->swapSector);
+#endif
+  this->pageTable->Unmap(virtpage);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Sbrk
+// 	Move the end of the heap "increment" bytes, up or down.  The
+//	pages it grows into are mapped zeroed; the ones it leaves are
+//	freed.  The heap can not shrink below its start, nor grow into a
+//	shared segment or the room for the stack.
+//
+//	Returns the previous end of the heap, or -1 (and nothing changes)
+//	if it can not be moved.
+//----------------------------------------------------------------------
+
+int AddrSpace::Sbrk(int increment) {
+  int oldBrk = brk, newBrk = brk + increment;
+  int oldTop = divRoundUp(oldBrk, PageSize);
+  int vp;
+
+  if (newBrk < heapStart ||
+      newBrk > (NumVirtPages - MaxStackSize / PageSize) * PageSize)
+    return -1;
+  int newTop = divRoundUp(newBrk, PageSize);
+
+  for (vp = oldTop; vp < newTop; vp++) {
+    if (this->pageTable->Lookup(vp) != NULL || !NewPage(vp, true)) {
+      // INFO: se deshace lo que se alcanzo a mapear
+      while (--vp >= oldTop)
+        FreePage(vp);
+      return -1;
+    }
+  }
+  for (vp = newTop; vp < oldTop; vp++)
+    FreePage(vp);
+  brk = newBrk;
+  DEBUG('a', "Heap de {%s} hasta %d\n", currentThread->getName(), brk);
+  return oldBrk;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::HandleFault
+// 	The page of "virtAddr" is not in the page table.  If it is below
+//	the stack, but within MaxStackSize of the top of the address
+//	space, the stack grows down to it, with zeroed pages.
+//
+//	Without virtual memory, the only pages in the table that fault
+//	are the ones of mapped files: they are read now.
+//
+//	Returns true if the page is part of the address space now (it
+//	may also have been all along: with virtual memory, a page that is
+//	in the table faults until it is loaded).
+//----------------------------------------------------------------------
+
+bool AddrSpace::HandleFault(int virtAddr) {
+  int vpn = (unsigned)virtAddr / PageSize;
+  TranslationEntry *entry = this->pageTable->Lookup(vpn);
+
+  if (entry != NULL) {
+#ifndef VM
+    MappedFile *file;
+    int filePage;
+    if (!entry->valid && MappedPageOf(vpn, &file, &filePage)) {
+      int frame = MapitaBits->SecureFind();
+      if (frame == -1)
+        return false; // WARN: sin memoria virtual no hay a quien desalojar
+      LoadMappedPage(vpn, frame);
+    }
+#endif
+    return true;
+  }
+  if (vpn >= stackBottom || vpn < NumVirtPages - MaxStackSize / PageSize)
+    return false;
+
+  for (int vp = stackBottom - 1; vp >= vpn; vp--) {
+    if (!NewPage(vp, true))
+      return false;
+    stackBottom = vp;
+  }
+  DEBUG('a', "Stack de {%s} crece hasta la pagina %d\n",
+        currentThread->getName(), stackBottom);
+  return true;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindHole
+// 	Find the highest run of "numPages" free pages between the heap
+//	and the room for the stack.  Returns its first page, or -1 if
+//	there is none.
+//----------------------------------------------------------------------
+
+int AddrSpace::FindHole(int numPages) {
+  int hole = 0;
+  int heapTop = divRoundUp(brk, PageSize);
+
+  for (int vp = NumVirtPages - MaxStackSize / PageSize - 1; vp >= heapTop;
+       vp--) {
+    hole = (this->pageTable->Lookup(vp) != NULL) ? 0 : hole + 1;
+    if (hole == numPages)
+      return vp;
+  }
+  return -1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Attach
+// 	Map "segment" into the address space, in a hole between the heap
+//	and the stack.  Must be called with interrupts disabled (see
+//	SharedMemoryTable::Attach).
+//----------------------------------------------------------------------
+
+int AddrSpace::Attach(SharedSegment *segment) {
+  int slot, firstPage;
+
+  for (slot = 0; slot < MaxAttachedSegments; slot++)
+    if (attached[slot] == NULL)
+      break;
+  if (slot == MaxAttachedSegments)
+    return -1;
+
+  firstPage = FindHole(segment->numPages);
+  if (firstPage == -1)
+    return -1;
+
+  for (int page = 0; page < segment->numPages; page++)
+    this->pageTable->Map(firstPage + page);
+  attached[slot] = segment;
+  attachedAt[slot] = firstPage;
+  segment->Attach(this, firstPage);
+  DEBUG('a', "Segmento de %d paginas en la pagina %d de {%s}\n",
+        segment->numPages, firstPage, currentThread->getName());
+  return firstPage;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Detach
+// 	Remove the segment that starts at user address "addr", and take
+//	its pages out of the page table.
+//----------------------------------------------------------------------
+
+int AddrSpace::Detach(int addr) {
+  int slot;
+
+  for (slot = 0; slot < MaxAttachedSegments; slot++)
+    if (attached[slot] != NULL && attachedAt[slot] * PageSize == addr)
+      break;
+  if (slot == MaxAttachedSegments)
+    return -1;
+
+  SharedSegment *segment = attached[slot];
+  attached[slot] = NULL;
+#ifdef USE_TLB
+  // INFO: la TLB no debe seguir traduciendo las paginas que se van
+  if (currentThread->space == this) {
+    for (int i = 0; i < TLBSize; i++) {
+      int vp = machine->tlb[i].virtualPage;
+      if (vp >= attachedAt[slot] && vp < attachedAt[slot] + segment->numPages)
+        machine->tlb[i].valid = false;
+    }
+  }
+#endif
+  sharedMemory->Detach(segment, this);
+
+  for (int page = 0; page < segment->numPages; page++)
+    this->pageTable->Unmap(attachedAt[slot] + page);
+  return 0;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SharedPageOf
+// 	Find the attached segment that "virtpage" belongs to.
+//----------------------------------------------------------------------
+
+bool AddrSpace::SharedPageOf(int virtpage, SharedSegment **segment,
+                             int *page) {
+  for (int slot = 0; slot < MaxAttachedSegments; slot++) {
+    if (attached[slot] != NULL && virtpage >= attachedAt[slot] &&
+        virtpage < attachedAt[slot] + attached[slot]->numPages) {
+      *segment = attached[slot];
+      *page = virtpage - attachedAt[slot];
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Mmap
+// 	Map "length" bytes of "file", from "offset" on, in a hole between
+//	the heap and the stack.  The pages are not valid until they are
+//	read, on their first fault.
+//----------------------------------------------------------------------
+
+int AddrSpace::Mmap(NachosOpenFile *file, int offset, int length) {
+  int slot, firstPage;
+
+  for (slot = 0; slot < MaxMappedFiles; slot++)
+    if (mapped[slot] == NULL)
+      break;
+  if (slot == MaxMappedFiles)
+    return -1;
+
+  firstPage = FindHole(divRoundUp(length, PageSize));
+  if (firstPage == -1)
+    return -1;
+
+  mapped[slot] = new MappedFile(file, offset, length, firstPage);
+  for (int page = 0; page < mapped[slot]->numPages; page++)
+    this->pageTable->Map(firstPage + page);
+  DEBUG('a', "Archivo de %d paginas en la pagina %d de {%s}\n",
+        mapped[slot]->numPages, firstPage, currentThread->getName());
+  return firstPage;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Munmap
+// 	Remove the mapping that starts at user address "addr".  The pages
+//	the program wrote to are written back to the file first.
+//----------------------------------------------------------------------
+
+int AddrSpace::Munmap(int addr) {
+  int slot;
+
+  for (slot = 0; slot < MaxMappedFiles; slot++)
+    if (mapped[slot] != NULL && mapped[slot]->firstPage * PageSize == addr)
+      break;
+  if (slot == MaxMappedFiles)
+    return -1;
+
+  MappedFile *file = mapped[slot];
+  mapped[slot] = NULL;
+  for (int page = 0; page < file->numPages; page++) {
+    int vp = file->firstPage + page;
+    TranslationEntry *entry = this->pageTable->Lookup(vp);
+#ifdef USE_TLB
+    if (currentThread->space == this) {
+      for (int i = 0; i < TLBSize; i++) {
+        if (machine->tlb[i].valid && machine->tlb[i].virtualPage == vp) {
+          entry->dirty = entry->dirty || machine->tlb[i].dirty;
+          machine->tlb[i].valid = false;
+        }
+      }
+    }
+#endif
+    if (entry->valid) {
+      if (entry->dirty)
+        file->WriteBack(page, entry->physicalPage);
+      coreMap->Release(entry->physicalPage);
+    }
+    this->pageTable->Unmap(vp);
+  }
+  delete file;
+  return 0;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MappedPageOf
+// 	Find the mapped file that "virtpage" belongs to.
+//----------------------------------------------------------------------
+
+bool AddrSpace::MappedPageOf(int virtpage, MappedFile **file,
+                             int *page) const {
+  for (int slot = 0; slot < MaxMappedFiles; slot++) {
+    if (mapped[slot] != NULL && virtpage >= mapped[slot]->firstPage &&
+        virtpage < mapped[slot]->firstPage + mapped[slot]->numPages) {
+      *file = mapped[slot];
+      *page = virtpage - mapped[slot]->firstPage;
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadMappedPage
+// 	Read "virtpage", a page of a mapped file, into "frame", and make
+//	it valid.  The core map keeps track of it as a private page; its
+//	eviction writes it back to the file (see CoreMap::Evict).
+//----------------------------------------------------------------------
+
+void AddrSpace::LoadMappedPage(int virtpage, int frame) {
+  MappedFile *file;
+  int page;
+
+  bool found = MappedPageOf(virtpage, &file, &page);
+  ASSERT(found);
+  file->Load(page, frame);
+  TranslationEntry *entry = this->pageTable->Lookup(virtpage);
+  entry->physicalPage = frame;
+  entry->valid = true;
+  entry->use = false;
+  entry->dirty = false;
+  coreMap->MapPrivate(frame, this, virtpage);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::NewThreadStack
+// 	Map a stack for a thread started with Fork, zeroed, in the
+//	highest hole below the room for the main stack.  Returns the
+//	initial stack pointer, or -1 if there is no room or memory for it.
+//----------------------------------------------------------------------
+
+int AddrSpace::NewThreadStack() {
+  int numPages = divRoundUp(UserStackSize, PageSize);
+  int firstPage = FindHole(numPages);
+
+  if (firstPage == -1)
+    return -1;
+  for (int page = 0; page < numPages; page++) {
+    if (!NewPage(firstPage + page, true)) {
+      while (--page >= 0)
+        FreePage(firstPage + page);
+      return -1;
+    }
+  }
+  DEBUG('a', "Stack de un hilo en la pagina %d de {%s}\n", firstPage,
+        currentThread->getName());
+  return (firstPage + numPages) * PageSize - 16;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreeThreadStack
+// 	Unmap the stack that NewThreadStack gave "stackPointer" to.
+//----------------------------------------------------------------------
+
+void AddrSpace::FreeThreadStack(int stackPointer) {
+  int numPages = divRoundUp(UserStackSize, PageSize);
+  int firstPage = (stackPointer + 16) / PageSize - numPages;
+
+  for (int page = 0; page < numPages; page++)
+    FreePage(firstPage + page);
+}
+
 void AddrSpace::printPT() {
-  for (int vp = 0; vp < numPages; vp++) {
-    TranslationEntry e = this->pageTable[vp];
+  for (int vp = NextPage(0); vp != -1; vp = NextPage(vp + 1)) {
+    TranslationEntry e = *this->pageTable->Lookup(vp);
     printf("[%d] VALID: %d DIRTY: %d |VP %d|PP %d|SE %d|\n", vp, e.valid,
            e.dirty, e.virtualPage, e.physicalPage, e.swapSector);
   }
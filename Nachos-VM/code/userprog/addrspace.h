@@ -14,20 +14,26 @@
 #define ADDRSPACE_H
 
 #include "copyright.h"
+#include "execcache.h"
 #include "filesys.h"
+#include "mappedfile.h"
+#include "sharedmem.h"
 #include "translate.h"
 
+// The stack starts with UserStackSize bytes at the top of the virtual
+// address space, and grows down on faults up to MaxStackSize.  The heap
+// starts right after the uninitialized data, and grows up with Sbrk.
+// Shared segments, mapped files and the stacks of the threads started
+// with Fork go in between, just below the room for the stack.
 #define UserStackSize 1024 // increase this as necessary!
+#define MaxStackSize 8192
 
 class AddrSpace {
 public:
   // Create an address space,
   // initializing it with the program
-  // stored in the file "executable"
-  AddrSpace(OpenFile *executable);
-
-  // INFO: copy data for some AddrSpace but creates a new stack
-  AddrSpace(const AddrSpace &source);
+  // of "image" (see ExecCache)
+  AddrSpace(ExecImage *image);
 
   // De-allocate an address space
   ~AddrSpace();
@@ -41,18 +47,69 @@ public:
   // info on a context switch
   void RestoreState();
 
-  // Devuelve la pagina con sus meta datos
+  // Devuelve la pagina con sus meta datos, NULL si no es parte del espacio
   TranslationEntry *EntryFromVirtPage(unsigned virtpage);
   TranslationEntry *EntryFromPhysPage(unsigned physpage);
+  // First page of the address space from "virtpage" on, -1 if none
+  int NextPage(unsigned virtpage) { return pageTable->NextMapped(virtpage); }
   void printPT();
 
-  // Number of pages in the virtual
-  // address space
-  unsigned int numPages;
+  // Move the end of the heap "increment" bytes, and return where it
+  // was (-1 if there is no room or no memory for it).  New pages are
+  // zeroed.
+  int Sbrk(int increment);
+
+  // A fault on a page that is not in the page table: grow the stack if
+  // the page is below it, within MaxStackSize.  Returns false if
+  // "virtAddr" is not part of the address space.
+  bool HandleFault(int virtAddr);
+
+  // Shared memory: map "segment" at the highest free range of pages
+  // big enough between the heap and the stack, and return its first
+  // page (-1 if there is none, or too many segments are attached).
+  // Detach removes the segment that starts at "addr" (-1 if none does).
+  int Attach(SharedSegment *segment);
+  int Detach(int addr);
+
+  // Is "virtpage" in an attached segment?  Which one, and which page
+  bool SharedPageOf(int virtpage, SharedSegment **segment, int *page);
+
+  // Mapped files: map "length" bytes of "file" from "offset" on, the
+  // same way as a shared segment, and return the first page (-1 if
+  // there is no room).  Munmap writes back what the program changed,
+  // and removes the mapping that starts at "addr" (-1 if none does).
+  int Mmap(NachosOpenFile *file, int offset, int length);
+  int Munmap(int addr);
+
+  // Is "virtpage" in a mapped file?  Which one, and which page
+  bool MappedPageOf(int virtpage, MappedFile **file, int *page) const;
+  // Read "virtpage" of a mapped file into "frame", and map it there
+  void LoadMappedPage(int virtpage, int frame);
+
+  // The threads started with Fork share the address space of their
+  // process, but each one gets a stack of UserStackSize bytes of its
+  // own, in a hole between the heap and the stack.  NewThreadStack
+  // returns its initial stack pointer (-1 if there is no room), and
+  // FreeThreadStack unmaps it when the thread exits.
+  int NewThreadStack();
+  void FreeThreadStack(int stackPointer);
 
 private:
-  // Assume linear page table translation for now!
-  TranslationEntry *pageTable;
+  PageTable *pageTable; // only the pages in use are mapped
+
+  int heapStart;   // user address where the heap begins
+  int brk;         // end of the heap, moved by Sbrk
+  int stackBottom; // lowest page of the stack
+
+  SharedSegment *attached[MaxAttachedSegments]; // NULL if free
+  int attachedAt[MaxAttachedSegments];          // first page of each
+
+  MappedFile *mapped[MaxMappedFiles]; // NULL if free
+
+  int FindHole(int numPages); // free run of pages for a segment or file
+  bool NewPage(int virtpage, bool zero); // map a private page, false if
+                                         // out of memory
+  void FreePage(int virtpage);           // unmap it, and free its memory
 };
 
 #endif // ADDRSPACE_H
@@ -0,0 +1,65 @@
+// consolewriter.cc
+//	Routines to buffer the console output of user programs.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "consolewriter.h"
+#include "copyright.h"
+#include "system.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------------
+// ConsoleWriter::ConsoleWriter
+// 	Initialize an empty buffer for the host stream "outStream".
+//----------------------------------------------------------------------
+
+ConsoleWriter::ConsoleWriter(FILE *outStream) {
+  out = outStream;
+  used = 0;
+}
+
+ConsoleWriter::~ConsoleWriter() { Flush(); }
+
+//----------------------------------------------------------------------
+// ConsoleWriter::Append
+// 	Add "size" bytes of output.  They are written out right away if
+//	they include a newline, or when the buffer fills up; output larger
+//	than the whole buffer goes straight to the host.
+//----------------------------------------------------------------------
+
+void ConsoleWriter::Append(const char *data, int size) {
+  if (size <= 0)
+    return;
+  stats->numConsoleBytesBuffered += size;
+
+  if (used + size > ConsoleBufferSize) {
+    Flush();
+    if (size > ConsoleBufferSize) {
+      fwrite(data, 1, size, out);
+      fflush(out);
+      stats->numConsoleFlushes++;
+      return;
+    }
+  }
+  memcpy(buffer + used, data, size);
+  used += size;
+  if (memchr(data, '\n', size) != NULL)
+    Flush();
+}
+
+//----------------------------------------------------------------------
+// ConsoleWriter::Flush
+// 	Hand everything buffered to the host, in a single write.
+//----------------------------------------------------------------------
+
+void ConsoleWriter::Flush() {
+  if (used == 0)
+    return;
+  fwrite(buffer, 1, used, out);
+  fflush(out);
+  used = 0;
+  stats->numConsoleFlushes++;
+}
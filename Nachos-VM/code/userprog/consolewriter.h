@@ -0,0 +1,48 @@
+// consolewriter.h
+//	Data structures for buffering what user programs write to the
+//	console.
+//
+//	Writing each user Write straight to the host costs a host system
+//	call per Write, and most of them are a few characters long.  The
+//	console writer collects the output in a buffer instead, and hands
+//	it to the host:
+//
+//		when a newline goes through, like a terminal would;
+//		when the buffer fills up;
+//		when the timer goes off, or the machine goes idle, so that
+//		  output without a newline (a prompt) does not stay behind;
+//		before reading from the console, and at Halt.
+//
+//	Output can be appended from anywhere in memory, a span at a time,
+//	so that the system call handlers can feed it the pieces of a user
+//	buffer straight from the simulated physical memory (see
+//	ForEachUserSpan), without copying the buffer first.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef CONSOLEWRITER_H
+#define CONSOLEWRITER_H
+
+#include "copyright.h"
+#include <cstdio>
+
+// Bytes kept before writing them to the host
+const int ConsoleBufferSize = 1024;
+
+class ConsoleWriter {
+public:
+  ConsoleWriter(FILE *out); // buffer output to "out"
+  ~ConsoleWriter();         // flush what is left
+
+  void Append(const char *data, int size); // buffer some output
+  void Flush();                            // write out what is buffered
+
+private:
+  FILE *out;
+  char buffer[ConsoleBufferSize];
+  int used; // bytes in "buffer"
+};
+
+#endif // CONSOLEWRITER_H
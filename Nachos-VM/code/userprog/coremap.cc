@@ -0,0 +1,122 @@
+// coremap.cc
+//	Routines to keep track of the page frames of the physical memory.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "coremap.h"
+#include "addrspace.h"
+#include "copyright.h"
+#include "sharedmem.h"
+#include "system.h"
+#include <cstring>
+
+//----------------------------------------------------------------------
+// CoreMap::CoreMap
+// 	Initialize the core map, with nothing in any frame.
+//----------------------------------------------------------------------
+
+CoreMap::CoreMap() {
+  for (int frame = 0; frame < NumPhysPages; frame++)
+    Empty(frame);
+}
+
+void CoreMap::Empty(int frame) {
+  entries[frame].space = NULL;
+  entries[frame].virtualPage = -1;
+  entries[frame].segment = NULL;
+  entries[frame].segmentPage = -1;
+  entries[frame].refs = 0;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::MapPrivate, MapShared
+// 	Record what was just loaded into "frame".
+//----------------------------------------------------------------------
+
+void CoreMap::MapPrivate(int frame, AddrSpace *space, int virtualPage) {
+  Empty(frame);
+  entries[frame].space = space;
+  entries[frame].virtualPage = virtualPage;
+  entries[frame].refs = 1;
+}
+
+void CoreMap::MapShared(int frame, SharedSegment *segment, int page,
+                        int refs) {
+  Empty(frame);
+  entries[frame].segment = segment;
+  entries[frame].segmentPage = page;
+  entries[frame].refs = refs;
+}
+
+void CoreMap::AddRef(int frame) { entries[frame].refs++; }
+
+//----------------------------------------------------------------------
+// CoreMap::Release
+// 	A page table no longer maps "frame".  The last one frees it.
+//----------------------------------------------------------------------
+
+void CoreMap::Release(int frame) {
+  if (entries[frame].refs > 1) {
+    entries[frame].refs--;
+    return;
+  }
+  Empty(frame);
+  MapitaBits->SecureClear(frame);
+}
+
+#ifdef VM
+//----------------------------------------------------------------------
+// CoreMap::Evict
+// 	Invalidate every mapping of "frame": the page table of its
+//	address space, or of every address space attached to its
+//	segment, and the TLB.  If any of them wrote to the page, copy it
+//	to its swap sector, or to its file if it is of a mapped file.
+//----------------------------------------------------------------------
+
+void CoreMap::Evict(int frame) {
+  CoreMapEntry *entry = &entries[frame];
+  bool dirty = false;
+  int sector;
+
+  for (int i = 0; i < TLBSize; i++) {
+    if (machine->tlb[i].valid && machine->tlb[i].physicalPage == frame) {
+      dirty = dirty || machine->tlb[i].dirty;
+      machine->tlb[i].valid = false;
+      machine->tlb[i].physicalPage = -1;
+    }
+  }
+
+  if (entry->segment != NULL) {
+    sector = entry->segment->SectorOf(entry->segmentPage);
+    dirty = entry->segment->Unload(entry->segmentPage) || dirty;
+  } else if (entry->space != NULL) {
+    TranslationEntry *page =
+        entry->space->EntryFromVirtPage(entry->virtualPage);
+    MappedFile *file;
+    int filePage;
+    sector = page->swapSector;
+    dirty = page->dirty || dirty;
+    page->valid = false;
+    page->physicalPage = -1;
+    page->dirty = false;
+    if (entry->space->MappedPageOf(entry->virtualPage, &file, &filePage)) {
+      // INFO: la pagina de un archivo mapeado vuelve al archivo, no al swap
+      if (dirty)
+        file->WriteBack(filePage, frame);
+      Empty(frame);
+      return;
+    }
+  } else {
+    return; // no era de nadie
+  }
+
+  DEBUG('4', "\t-- MEM[%d] -> SWAP [%d]%s\n", frame, sector,
+        dirty ? "" : " (limpia)");
+  if (dirty)
+    memcpy(&swapSpace[sector * SectorSize],
+           &machine->mainMemory[frame * PageSize], PageSize);
+  Empty(frame);
+}
+#endif
@@ -0,0 +1,65 @@
+// coremap.h
+//	Data structures to keep track of what is in each page frame of
+//	the physical memory.
+//
+//	A frame holds either a private page of an address space, or a
+//	page of a shared memory segment (see sharedmem.h).  The core map
+//	counts the page tables that map each frame: one for a private
+//	page, one per attached address space for a shared page.  The
+//	frame is only freed when the last of them lets go of it.
+//
+//	With virtual memory, the core map is also how a frame is taken
+//	away from whoever uses it, even if it is not the current thread:
+//	every page table that maps it is invalidated, and the page goes
+//	back to its swap sector if any of them dirtied it.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COREMAP_H
+#define COREMAP_H
+
+#include "copyright.h"
+#include "machine.h"
+
+class AddrSpace;
+class SharedSegment;
+
+// What one frame holds
+struct CoreMapEntry {
+  AddrSpace *space;       // private page: its address space ...
+  int virtualPage;        // ... and its page there
+  SharedSegment *segment; // shared page: its segment ...
+  int segmentPage;        // ... and its page there
+  int refs;               // page tables that map the frame
+};
+
+class CoreMap {
+public:
+  CoreMap(); // every frame empty
+
+  // "frame" holds "virtualPage" of "space", mapped once
+  void MapPrivate(int frame, AddrSpace *space, int virtualPage);
+
+  // "frame" holds "page" of "segment", mapped by "refs" page tables
+  void MapShared(int frame, SharedSegment *segment, int page, int refs);
+
+  void AddRef(int frame);  // one more page table maps it
+  void Release(int frame); // one less; free the frame after the last
+
+  CoreMapEntry *Entry(int frame) { return &entries[frame]; }
+
+#ifdef VM
+  // Take "frame" away from the page tables that map it, saving its
+  // page to swap if needed.  The frame stays allocated, for the caller.
+  void Evict(int frame);
+#endif
+
+private:
+  CoreMapEntry entries[NumPhysPages];
+
+  void Empty(int frame);
+};
+
+#endif // COREMAP_H
@@ -22,8 +22,13 @@
 // of liability and disclaimer of warranty provisions.
 
 #include "copyright.h"
+#include "ioring.h"
+#include "pipe.h"
 #include "syscall.h"
+#include "syscalltable.h"
 #include "system.h"
+#include "usermem.h"
+#include "usersync.h"
 #include <cstring>
 
 void returnFromSystemCall() {
@@ -35,26 +40,17 @@ void returnFromSystemCall() {
                                         4); // NextPC <- NextPC + 4
 } // returnFromSystemCall
 
-// Lee 'size' bytes desde la memoria en la direccion 'address'
-const char *NachosReadMem(const char *buff, int size, int address) {
-  const char *buffer = new char[size];
-  for (int i = 0; i < size; i++) {
-    if (!machine->ReadMem(address + i, 1, (int *)&buffer[i], "ReadMem")) {
-      return NULL;
-    }
-    if (buffer[i] == '\0') {
-      DEBUG('u', "End of string before size %d\n", size);
-      break;
-    }
-  }
-  return buffer;
-}
-
 /*
  *  System call interface: Halt()
  */
 void NachOS_Halt() { // System call 0
 
+  consoleWriter->Flush();
+  if (synchConsole != NULL)
+    synchConsole->Drain(); // que se vea todo lo que se escribio
+#ifdef FILESYS
+  bufferCache->Sync(); // INFO: Nachos se detiene sin esperar al flusher
+#endif
   printf("Shutdown, initiated by user program.\n");
   // DEBUG('a', "Shutdown, initiated by user program.\n");
   interrupt->Halt();
@@ -65,8 +61,15 @@ void NachOS_Halt() { // System call 0
  */
 void NachOS_Exit() { // System call 1
   int status = machine->ReadRegister(4);
-  runningThreads->Clear(currentThread->id);
-  delete currentThread->space;
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  AddrSpace *space = currentThread->space;
+  // INFO: el espacio es de todo el proceso, lo libera su ultimo hilo antes
+  // de Finish; los de Fork solo devuelven su stack
+  currentThread->space = NULL;
+  if (currentThread->userStack != 0)
+    space->FreeThreadStack(currentThread->userStack);
+  if (pcb == NULL || processTable->Exit(pcb, status))
+    delete space;
   currentThread->Finish();
   if (status == 0) {
     printf("\nExiting successfully the user program.\n");
@@ -79,16 +82,22 @@ void NachOS_Exit() { // System call 1
 void NachosExecThread(void *fn) {
   DEBUG('u', "current thread id = %d", currentThread->id);
   char *filename = (char *)fn;
-  OpenFile *executable = fileSystem->Open(filename);
+  // INFO: si el programa ya corrio, no se abre ni se lee otra vez
+  ExecImage *image = execCache->Get(filename);
+  delete[] filename;
   AddrSpace *space;
-  if (executable == NULL) {
-    DEBUG('u', "Unable to open file %s\n", filename);
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  if (image == NULL) {
+    DEBUG('u', "Unable to open the executable\n");
+    // WARN: el proceso termina sin llegar a correr, Join devuelve -1
+    processTable->Exit(pcb, -1);
     return;
   }
-  DEBUG('u', "Enable to open file %s\n", filename);
-  space = new AddrSpace(executable);
+  DEBUG('u', "Able to open the executable\n");
+  space = new AddrSpace(image);
   currentThread->space = space;
-  delete executable; // close file
+  pcb->space = space;
+  execCache->Release(image);
 
   space->InitRegisters(); // set the initial register values
   space->RestoreState();  // load page table register
@@ -104,18 +113,30 @@ void NachosExecThread(void *fn) {
  */
 void NachOS_Exec() { // System call 2
   DEBUG('u', "Start executing...\n");
-  Thread *newT = new Thread("User EXEC Thread");
-  newT->id = runningThreads->SecureFind();
-  DEBUG('u', "Running thread %d\n", currentThread->id);
-  machine->WriteRegister(2, newT->id);
-  const char *filename = NachosReadMem(filename, 100, machine->ReadRegister(4));
-  if (filename != NULL) {
+  char *filename = new char[MaxUserString];
+  if (CopyStringFromUser(machine->ReadRegister(4), filename, MaxUserString) >=
+      0) {
+    Thread *newT = new Thread("User EXEC Thread");
+    PCB *pcb =
+        processTable->Create(newT, processTable->Lookup(currentThread->id));
+    if (pcb == NULL) {
+      // INFO: la tabla de procesos esta llena
+      DEBUG('u', "No hay espacio en la tabla de procesos\n");
+      delete newT;
+      delete[] filename;
+      machine->WriteRegister(2, -1);
+      returnFromSystemCall();
+      return;
+    }
+    DEBUG('u', "Running thread %d\n", newT->id);
+    machine->WriteRegister(2, newT->id);
     newT->Fork(NachosExecThread, (void *)filename);
     returnFromSystemCall();
   } else {
-
-    DEBUG('q', "No se pudo leer de archivo...");
-    return;
+    DEBUG('q', "No se pudo leer el nombre del archivo...");
+    delete[] filename;
+    machine->WriteRegister(2, -1);
+    returnFromSystemCall();
   }
 }
 
@@ -124,16 +145,11 @@ void NachOS_Exec() { // System call 2
  */
 void NachOS_Join() { // System call 3
   SpaceId id = machine->ReadRegister(4);
-  Thread *this_thread = currentThread;
-  DEBUG('u', "Waiting for thread id %d\n", runningThreads->SecureTest(id));
-  DEBUG('u', "Waiting for thread id %d, actual value: %d\n", id,
-        runningThreads->SecureTest(id));
-  while (runningThreads->SecureTest(id) &&
-         runningThreads->SecureNumClear() >= 1) {
-    this_thread->Yield();
-  }
-  // Cuando termina de ejecutar el hilo deseado
-  scheduler->ReadyToRun(this_thread);
+  DEBUG('u', "Waiting for process id %d\n", id);
+  // INFO: se duerme en el semaforo del PCB hasta que el proceso termine
+  int status = processTable->Join(id);
+  // Cuando termina de ejecutar el proceso deseado devuelve su estado
+  machine->WriteRegister(2, status);
   returnFromSystemCall();
 }
 
@@ -141,10 +157,58 @@ void NachOS_Join() { // System call 3
  *  System call interface: void Create( char * )
  */
 void NachOS_Create() { // System call 4
-  fileSystem->Create((char *)machine->ReadRegister(4), 0);
+  char name[MaxUserString];
+  // INFO: el nombre esta en la memoria del usuario, no en la del kernel
+  if (CopyStringFromUser(machine->ReadRegister(4), name, MaxUserString) >= 0) {
+    fileSystem->Create(name, 0);
+    execCache->Invalidate(name); // si era un programa, ya no lo es
+  }
   returnFromSystemCall();
 }
 
+// Devuelve la tabla de archivos abiertos del proceso actual; NULL si el
+// hilo no pertenece a ningun proceso
+static NachosOpenFilesTable *CurrentOpenFiles() {
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  return pcb != NULL ? pcb->openFiles : NULL;
+}
+
+// Devuelve el archivo Unix detras de "descriptor", -1 si no esta abierto
+static int UnixHandleOf(OpenFileId descriptor) {
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  return openFiles != NULL ? openFiles->getUnixHandle(descriptor) : -1;
+}
+
+// Devuelve el archivo abierto de "descriptor", NULL si no esta abierto (o
+// si es la consola, sin redirigir)
+static NachosOpenFile *FileOf(OpenFileId descriptor) {
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  return openFiles != NULL ? openFiles->getFile(descriptor) : NULL;
+}
+
+// Es "descriptor" la consola de verdad, y no algo redirigido con Dup2?
+static bool IsConsole(OpenFileId descriptor) {
+  return descriptor >= ConsoleInput && descriptor <= ConsoleError &&
+         FileOf(descriptor) == NULL;
+}
+
+// Lee o escribe los "count" pedazos del usuario en el pipe de "file" (uno
+// solo para Read y Write).  Mientras espera, otro hilo podria cerrar el
+// descriptor, asi que se toma una referencia propia al archivo
+static int PipeTransfer(NachosOpenFile *file, int *addrs, int *sizes,
+                        int count, bool writing) {
+  if (file->writeEnd != writing)
+    return -1;
+  for (int i = 0; i < count; i++)
+    if (sizes[i] < 0)
+      return -1;
+  file->AddRef();
+  int result = writing ? file->pipe->WriteV(addrs, sizes, count)
+                       : file->pipe->ReadV(addrs, sizes, count);
+  file->DelRef();
+  return result;
+}
+
 /*
  *
  *  System call 5
@@ -152,89 +216,140 @@ void NachOS_Create() { // System call 4
  */
 void NachOS_Open() {
   // Read the name from the user memory, see 5 below
-  char *name = (char *)machine->ReadRegister(4);
-  // Use NachosOpenFilesTable class to create a relationship
-  // between user file and unix file
-  int unixhandle = OpenForReadWrite(name, true);
-  OpenFileId fileId = nachosTablita->Open(unixhandle);
+  char name[MaxUserString];
+  OpenFileId fileId = -1;
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  if (openFiles != NULL &&
+      CopyStringFromUser(machine->ReadRegister(4), name, MaxUserString) >= 0) {
+    // Use NachosOpenFilesTable class to create a relationship
+    // between user file and unix file
+    // WARN: un archivo que no existe no debe botar el kernel
+    int unixhandle = OpenForReadWrite(name, false);
+    if (unixhandle >= 0) {
+      fileId = openFiles->Open(unixhandle, name);
+      if (fileId == -1)
+        Close(unixhandle); // el proceso tiene demasiados archivos abiertos
+    }
+  }
   // Devuelve el ID del archivo abierto
   machine->WriteRegister(2, fileId);
   returnFromSystemCall(); // Update the PC registers
 }
 
+// Cuantos de los "size" bytes de "data" van a la consola.  Como lo hacia
+// printf("%s"), la salida de Write y de WriteV termina en el primer '\0'
+static int ConsoleLength(const char *data, int size) {
+  const char *end = (const char *)memchr(data, '\0', size);
+  return end != NULL ? end - data : size;
+}
+
+// Pasa un pedazo del buffer del usuario a la consola, hasta el '\0'
+static bool AppendToConsole(char *span, int size, void *arg) {
+  int length = ConsoleLength(span, size);
+  ((ConsoleWriter *)arg)->Append(span, length);
+  return length == size;
+}
+
+// Escribe "size" bytes del kernel en la consola, por donde corresponda
+static void WriteToConsole(const char *data, int size) {
+  if (synchConsole != NULL)
+    synchConsole->Write(data, size);
+  else
+    consoleWriter->Append(data, size);
+}
+
+// Pasa el buffer del usuario a la consola del dispositivo (-sc), tambien
+// hasta el primer '\0'.  Se copia antes porque Write se puede bloquear
+// con la consola llena, y mientras tanto la pagina podria irse al swap
+static bool WriteToSynchConsole(int addr, int size) {
+  char *buffer = new char[size > 0 ? size : 1];
+  bool ok = CopyFromUser(addr, buffer, size);
+
+  if (ok)
+    synchConsole->Write(buffer, ConsoleLength(buffer, size));
+  delete[] buffer;
+  return ok;
+}
+
 /*
  *  System call interface: OpenFileId Write( char *, int, OpenFileId )
  */
 void NachOS_Write() { // System call 6
-  const char *buffer = NULL;
-  int size = machine->ReadRegister(5); // Read size to write
   int addr = machine->ReadRegister(4); // addres to read
+  int size = machine->ReadRegister(5); // Read size to write
+  OpenFileId descriptor = machine->ReadRegister(6); // Read file descriptor
+  int result = size;
 
-  int vpn = (unsigned)addr / PageSize;
-  int offset = (unsigned)addr % PageSize;
-  buffer = NachosReadMem(buffer, size, addr);
-  if (buffer != NULL) {
-
-    TranslationEntry *entry = currentThread->space->EntryFromVirtPage(vpn);
-
-    DEBUG('q', "Escrito a memoria [%d - %d] %s\n", vpn, offset, buffer);
-    for (int offs = 0; offs < SectorSize; offs++) {
-      DEBUG('q', "%x",
-            machine
-                ->mainMemory[(entry->physicalPage * PageSize + offset) + offs]);
-    }
-    DEBUG('q', "\n");
-
-#ifdef VM
-    DEBUG('q', "Escrito a swap [%d - %d] %s\n", vpn, offset, buffer);
-    for (int offs = 0; offs < SectorSize; offs++) {
-      DEBUG('q', "%x",
-            swapSpace[(entry->swapSector * SectorSize + offset) + offs]);
-    }
-    DEBUG('q', "\n");
-#endif
-
-    OpenFileId descriptor = machine->ReadRegister(6); // Read file descriptor
+  DEBUG('q', "Escribiendo %d bytes de 0x%x al archivo %d\n", size, addr,
+        descriptor);
 
-    // INFO: los archivos 0, 1, 2 están reservados
+  // INFO: al pipe se copia directo de la memoria del usuario
+  NachosOpenFile *file = FileOf(descriptor);
+  if (file != NULL && file->pipe != NULL) {
+    machine->WriteRegister(2, PipeTransfer(file, &addr, &size, 1, true));
+    returnFromSystemCall();
+    return;
+  }
 
-    // Need a semaphore to synchronize access to console
-    // Console->P();
-    switch (descriptor) {
-    case ConsoleInput: // User could not write to standard input
-      machine->WriteRegister(2, -1);
-      break;
-    case ConsoleOutput:
-      printf("%s", buffer);
-      fflush(stdout);
+  // INFO: los archivos 0, 1, 2 están reservados, salvo que se redirijan
+  // con Dup2; entonces van por default, como cualquier archivo
+  switch (IsConsole(descriptor) ? descriptor : FirstFileDescriptor) {
+  case ConsoleInput: // User could not write to standard input
+    result = -1;
+    break;
+  case ConsoleOutput:
+    // INFO: las paginas del usuario pasan directo al buffer de la consola
+    if (size < 0)
+      result = -1;
+    else if (synchConsole != NULL)
+      result = WriteToSynchConsole(addr, size) ? size : -1;
+    else if (!ForEachUserSpan(addr, size, false, AppendToConsole,
+                              consoleWriter))
+      result = -1;
+    break;
+  case ConsoleError: // This trick permits to write integers to console
+    if (synchConsole != NULL) {
+      char number[16];
+      int length = snprintf(number, sizeof(number), "%d\n",
+                            machine->ReadRegister(4));
+      synchConsole->Write(number, length);
       break;
-    case ConsoleError: // This trick permits to write integers to console
-      printf("%d\n", machine->ReadRegister(4));
+    }
+    consoleWriter->Flush(); // que no se adelante a la salida pendiente
+    printf("%d\n", machine->ReadRegister(4));
+    break;
+  default: // All other opened files
+    // Verify if the file is opened, if not return -1 in r2
+    if (size < 0 || UnixHandleOf(descriptor) == -1) {
+      result = -1;
       break;
-    default: // All other opened files
-      // Verify if the file is opened, if not return -1 in r2
-      if (!nachosTablita->isOpened(descriptor)) {
-        machine->WriteRegister(2, -1);
-        break;
-      }
-      // Get the unix handle from our table for open files
-      int unixhandle = nachosTablita->getUnixHandle(descriptor);
-      // Do the read from the already opened Unix file
+    }
+    char *buffer = new char[size > 0 ? size : 1];
+    // Get the unix handle from our table for open files; it is looked up
+    // again, since another thread might close the file while this one
+    // waits for a page
+    int unixhandle;
+    if (CopyFromUser(addr, buffer, size) &&
+        (unixhandle = UnixHandleOf(descriptor)) != -1) {
+      // Do the write to the already opened Unix file
       WriteFile(unixhandle, buffer, size);
-      // Return the number of chars read from user, via r2
-      machine->WriteRegister(2, size);
-      break;
+      execCache->Invalidate(FileOf(descriptor)->name);
+    } else {
+      result = -1;
     }
+    delete[] buffer;
+    break;
+  }
+  if (result == -1) {
+    DEBUG('q', "No se pudo escribir de 0x%x\n", addr);
+  } else {
     // Update simulation stats, see details in Statistics class in
     // machine/stats.cc
     stats->numDiskWrites += size;
-    // Console->V();
-
-    returnFromSystemCall(); // Update the PC registers
-  } else {
-    DEBUG('q', "No se pudo escribir a [VPN %d - %d]", vpn, offset);
-    return;
   }
+  // Return the number of chars written by the user, via r2
+  machine->WriteRegister(2, result);
+  returnFromSystemCall(); // Update the PC registers
 }
 
 /*
@@ -244,34 +359,47 @@ void NachOS_Read() { // System call 7
   // Do the read from the already opened Unix file
   int dir_buffer = machine->ReadRegister(4);
   int size = machine->ReadRegister(5);
-  int unixhandle = nachosTablita->getUnixHandle(machine->ReadRegister(6));
-
-  char buffer[size];
-  int readed = ReadPartial(unixhandle, buffer, size);
-  bool write_ok = true;
-  for (int offset = 0; offset < size; offset++) {
-    if (!machine->WriteMem(dir_buffer + offset, 1, buffer[offset],
-                           "NachOS_Read")) {
-      write_ok = false;
-      break;
-    }
+  OpenFileId descriptor = machine->ReadRegister(6);
+  bool fromConsole = descriptor == ConsoleInput && IsConsole(descriptor);
+  int unixhandle = fromConsole ? 0 : UnixHandleOf(descriptor);
+
+  // INFO: del pipe se copia directo a la memoria del usuario
+  NachosOpenFile *file = FileOf(descriptor);
+  if (file != NULL && file->pipe != NULL) {
+    machine->WriteRegister(2,
+                           PipeTransfer(file, &dir_buffer, &size, 1, false));
+    returnFromSystemCall();
+    return;
   }
+
+  // INFO: lo que se escribio antes (un prompt) debe verse antes de leer
+  if (fromConsole)
+    consoleWriter->Flush();
+
+  char *buffer = new char[size > 0 ? size : 1];
+  int readed = 0;
+  if (size > 0 && fromConsole && synchConsole != NULL)
+    readed = synchConsole->Read(buffer, size); // espera una linea completa
+  else if (size > 0)
+    readed = unixhandle >= 0 ? ReadPartial(unixhandle, buffer, size) : -1;
+  // INFO: solo se copia lo que se leyo, una pagina a la vez
+  bool write_ok = readed <= 0 || CopyToUser(dir_buffer, buffer, readed);
   int vpn = (unsigned)dir_buffer / PageSize;
   int offset = (unsigned)dir_buffer % PageSize;
   if (write_ok) {
     DEBUG('q', "Leido de memoria [VPN %d - %d]: ", vpn, offset);
-    for (int i = 0; i < size; i++) {
+    for (int i = 0; i < readed; i++) {
       DEBUG('q', "%c", buffer[i]);
     }
     DEBUG('q', "\n");
     stats->numDiskReads += size;
     machine->WriteRegister(2, readed);
-    returnFromSystemCall();
   } else {
     DEBUG('q', "No se pudo leer de memoria [VPN %d - %d]\n", vpn, offset);
-    machine->WriteRegister(4, machine->ReadRegister(4) - 1);
-    return;
+    machine->WriteRegister(2, -1);
   }
+  delete[] buffer;
+  returnFromSystemCall();
 }
 
 /*
@@ -279,8 +407,10 @@ void NachOS_Read() { // System call 7
  */
 void NachOS_Close() { // System call 8
   OpenFileId id = machine->ReadRegister(4);
-  Close(nachosTablita->getUnixHandle(id));
-  nachosTablita->Close(id);
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  // INFO: el archivo Unix se cierra cuando ningun descriptor lo usa
+  int result = openFiles != NULL ? openFiles->Close(id) : -1;
+  machine->WriteRegister(2, result);
   returnFromSystemCall(); // Update the PC registers
 }
 
@@ -292,6 +422,7 @@ void NachosForkThread(void *p) { // for 64 bits version
 
   currentThread->space->InitRegisters(); // set the initial register values
   currentThread->space->RestoreState();  // load page table register
+  machine->WriteRegister(StackReg, currentThread->userStack);
   //
   // Set the return address for this thread to the same as the main thread
   // This will lead this thread to call the exit system call and finish
@@ -309,6 +440,13 @@ void NachosForkThread(void *p) { // for 64 bits version
  */
 void NachOS_Fork() { // System call 9
   DEBUG('u', "Entering Fork System call\n");
+  int stack = currentThread->space->NewThreadStack();
+  if (stack == -1) {
+    // WARN: no hay lugar para otro stack, el hilo no se crea
+    DEBUG('u', "No space for the stack of a new thread\n");
+    returnFromSystemCall();
+    return;
+  }
   // We need to create a new kernel thread to execute the user thread
   Thread *newT = new Thread("child to execute Fork code");
 
@@ -321,7 +459,17 @@ void NachOS_Fork() { // System call 9
   // AddrSpace class, This new constructor will copy the shared segments (space
   // variable) from currentThread, passed as a parameter, and create a new stack
   // for the new child
-  newT->space = new AddrSpace(*currentThread->space);
+  // INFO: el mismo espacio, no una copia: el heap, el stack que crece, los
+  // segmentos y los archivos mapeados de un hilo los ven todos
+  newT->space = currentThread->space;
+  newT->userStack = stack;
+
+  // The child is one more thread of the same process
+  newT->id = currentThread->id;
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  if (pcb != NULL) {
+    processTable->AddThread(pcb);
+  }
 
   // We (kernel)-Fork to a new method to execute the child code
   // Pass the user routine address, now in register 4, as a parameter
@@ -339,82 +487,438 @@ void NachOS_Yield() { // System call 10
   returnFromSystemCall();
 }
 
+// Devuelve la tabla de objetos de sincronizacion del proceso actual,
+// creandola la primera vez que se usa
+static UserSyncTable *CurrentSyncObjects() {
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  if (pcb == NULL)
+    return NULL;
+  if (pcb->syncObjects == NULL)
+    pcb->syncObjects = new UserSyncTable;
+  return pcb->syncObjects;
+}
+
+// Busca el objeto con el handle del registro "reg"; NULL si no existe
+static UserSync *UseSyncObject(int reg, UserSyncKind kind) {
+  UserSyncTable *table = CurrentSyncObjects();
+  return table != NULL ? table->Use(machine->ReadRegister(reg), kind) : NULL;
+}
+
+static void CreateSyncObject(UserSyncKind kind, int initialValue) {
+  UserSyncTable *table = CurrentSyncObjects();
+  int handle = table != NULL ? table->Create(kind, initialValue) : -1;
+  machine->WriteRegister(2, handle);
+  returnFromSystemCall();
+}
+
+static void DestroySyncObject(UserSyncKind kind) {
+  UserSyncTable *table = CurrentSyncObjects();
+  int result =
+      table != NULL ? table->Destroy(machine->ReadRegister(4), kind) : -1;
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
+}
+
 /*
  *  System call interface: Sem_t SemCreate( int )
  */
 void NachOS_SemCreate() { // System call 11
+  CreateSyncObject(USER_SEMAPHORE, machine->ReadRegister(4));
 }
 
 /*
  *  System call interface: int SemDestroy( Sem_t )
  */
 void NachOS_SemDestroy() { // System call 12
+  DestroySyncObject(USER_SEMAPHORE);
 }
 
 /*
  *  System call interface: int SemSignal( Sem_t )
  */
 void NachOS_SemSignal() { // System call 13
+  UserSync *sem = UseSyncObject(4, USER_SEMAPHORE);
+  int result = -1;
+  if (sem != NULL) {
+    sem->semaphore->V();
+    sem->Unuse();
+    result = 0;
+  }
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
  *  System call interface: int SemWait( Sem_t )
  */
 void NachOS_SemWait() { // System call 14
+  UserSync *sem = UseSyncObject(4, USER_SEMAPHORE);
+  int result = -1;
+  if (sem != NULL) {
+    // INFO: el hilo se bloquea en el semaforo del kernel, sin ciclar
+    sem->semaphore->P();
+    result = sem->semaphore->isDestroyed() ? -1 : 0;
+    sem->Unuse();
+  }
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
  *  System call interface: Lock_t LockCreate( int )
  */
 void NachOS_LockCreate() { // System call 15
+  CreateSyncObject(USER_LOCK, 0);
 }
 
 /*
  *  System call interface: int LockDestroy( Lock_t )
  */
 void NachOS_LockDestroy() { // System call 16
+  DestroySyncObject(USER_LOCK);
 }
 
 /*
  *  System call interface: int LockAcquire( Lock_t )
  */
 void NachOS_LockAcquire() { // System call 17
+  UserSync *lock = UseSyncObject(4, USER_LOCK);
+  int result = -1;
+  if (lock != NULL && !lock->lock->isHeldByCurrentThread()) {
+    lock->lock->Acquire();
+    result = lock->lock->isHeldByCurrentThread() ? 0 : -1;
+  }
+  if (lock != NULL)
+    lock->Unuse();
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
  *  System call interface: int LockRelease( Lock_t )
  */
 void NachOS_LockRelease() { // System call 18
+  UserSync *lock = UseSyncObject(4, USER_LOCK);
+  int result = -1;
+  if (lock != NULL && lock->lock->isHeldByCurrentThread()) {
+    lock->lock->Release();
+    result = 0;
+  }
+  if (lock != NULL)
+    lock->Unuse();
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
- *  System call interface: Cond_t LockCreate( int )
+ *  System call interface: Cond_t CondCreate()
  */
 void NachOS_CondCreate() { // System call 19
+  CreateSyncObject(USER_CONDITION, 0);
 }
 
 /*
  *  System call interface: int CondDestroy( Cond_t )
  */
 void NachOS_CondDestroy() { // System call 20
+  DestroySyncObject(USER_CONDITION);
+}
+
+// Signal, Wait y Broadcast: la condicion en r4 y el lock en r5, que el
+// hilo debe tener
+static void ConditionOperation(int syscall) {
+  UserSync *cond = UseSyncObject(4, USER_CONDITION);
+  UserSync *lock = UseSyncObject(5, USER_LOCK);
+  int result = -1;
+  if (cond != NULL && lock != NULL && lock->lock->isHeldByCurrentThread()) {
+    result = 0;
+    if (syscall == SC_CondSignal) {
+      cond->condition->Signal(lock->lock);
+    } else if (syscall == SC_CondBroadcast) {
+      cond->condition->Broadcast(lock->lock);
+    } else {
+      cond->condition->Wait(lock->lock);
+      // WARN: si se destruyo mientras esperaba, falla
+      if (cond->condition->isDestroyed() || !lock->lock->isHeldByCurrentThread())
+        result = -1;
+    }
+  }
+  if (cond != NULL)
+    cond->Unuse();
+  if (lock != NULL)
+    lock->Unuse();
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
- *  System call interface: int CondSignal( Cond_t )
+ *  System call interface: int CondSignal( Cond_t, Lock_t )
  */
 void NachOS_CondSignal() { // System call 21
+  ConditionOperation(SC_CondSignal);
 }
 
 /*
- *  System call interface: int CondWait( Cond_t )
+ *  System call interface: int CondWait( Cond_t, Lock_t )
  */
 void NachOS_CondWait() { // System call 22
+  ConditionOperation(SC_CondWait);
 }
 
 /*
- *  System call interface: int CondBroadcast( Cond_t )
+ *  System call interface: int CondBroadcast( Cond_t, Lock_t )
  */
 void NachOS_CondBroadcast() { // System call 23
+  ConditionOperation(SC_CondBroadcast);
+}
+
+/*
+ *  System call interface: void Sleep( int )
+ */
+void NachOS_Sleep() { // System call 24
+  int ticks = machine->ReadRegister(4);
+  returnFromSystemCall();
+  // INFO: el hilo duerme en tiempo simulado, los demas siguen corriendo
+  alarmClock->WaitUntil(ticks);
+}
+
+/*
+ *  System call interface: int Ticks()
+ */
+void NachOS_Ticks() { // System call 46
+  machine->WriteRegister(2, stats->totalTicks);
+  returnFromSystemCall();
+}
+
+// Hace un ReadV/WriteV (o PRead/PWrite, si "positional").  Los pedazos
+// se copian con el camino de copia por paginas a un solo buffer del
+// kernel, y se pasan al host de una vez con readv/writev (o preadv/
+// pwritev).  Los de un pipe van directo, como en Read y Write.  Devuelve
+// los bytes transferidos, o -1
+static int VectoredIO(bool writing, bool positional) {
+  int iovAddr = machine->ReadRegister(4);
+  int count = machine->ReadRegister(5);
+  int offset = positional ? machine->ReadRegister(6) : -1;
+  OpenFileId descriptor = machine->ReadRegister(positional ? 7 : 6);
+  bool toConsole = writing && !positional && descriptor == ConsoleOutput &&
+                   IsConsole(descriptor);
+  NachosOpenFile *file = FileOf(descriptor);
+  bool piped = file != NULL && file->pipe != NULL;
+
+  if (count < 0 || count > MaxIoVecs || (positional && offset < 0))
+    return -1;
+  // INFO: un pipe no tiene posicion, PRead y PWrite fallan como pread(2)
+  if (piped && positional)
+    return -1;
+  if (!toConsole && !piped && UnixHandleOf(descriptor) == -1)
+    return -1;
+
+  // INFO: cada IoVec son dos palabras del usuario, base y largo
+  unsigned words[2 * MaxIoVecs];
+  int addrs[MaxIoVecs], sizes[MaxIoVecs];
+  char *buffers[MaxIoVecs];
+  int total = 0;
+  if (!CopyFromUser(iovAddr, (char *)words, count * 2 * sizeof(unsigned)))
+    return -1;
+  for (int i = 0; i < count; i++) {
+    addrs[i] = WordToHost(words[2 * i]);
+    sizes[i] = WordToHost(words[2 * i + 1]);
+    if (sizes[i] < 0 || sizes[i] > MaxUserIo - total)
+      return -1;
+    total += sizes[i];
+  }
+  if (piped)
+    return PipeTransfer(file, addrs, sizes, count, writing);
+
+  char *buffer = new char[total > 0 ? total : 1];
+  for (int i = 0, used = 0; i < count; used += sizes[i++])
+    buffers[i] = buffer + used;
+
+  int result = 0;
+  if (writing) {
+    for (int i = 0; i < count && result != -1; i++)
+      if (!CopyFromUser(addrs[i], buffers[i], sizes[i]))
+        result = -1;
+    if (result != -1 && toConsole) {
+      WriteToConsole(buffer, ConsoleLength(buffer, total));
+      result = total;
+    } else if (result != -1) {
+      // WARN: otro hilo pudo cerrar el archivo mientras se copiaba
+      int unixhandle = UnixHandleOf(descriptor);
+      result = unixhandle != -1
+                   ? WriteGather(unixhandle, buffers, sizes, count, offset)
+                   : -1;
+      if (result > 0)
+        execCache->Invalidate(FileOf(descriptor)->name);
+    }
+    if (result > 0)
+      stats->numDiskWrites += result;
+  } else {
+    result = ReadScatter(UnixHandleOf(descriptor), buffers, sizes, count,
+                         offset);
+    // INFO: solo se copia lo que se leyo, pedazo por pedazo
+    for (int i = 0, left = result; i < count && left > 0; i++) {
+      int n = left < sizes[i] ? left : sizes[i];
+      if (!CopyToUser(addrs[i], buffers[i], n))
+        result = -1;
+      left -= n;
+    }
+    if (result > 0)
+      stats->numDiskReads += result;
+  }
+  delete[] buffer;
+  DEBUG('q', "%s de %d pedazos (%d bytes) en el archivo %d: %d\n",
+        writing ? "Escritura" : "Lectura", count, total, descriptor, result);
+  return result;
+}
+
+/*
+ *  System call interface: int ReadV( IoVec *, int, OpenFileId )
+ */
+void NachOS_ReadV() { // System call 25
+  machine->WriteRegister(2, VectoredIO(false, false));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int WriteV( IoVec *, int, OpenFileId )
+ */
+void NachOS_WriteV() { // System call 26
+  machine->WriteRegister(2, VectoredIO(true, false));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int PRead( IoVec *, int, int, OpenFileId )
+ */
+void NachOS_PRead() { // System call 27
+  machine->WriteRegister(2, VectoredIO(false, true));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int PWrite( IoVec *, int, int, OpenFileId )
+ */
+void NachOS_PWrite() { // System call 28
+  machine->WriteRegister(2, VectoredIO(true, true));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int Pipe( OpenFileId * )
+ */
+void NachOS_Pipe() { // System call 29
+  int fdsAddr = machine->ReadRegister(4);
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  int result = -1;
+
+  if (openFiles != NULL) {
+    NachosPipe *newPipe = new NachosPipe();
+    NachosOpenFile *readEnd = new NachosOpenFile(newPipe, false);
+    NachosOpenFile *writeEnd = new NachosOpenFile(newPipe, true);
+    int readFd = openFiles->Open(readEnd);
+    int writeFd = openFiles->Open(writeEnd);
+    // INFO: si algo falla se cierra todo, y con eso se borra el pipe
+    if (readFd == -1 || writeFd == -1 || !WriteUserWord(fdsAddr, readFd) ||
+        !WriteUserWord(fdsAddr + 4, writeFd)) {
+      if (readFd == -1)
+        readEnd->DelRef();
+      else
+        openFiles->Close(readFd);
+      if (writeFd == -1)
+        writeEnd->DelRef();
+      else
+        openFiles->Close(writeFd);
+    } else {
+      result = 0;
+    }
+  }
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int ShmCreate( int, int )
+ */
+void NachOS_ShmCreate() { // System call 39
+  machine->WriteRegister(2, sharedMemory->Create(machine->ReadRegister(4),
+                                                 machine->ReadRegister(5)));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: char * ShmAttach( int )
+ */
+void NachOS_ShmAttach() { // System call 40
+  int firstPage =
+      sharedMemory->Attach(machine->ReadRegister(4), currentThread->space);
+  // INFO: -1 como Sbrk, para que Batch se detenga si falla
+  machine->WriteRegister(2, firstPage != -1 ? firstPage * PageSize : -1);
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int ShmDetach( char * )
+ */
+void NachOS_ShmDetach() { // System call 41
+  int addr = machine->ReadRegister(4);
+  machine->WriteRegister(2, currentThread->space->Detach(addr));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: char * Sbrk( int )
+ */
+void NachOS_Sbrk() { // System call 42
+  machine->WriteRegister(2,
+                         currentThread->space->Sbrk(machine->ReadRegister(4)));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: char * Mmap( OpenFileId, int, int )
+ */
+void NachOS_Mmap() { // System call 43
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  NachosOpenFile *file =
+      openFiles != NULL ? openFiles->getFile(machine->ReadRegister(4)) : NULL;
+  int offset = machine->ReadRegister(5);
+  int length = machine->ReadRegister(6);
+  int firstPage = -1;
+
+  // WARN: un pipe no tiene paginas que mapear
+  if (file != NULL && file->pipe == NULL && offset >= 0 &&
+      offset % PageSize == 0 && length > 0 &&
+      length <= NumVirtPages * PageSize)
+    firstPage = currentThread->space->Mmap(file, offset, length);
+  machine->WriteRegister(2, firstPage != -1 ? firstPage * PageSize : -1);
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int Munmap( char * )
+ */
+void NachOS_Munmap() { // System call 44
+  int addr = machine->ReadRegister(4);
+  machine->WriteRegister(2, currentThread->space->Munmap(addr));
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: OpenFileId Dup2( OpenFileId, OpenFileId )
+ */
+void NachOS_Dup2() { // System call 38
+  NachosOpenFilesTable *openFiles = CurrentOpenFiles();
+  int result = -1;
+
+  if (openFiles != NULL) {
+    // INFO: lo pendiente de la consola sale antes de redirigirla
+    consoleWriter->Flush();
+    result = openFiles->Dup2(machine->ReadRegister(4),
+                             machine->ReadRegister(5));
+  }
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
 }
 
 /*
@@ -453,6 +957,183 @@ void NachOS_Accept() { // System call 34
 void NachOS_Shutdown() { // System call 25
 }
 
+/*
+ *  System call interface: int IoSetup( IoRing * )
+ */
+void NachOS_IoSetup() { // System call 36
+  int ring = machine->ReadRegister(4);
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  int result = -1, last;
+
+  // INFO: todo el anillo debe estar en el espacio del proceso
+  if (pcb != NULL && pcb->ioContext == NULL && ring % 4 == 0 &&
+      ReadUserWord(ring + (IoRingWords - 1) * 4, &last)) {
+    bool ok = true;
+    for (int field = 0; field < IoRingHeaderWords && ok; field++)
+      ok = WriteUserWord(ring + field * 4, 0);
+    if (ok) {
+      pcb->ioContext = new IoContext(ring);
+      result = 0;
+    }
+  }
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
+}
+
+/*
+ *  System call interface: int IoEnter( int, int )
+ */
+void NachOS_IoEnter() { // System call 37
+  PCB *pcb = processTable->Lookup(currentThread->id);
+  int result = -1;
+
+  if (pcb != NULL && pcb->ioContext != NULL)
+    result = pcb->ioContext->Enter(machine->ReadRegister(4),
+                                   machine->ReadRegister(5));
+  machine->WriteRegister(2, result);
+  returnFromSystemCall();
+}
+
+static void RunSyscall(int type);
+
+/*
+ *  System call interface: int Batch( SyscallDesc *, int )
+ */
+void NachOS_Batch() { // System call 45
+  int callsAddr = machine->ReadRegister(4);
+  int count = machine->ReadRegister(5);
+  int prevPC = machine->ReadRegister(PrevPCReg);
+  int pc = machine->ReadRegister(PCReg);
+  int nextPC = machine->ReadRegister(NextPCReg);
+  const int descWords = sizeof(SyscallDesc) / sizeof(int);
+
+  // INFO: se leen todos los descriptores de una vez; cada uno es type,
+  // cuatro argumentos y result
+  unsigned words[MaxBatchCalls * descWords];
+  if (count < 0 || count > MaxBatchCalls ||
+      !CopyFromUser(callsAddr, (char *)words, count * descWords * 4)) {
+    machine->WriteRegister(2, -1);
+    returnFromSystemCall();
+    return;
+  }
+
+  int done = 0;
+  stats->numBatches++;
+  for (; done < count; done++) {
+    unsigned *desc = &words[done * descWords];
+    int type = WordToHost(desc[0]);
+    int result = -1;
+
+    if (type >= 0 && type < NumSyscalls && type != SC_Halt &&
+        type != SC_Exit && type != SC_Batch &&
+        syscallTable[type].handler != NULL) {
+      for (int arg = 0; arg < 4; arg++)
+        machine->WriteRegister(4 + arg, WordToHost(desc[1 + arg]));
+      machine->WriteRegister(2, 0); // para las que no devuelven nada
+      RunSyscall(type);
+      result = machine->ReadRegister(2);
+      // NOTE: cada llamada avanza el PC, pero la instruccion es el Batch
+      machine->WriteRegister(PrevPCReg, prevPC);
+      machine->WriteRegister(PCReg, pc);
+      machine->WriteRegister(NextPCReg, nextPC);
+      stats->numBatchedSyscalls++;
+    }
+    // WARN: si el resultado no se puede escribir, se toma como un fallo
+    if (!WriteUserWord(callsAddr + (done * descWords + descWords - 1) * 4,
+                       result) ||
+        result < 0)
+      break;
+  }
+  DEBUG('u', "Batch de %d llamadas: %d bien\n", count, done);
+  machine->WriteRegister(2, done);
+  returnFromSystemCall();
+}
+
+//----------------------------------------------------------------------
+// syscallTable
+// 	The system calls, indexed by the code the stub leaves in r2.  See
+//	syscall.h for their interface.
+//----------------------------------------------------------------------
+
+const SyscallDescriptor syscallTable[NumSyscalls] = {
+    {"Halt", 0, NachOS_Halt}, // 0
+    {"Exit", 1, NachOS_Exit}, // 1
+    {"Exec", 1, NachOS_Exec}, // 2
+    {"Join", 1, NachOS_Join}, // 3
+    {"Create", 1, NachOS_Create}, // 4
+    {"Open", 1, NachOS_Open}, // 5
+    {"Read", 3, NachOS_Read}, // 6
+    {"Write", 3, NachOS_Write}, // 7
+    {"Close", 1, NachOS_Close}, // 8
+    {"Fork", 1, NachOS_Fork}, // 9
+    {"Yield", 0, NachOS_Yield}, // 10
+    {"SemCreate", 1, NachOS_SemCreate}, // 11
+    {"SemDestroy", 1, NachOS_SemDestroy}, // 12
+    {"SemSignal", 1, NachOS_SemSignal}, // 13
+    {"SemWait", 1, NachOS_SemWait}, // 14
+    {"LockCreate", 1, NachOS_LockCreate}, // 15
+    {"LockDestroy", 1, NachOS_LockDestroy}, // 16
+    {"LockAcquire", 1, NachOS_LockAcquire}, // 17
+    {"LockRelease", 1, NachOS_LockRelease}, // 18
+    {"CondCreate", 0, NachOS_CondCreate}, // 19
+    {"CondDestroy", 1, NachOS_CondDestroy}, // 20
+    {"CondSignal", 2, NachOS_CondSignal}, // 21
+    {"CondWait", 2, NachOS_CondWait}, // 22
+    {"CondBroadcast", 2, NachOS_CondBroadcast}, // 23
+    {"Sleep", 1, NachOS_Sleep}, // 24
+    {"ReadV", 3, NachOS_ReadV}, // 25
+    {"WriteV", 3, NachOS_WriteV}, // 26
+    {"PRead", 4, NachOS_PRead}, // 27
+    {"PWrite", 4, NachOS_PWrite}, // 28
+    {"Pipe", 1, NachOS_Pipe}, // 29
+    {"Socket", 2, NachOS_Socket}, // 30
+    {"Connect", 2, NachOS_Connect}, // 31
+    {"Bind", 2, NachOS_Bind}, // 32
+    {"Listen", 2, NachOS_Listen}, // 33
+    {"Accept", 1, NachOS_Accept}, // 34
+    {"Shutdown", 2, NachOS_Shutdown}, // 35
+    {"IoSetup", 1, NachOS_IoSetup}, // 36
+    {"IoEnter", 2, NachOS_IoEnter}, // 37
+    {"Dup2", 2, NachOS_Dup2}, // 38
+    {"ShmCreate", 2, NachOS_ShmCreate}, // 39
+    {"ShmAttach", 1, NachOS_ShmAttach}, // 40
+    {"ShmDetach", 1, NachOS_ShmDetach}, // 41
+    {"Sbrk", 1, NachOS_Sbrk}, // 42
+    {"Mmap", 3, NachOS_Mmap}, // 43
+    {"Munmap", 1, NachOS_Munmap}, // 44
+    {"Batch", 2, NachOS_Batch},   // 45
+    {"Ticks", 0, NachOS_Ticks}, // 46
+};
+
+//----------------------------------------------------------------------
+// ProfiledSyscall
+// 	Run system call "type", and count it for -ss.  A call that does
+//	not come back to the caller (Exit, Halt) is counted, but not
+//	timed.
+//----------------------------------------------------------------------
+
+static void ProfiledSyscall(int type) {
+  long long startTicks = stats->totalTicks;
+  long long startNanos = HostNanoseconds();
+
+  syscallProfiler->Call(type);
+  syscallTable[type].handler();
+  syscallProfiler->Record(type, stats->totalTicks - startTicks,
+                          HostNanoseconds() - startNanos);
+}
+
+//----------------------------------------------------------------------
+// RunSyscall
+// 	Run system call "type", profiling it if -ss was given.
+//----------------------------------------------------------------------
+
+static void RunSyscall(int type) {
+  if (syscallProfiler != NULL)
+    ProfiledSyscall(type);
+  else
+    syscallTable[type].handler();
+}
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -484,112 +1165,26 @@ void ExceptionHandler(ExceptionType which) {
   switch (which) {
 
   case SyscallException:
-    switch (type) {
-    case SC_Halt: // System call # 0
-      NachOS_Halt();
-      break;
-    case SC_Exit: // System call # 1
-      NachOS_Exit();
-      break;
-    case SC_Exec: // System call # 2
-      NachOS_Exec();
-      break;
-    case SC_Join: // System call # 3
-      NachOS_Join();
-      break;
-
-    case SC_Create: // System call # 4
-      NachOS_Create();
-      break;
-    case SC_Open: // System call # 5
-      NachOS_Open();
-      break;
-    case SC_Read: // System call # 6
-      NachOS_Read();
-      break;
-    case SC_Write: // System call # 7
-      NachOS_Write();
-      break;
-    case SC_Close: // System call # 8
-      NachOS_Close();
-      break;
-
-    case SC_Fork: // System call # 9
-      NachOS_Fork();
-      break;
-    case SC_Yield: // System call # 10
-      NachOS_Yield();
-      break;
-
-    case SC_SemCreate: // System call # 11
-      NachOS_SemCreate();
-      break;
-    case SC_SemDestroy: // System call # 12
-      NachOS_SemDestroy();
-      break;
-    case SC_SemSignal: // System call # 13
-      NachOS_SemSignal();
-      break;
-    case SC_SemWait: // System call # 14
-      NachOS_SemWait();
-      break;
-
-    case SC_LckCreate: // System call # 15
-      NachOS_LockCreate();
-      break;
-    case SC_LckDestroy: // System call # 16
-      NachOS_LockDestroy();
-      break;
-    case SC_LckAcquire: // System call # 17
-      NachOS_LockAcquire();
-      break;
-    case SC_LckRelease: // System call # 18
-      NachOS_LockRelease();
-      break;
-
-    case SC_CondCreate: // System call # 19
-      NachOS_CondCreate();
-      break;
-    case SC_CondDestroy: // System call # 20
-      NachOS_CondDestroy();
-      break;
-    case SC_CondSignal: // System call # 21
-      NachOS_CondSignal();
-      break;
-    case SC_CondWait: // System call # 22
-      NachOS_CondWait();
-      break;
-    case SC_CondBroadcast: // System call # 23
-      NachOS_CondBroadcast();
-      break;
-
-    case SC_Socket: // System call # 30
-      NachOS_Socket();
-      break;
-    case SC_Connect: // System call # 31
-      NachOS_Connect();
-      break;
-    case SC_Bind: // System call # 32
-      NachOS_Bind();
-      break;
-    case SC_Listen: // System call # 33
-      NachOS_Listen();
-      break;
-    case SC_Accept: // System call # 32
-      NachOS_Accept();
-      break;
-    case SC_Shutdown: // System call # 33
-      NachOS_Shutdown();
-      break;
-
-    default:
+    if (PCB *pcb = processTable->Lookup(currentThread->id)) {
+      pcb->numSyscalls++;
+    }
+    if (type < 0 || type >= NumSyscalls ||
+        syscallTable[type].handler == NULL) {
       printf("Unexpected syscall exception %d\n", type);
       ASSERT(false);
-      break;
+    } else {
+      RunSyscall(type);
     }
     break;
 
   case PageFaultException:
+    // INFO: con VM la pagina ya se cargo y la instruccion se repite; una
+    // pagina que no esta en la tabla puede ser el stack que crece
+    if (!currentThread->space->HandleFault(
+            machine->ReadRegister(BadVAddrReg))) {
+      printf("Address error exception (%d)\n", AddressErrorException);
+      ASSERT(false);
+    }
     break;
 
   case ReadOnlyException:
@@ -0,0 +1,271 @@
+// execcache.cc
+//	Routines to load executables once, and keep them for the next
+//	Exec of the same program.
+//
+//	Only Load can wait (for the disk, with the real file system);
+//	everything else runs without giving up the CPU, so the cache
+//	needs no lock.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "execcache.h"
+#include "copyright.h"
+#include "noff.h"
+#include "system.h"
+
+#include <cstdio>
+#include <cstring>
+
+//----------------------------------------------------------------------
+// SwapHeader
+// 	Do little endian to big endian conversion on the bytes in the
+//	object file header, in case the file was generated on a little
+//	endian machine, and we're now running on a big endian machine.
+//----------------------------------------------------------------------
+
+static void SwapHeader(NoffHeader *noffH) {
+  noffH->noffMagic = WordToHost(noffH->noffMagic);
+  noffH->code.size = WordToHost(noffH->code.size);
+  noffH->code.virtualAddr = WordToHost(noffH->code.virtualAddr);
+  noffH->code.inFileAddr = WordToHost(noffH->code.inFileAddr);
+  noffH->initData.size = WordToHost(noffH->initData.size);
+  noffH->initData.virtualAddr = WordToHost(noffH->initData.virtualAddr);
+  noffH->initData.inFileAddr = WordToHost(noffH->initData.inFileAddr);
+  noffH->uninitData.size = WordToHost(noffH->uninitData.size);
+  noffH->uninitData.virtualAddr = WordToHost(noffH->uninitData.virtualAddr);
+  noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
+}
+
+// Longest working directory CanonicalPath expects
+const int MaxDirectoryLength = 1024;
+
+//----------------------------------------------------------------------
+// CanonicalPath
+// 	The key of file "name" in the cache: its path from the root, with
+//	no "." or ".." parts nor repeated slashes.  The caller deletes it.
+//----------------------------------------------------------------------
+
+static char *CanonicalPath(const char *name) {
+  char directory[MaxDirectoryLength] = "";
+
+  if (name[0] != '/') {
+    bool ok = CurrentDirectory(directory, MaxDirectoryLength);
+    ASSERT(ok);
+  }
+  char *joined = new char[strlen(directory) + strlen(name) + 2];
+  char *path = new char[strlen(directory) + strlen(name) + 2];
+  sprintf(joined, "%s/%s", directory, name);
+
+  int length = 0;
+  for (char *part = joined; *part != '\0';) {
+    int size = strcspn(part, "/");
+    if (size == 2 && strncmp(part, "..", 2) == 0) {
+      while (length > 0 && path[--length] != '/')
+        ; // INFO: ".." en la raiz es la raiz
+    } else if (size > 0 && !(size == 1 && part[0] == '.')) {
+      path[length++] = '/';
+      memcpy(&path[length], part, size);
+      length += size;
+    }
+    part += size;
+    if (*part == '/')
+      part++;
+  }
+  if (length == 0)
+    path[length++] = '/';
+  path[length] = '\0';
+  delete[] joined;
+  return path;
+}
+
+ExecImage::ExecImage(const char *whichName) {
+  name = new char[strlen(whichName) + 1];
+  strcpy(name, whichName);
+  numCodePages = numDataPages = numUninitPages = numFilePages = 0;
+  contents = NULL;
+  refs = 1;
+  lastUsed = 0;
+  cached = false;
+}
+
+ExecImage::~ExecImage() {
+  delete[] name;
+  delete[] contents;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::ExecCache
+// 	Initialize an empty cache.
+//----------------------------------------------------------------------
+
+ExecCache::ExecCache() {
+  for (int slot = 0; slot < MaxExecImages; slot++)
+    images[slot] = NULL;
+  clock = 0;
+}
+
+ExecCache::~ExecCache() {
+  for (int slot = 0; slot < MaxExecImages; slot++)
+    if (images[slot] != NULL)
+      Drop(slot);
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Get
+// 	Find the image of executable "name", under its CanonicalPath, or
+//	load it and keep it in place of the least recently used one.  Returns NULL if "name" is
+//	not an executable.
+//----------------------------------------------------------------------
+
+ExecImage *ExecCache::Get(const char *name) {
+  int slot, victim = 0;
+  char *path = CanonicalPath(name);
+
+  clock++;
+  for (slot = 0; slot < MaxExecImages; slot++) {
+    if (images[slot] != NULL && strcmp(images[slot]->name, path) == 0) {
+      images[slot]->lastUsed = clock;
+      images[slot]->refs++;
+      stats->numExecCacheHits++;
+      delete[] path;
+      return images[slot];
+    }
+  }
+  stats->numExecCacheMisses++;
+
+  ExecImage *image = Load(name, path);
+  delete[] path;
+  if (image == NULL)
+    return NULL;
+
+  // INFO: se busca el lugar despues de Load, que pudo esperar al disco
+  for (slot = 0; slot < MaxExecImages; slot++) {
+    if (images[slot] == NULL)
+      break;
+    if (images[slot]->lastUsed < images[victim]->lastUsed)
+      victim = slot;
+  }
+  if (slot == MaxExecImages) {
+    Drop(victim);
+    slot = victim;
+  }
+  images[slot] = image;
+  image->cached = true;
+  image->refs++; // la del cache
+  image->lastUsed = clock;
+  return image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Release
+// 	The caller is done with "image".  An image that left the cache
+//	meanwhile is deleted with its last user.
+//----------------------------------------------------------------------
+
+void ExecCache::Release(ExecImage *image) {
+  if (--image->refs == 0)
+    delete image;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Invalidate
+// 	The file "name" was created or written to: drop its image, if it
+//	was an executable in the cache.
+//----------------------------------------------------------------------
+
+void ExecCache::Invalidate(const char *name) {
+  if (name == NULL)
+    return;
+  char *path = CanonicalPath(name);
+  for (int slot = 0; slot < MaxExecImages; slot++)
+    if (images[slot] != NULL && strcmp(images[slot]->name, path) == 0)
+      Drop(slot);
+  delete[] path;
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Drop
+// 	Take the image in "slot" out of the cache.
+//----------------------------------------------------------------------
+
+void ExecCache::Drop(int slot) {
+  ExecImage *image = images[slot];
+
+  images[slot] = NULL;
+  image->cached = false;
+  Release(image);
+}
+
+//----------------------------------------------------------------------
+// ExecCache::Load
+// 	Open executable "name", check its NOFF header, and read its code
+//	and initialized data where they go in the address space.  The
+//	image is known by "path".
+//	Returns NULL if it can not be opened, or is not an executable.
+//----------------------------------------------------------------------
+
+ExecImage *ExecCache::Load(const char *name, const char *path) {
+  NoffHeader noffH;
+  OpenFile *executable = fileSystem->Open(name);
+
+  if (executable == NULL) {
+    DEBUG('u', "Unable to open the executable %s\n", name);
+    return NULL;
+  }
+  // WARN: un header corto deja basura en noffH
+  if (executable->ReadAt((char *)&noffH, sizeof(noffH), 0) != sizeof(noffH)) {
+    DEBUG('u', "%s is not an executable\n", name);
+    delete executable;
+    return NULL;
+  }
+  // NOTE: pasa los headers a big endian de ser necesario
+  if ((noffH.noffMagic != NOFFMAGIC) &&
+      (WordToHost(noffH.noffMagic) == NOFFMAGIC)) {
+    SwapHeader(&noffH);
+  }
+  if (noffH.noffMagic != NOFFMAGIC) {
+    DEBUG('u', "%s is not an executable\n", name);
+    delete executable;
+    return NULL;
+  }
+
+  ExecImage *image = new ExecImage(path);
+  image->numCodePages = divRoundUp(noffH.code.size, PageSize);
+  image->numDataPages = divRoundUp(noffH.initData.size, PageSize);
+  image->numUninitPages = divRoundUp(noffH.uninitData.size, PageSize);
+
+  // INFO: los segmentos van donde dice el header, y terminan dentro de
+  // las paginas del programa
+  int end = 0;
+  bool ok = noffH.code.size >= 0 && noffH.initData.size >= 0 &&
+            noffH.uninitData.size >= 0;
+  if (ok && noffH.code.size > 0)
+    end = noffH.code.virtualAddr + noffH.code.size;
+  if (ok && noffH.initData.size > 0 &&
+      noffH.initData.virtualAddr + noffH.initData.size > end)
+    end = noffH.initData.virtualAddr + noffH.initData.size;
+  ok = ok && noffH.code.virtualAddr >= 0 && noffH.initData.virtualAddr >= 0 &&
+       end <= image->NumPages() * PageSize;
+
+  if (ok) {
+    image->numFilePages = divRoundUp(end, PageSize);
+    image->contents = new char[image->numFilePages * PageSize + 1];
+    memset(image->contents, 0, image->numFilePages * PageSize);
+    if (noffH.code.size > 0)
+      executable->ReadAt(&image->contents[noffH.code.virtualAddr],
+                         noffH.code.size, noffH.code.inFileAddr);
+    if (noffH.initData.size > 0)
+      executable->ReadAt(&image->contents[noffH.initData.virtualAddr],
+                         noffH.initData.size, noffH.initData.inFileAddr);
+    DEBUG('u', "Executable %s: %d pages, %d from the file\n", name,
+          image->NumPages(), image->numFilePages);
+  } else {
+    DEBUG('u', "%s is not an executable\n", name);
+    delete image;
+    image = NULL;
+  }
+  delete executable; // close file
+  return image;
+}
@@ -0,0 +1,78 @@
+// execcache.h
+//	Data structures to keep the executables that user programs run
+//	in kernel memory.
+//
+//	Loading an executable means opening it, reading and checking its
+//	NOFF header, and reading its code and initialized data.  The
+//	cache does that once per executable, and keeps the result as an
+//	ExecImage: how many pages the program takes, and the initial
+//	contents of the ones the file fills in.  An Exec of a program
+//	that is in the cache (the shell running the same commands over
+//	and over) just copies those pages into the new address space.
+//
+//	Executables are known by their path, made absolute and without
+//	"." or ".." parts, so that every spelling of a file finds the same
+//	image (links are not followed).  Creating a file, or writing to a
+//	file opened with any of its names, drops its image, so the next
+//	Exec loads the program again.  The least recently used image
+//	goes when the cache is full.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef EXECCACHE_H
+#define EXECCACHE_H
+
+#include "copyright.h"
+
+// Executables the cache keeps at once
+const int MaxExecImages = 8;
+
+// A program ready to be copied into an address space
+
+class ExecImage {
+public:
+  char *name;         // as ExecCache::Get keys it
+  int numCodePages;   // as AddrSpace lays them out: code, initialized
+  int numDataPages;   // data, and uninitialized data, each rounded up
+  int numUninitPages; // to whole pages
+  int numFilePages;   // pages with contents from the file, from page 0
+  char *contents;     // numFilePages * PageSize bytes
+
+  int NumPages() { return numCodePages + numDataPages + numUninitPages; }
+
+private:
+  friend class ExecCache;
+  ExecImage(const char *whichName); // empty, see ExecCache::Load
+  ~ExecImage();                     // only through ExecCache::Release
+
+  int refs;      // address spaces being built from it, plus the cache
+  int lastUsed;  // for the LRU replacement
+  bool cached;   // still in the cache
+};
+
+// The executables cache
+
+class ExecCache {
+public:
+  ExecCache();  // empty
+  ~ExecCache(); // drop every image
+
+  // The image of executable "name", loaded if it is not cached; NULL
+  // if it can not be opened or is not a NOFF executable.  The caller
+  // gives it back with Release when the address space is built.
+  ExecImage *Get(const char *name);
+  void Release(ExecImage *image);
+
+  void Invalidate(const char *name); // the file changed
+
+private:
+  ExecImage *images[MaxExecImages]; // NULL if free
+  int clock;                        // Get calls, for lastUsed
+
+  ExecImage *Load(const char *name, const char *path); // read the executable
+  void Drop(int slot);               // take the image out of the cache
+};
+
+#endif // EXECCACHE_H
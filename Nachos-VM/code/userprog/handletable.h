@@ -0,0 +1,176 @@
+// handletable.h
+//	Data structures to give user programs handles for kernel objects.
+//
+//	A handle is a small integer that a user program passes back to
+//	the kernel to name an object (a semaphore, a lock, ...).  Like the
+//	process identifiers in the ProcessTable, a handle is the index of
+//	a slot in an array plus a generation counter in the high bits, so
+//	that looking it up takes constant time, slots are reused through a
+//	free list, and a stale handle to a destroyed object is refused
+//	instead of naming whatever object took over the slot.
+//
+//	The table only maps handles to objects; it neither creates nor
+//	deletes them, and it does no locking of its own.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HANDLETABLE_H
+#define HANDLETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// Number of bits of a handle used to index the table; the rest of the
+// bits, short of the sign, hold the generation of the slot.
+const int HandleSlotBits = 12;
+const int HandleSlotMask = (1 << HandleSlotBits) - 1;
+const int HandleGenerationMask = (1 << (31 - HandleSlotBits)) - 1;
+const int MaxHandles = 1 << HandleSlotBits;
+
+// Initial number of slots, it doubles as needed up to MaxHandles
+const int InitialNumHandles = 8;
+
+template <class T> class HandleTable {
+public:
+  HandleTable();  // empty table
+  ~HandleTable(); // de-allocate the table, not the objects
+
+  int Add(T *object);      // return a new handle, -1 if full
+  T *Lookup(int handle);   // NULL if not a valid handle
+  T *Remove(int handle);   // take the handle out, return its object
+  T *RemoveAny();          // take any handle out, NULL if empty
+
+  int NumHandles() { return numHandles; }
+
+private:
+  struct Slot {
+    T *object;      // NULL if free
+    int generation; // bumped every time the slot is freed
+    int nextFree;   // next free slot, -1 at the end
+  };
+
+  Slot *slots;    // grown by doubling
+  int size;       // slots allocated
+  int firstFree;  // head of the free list, -1 if none
+  int numHandles; // slots in use
+
+  bool Grow(); // double the size of the table
+};
+
+//----------------------------------------------------------------------
+// HandleTable<T>::HandleTable
+//	Initialize an empty table, every slot in the free list.
+//----------------------------------------------------------------------
+
+template <class T> HandleTable<T>::HandleTable() {
+  size = InitialNumHandles;
+  slots = new Slot[size];
+  for (int i = 0; i < size; i++) {
+    slots[i].object = NULL;
+    slots[i].generation = 0;
+    slots[i].nextFree = (i + 1 < size) ? i + 1 : -1;
+  }
+  firstFree = 0;
+  numHandles = 0;
+}
+
+template <class T> HandleTable<T>::~HandleTable() { delete[] slots; }
+
+//----------------------------------------------------------------------
+// HandleTable<T>::Grow
+//	Double the number of slots, up to MaxHandles.  Returns false if
+//	the table is already as big as it can be.
+//----------------------------------------------------------------------
+
+template <class T> bool HandleTable<T>::Grow() {
+  int newSize = (size * 2 > MaxHandles) ? MaxHandles : size * 2;
+
+  if (newSize <= size)
+    return false;
+
+  Slot *newSlots = new Slot[newSize];
+  for (int i = 0; i < size; i++)
+    newSlots[i] = slots[i];
+  for (int i = size; i < newSize; i++) {
+    newSlots[i].object = NULL;
+    newSlots[i].generation = 0;
+    newSlots[i].nextFree = (i + 1 < newSize) ? i + 1 : firstFree;
+  }
+  firstFree = size;
+  delete[] slots;
+  slots = newSlots;
+  size = newSize;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// HandleTable<T>::Add
+//	Give "object" a handle.  Returns -1 if there are no slots left.
+//----------------------------------------------------------------------
+
+template <class T> int HandleTable<T>::Add(T *object) {
+  ASSERT(object != NULL);
+  if (firstFree == -1 && !Grow())
+    return -1;
+
+  int slot = firstFree;
+  firstFree = slots[slot].nextFree;
+  slots[slot].object = object;
+  slots[slot].nextFree = -1;
+  numHandles++;
+  return (slots[slot].generation << HandleSlotBits) | slot;
+}
+
+//----------------------------------------------------------------------
+// HandleTable<T>::Lookup
+//	Return the object named by "handle".  The slot must be in use,
+//	and its generation must match the one in the handle.
+//----------------------------------------------------------------------
+
+template <class T> T *HandleTable<T>::Lookup(int handle) {
+  int slot = handle & HandleSlotMask;
+
+  if (handle < 0 || slot >= size)
+    return NULL;
+  if ((handle >> HandleSlotBits) != slots[slot].generation)
+    return NULL;
+  return slots[slot].object;
+}
+
+//----------------------------------------------------------------------
+// HandleTable<T>::Remove
+//	Free "handle", and return the object it named (NULL if the
+//	handle was not valid).
+//----------------------------------------------------------------------
+
+template <class T> T *HandleTable<T>::Remove(int handle) {
+  T *object = Lookup(handle);
+
+  if (object != NULL) {
+    int slot = handle & HandleSlotMask;
+    slots[slot].object = NULL;
+    slots[slot].generation =
+        (slots[slot].generation + 1) & HandleGenerationMask;
+    slots[slot].nextFree = firstFree;
+    firstFree = slot;
+    numHandles--;
+  }
+  return object;
+}
+
+//----------------------------------------------------------------------
+// HandleTable<T>::RemoveAny
+//	Free some handle in use, and return its object; NULL if there
+//	are none.  Used to tear the table down.
+//----------------------------------------------------------------------
+
+template <class T> T *HandleTable<T>::RemoveAny() {
+  for (int slot = 0; numHandles > 0 && slot < size; slot++)
+    if (slots[slot].object != NULL)
+      return Remove((slots[slot].generation << HandleSlotBits) | slot);
+  return NULL;
+}
+
+#endif // HANDLETABLE_H
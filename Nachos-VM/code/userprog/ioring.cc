@@ -0,0 +1,366 @@
+// ioring.cc
+//	Routines for the asynchronous I/O of user programs: the rings of
+//	each process, and the kernel thread that does the work.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "ioring.h"
+#include "copyright.h"
+#include "system.h"
+#include "usermem.h"
+
+// User addresses of the fields of the ring
+static int HeaderAddr(int ring, int field) { return ring + field * 4; }
+
+static int SubmissionAddr(int ring, int index) {
+  return ring + (IoRingHeaderWords +
+                 (index % IoRingEntries) * IoSubmissionWords) * 4;
+}
+
+static int CompletionAddr(int ring, int index) {
+  return ring + (IoRingHeaderWords + IoRingEntries * IoSubmissionWords +
+                 (index % IoRingEntries) * IoCompletionWords) * 4;
+}
+
+//----------------------------------------------------------------------
+// IoContext::IoContext
+// 	Initialize the asynchronous I/O of a process, whose IoRing is at
+//	user address "ringAddr".  The caller resets the indices of the
+//	ring.
+//----------------------------------------------------------------------
+
+IoContext::IoContext(int ringAddr) {
+  ring = ringAddr;
+  sqHead = cqTail = 0;
+  inFlight = 0;
+  completedHead = completedTail = NULL;
+  enterLock = new Lock("io enter");
+  completion = new Semaphore("io completion", 0);
+  waiting = released = false;
+}
+
+IoContext::~IoContext() {
+  while (completedHead != NULL) {
+    IoRequest *request = completedHead;
+    completedHead = request->next;
+    delete[] request->data;
+    delete request;
+  }
+  delete enterLock;
+  delete completion;
+}
+
+//----------------------------------------------------------------------
+// IoContext::Release
+// 	The process exited.  Completions not yet in the ring are thrown
+//	away; if the worker still has requests of ours, the last of them
+//	deletes the context.
+//----------------------------------------------------------------------
+
+void IoContext::Release() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  released = true;
+  if (inFlight == 0)
+    delete this;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// IoContext::Enter
+// 	Take up to "toSubmit" submissions out of the ring, and hand them
+//	to the worker.  Then post the completions that are ready, waiting
+//	for more until there are "minComplete" unread ones in the ring (or
+//	there is nothing left to wait for).
+//
+//	Returns the number of submissions taken, or -1 if the ring is not
+//	in the address space anymore.
+//----------------------------------------------------------------------
+
+int IoContext::Enter(int toSubmit, int minComplete) {
+  int sqTail, submitted = 0, unread = 0;
+
+  if (minComplete > IoRingEntries)
+    minComplete = IoRingEntries;
+
+  enterLock->Acquire();
+  if (!ReadUserWord(HeaderAddr(ring, IoRingSqTail), &sqTail)) {
+    enterLock->Release();
+    return -1;
+  }
+  for (; submitted < toSubmit && sqHead != sqTail; submitted++)
+    Submit(sqHead++);
+  if (!WriteUserWord(HeaderAddr(ring, IoRingSqHead), sqHead)) {
+    enterLock->Release();
+    return -1;
+  }
+
+  for (;;) {
+    unread = Reap();
+    if (unread < 0 || unread >= minComplete)
+      break;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    bool nothingLeft = (inFlight == 0 && completedHead == NULL);
+    if (!nothingLeft && completedHead == NULL) {
+      waiting = true;
+      completion->P();
+    }
+    (void)interrupt->SetLevel(oldLevel);
+    if (nothingLeft)
+      break;
+  }
+  enterLock->Release();
+  stats->numIoEnters++;
+  return unread < 0 ? -1 : submitted;
+}
+
+//----------------------------------------------------------------------
+// IoContext::Submit
+// 	Turn submission "index" of the ring into a request for the
+//	worker.  A submission that makes no sense, or that can not be
+//	read, completes right away, with -1.
+//----------------------------------------------------------------------
+
+void IoContext::Submit(int index) {
+  IoRequest *request = new IoRequest;
+  int addr = SubmissionAddr(ring, index);
+  int words[IoSubmissionWords];
+  bool ok = true;
+
+  for (int i = 0; i < IoSubmissionWords && ok; i++)
+    ok = ReadUserWord(addr + i * 4, &words[i]);
+  if (!ok) // WARN: no se usa nada de una entrada que no se pudo leer
+    for (int i = 0; i < IoSubmissionWords; i++)
+      words[i] = 0;
+
+  request->opcode = words[0];
+  request->file = NULL;
+  request->userBuffer = words[2];
+  request->size = words[3];
+  request->offset = words[4];
+  request->userData = words[5];
+  request->data = NULL;
+  request->result = -1;
+  request->owner = this;
+  request->next = NULL;
+
+  if (ok)
+    ok = (request->opcode == IO_NOP || request->opcode == IO_READ ||
+          request->opcode == IO_WRITE) &&
+         request->size >= 0 && request->size <= MaxUserIo &&
+         request->offset >= -1;
+  if (ok && request->opcode != IO_NOP) {
+    PCB *pcb = processTable->Lookup(currentThread->id);
+    request->file = (pcb != NULL && pcb->openFiles != NULL)
+                        ? pcb->openFiles->getFile(words[1])
+                        : NULL;
+    // WARN: el worker no puede quedarse esperando en un pipe
+    ok = request->file != NULL && request->file->pipe == NULL;
+  }
+  if (ok && request->opcode != IO_NOP) {
+    request->data = new char[request->size > 0 ? request->size : 1];
+    if (request->opcode == IO_WRITE)
+      ok = CopyFromUser(request->userBuffer, request->data, request->size);
+  }
+
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  stats->numIoRequests++;
+  if (!ok) {
+    request->file = NULL;
+    AddCompleted(request);
+  } else {
+    if (request->file != NULL)
+      request->file->AddRef(); // a Close meanwhile does not close it
+    inFlight++;
+    if (ioWorker == NULL)
+      ioWorker = new IoWorker();
+    ioWorker->Queue(request);
+  }
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// IoContext::Reap
+// 	Post the completed requests to the ring, as long as there is room
+//	for them, and copy out the data of the reads.  Returns the number
+//	of completions in the ring the program has not consumed yet, or
+//	-1 if the ring is not in the address space.
+//----------------------------------------------------------------------
+
+int IoContext::Reap() {
+  int cqHead;
+
+  if (!ReadUserWord(HeaderAddr(ring, IoRingCqHead), &cqHead))
+    return -1;
+  while (cqTail - cqHead < IoRingEntries) {
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    IoRequest *request = completedHead;
+    if (request != NULL) {
+      completedHead = request->next;
+      if (completedHead == NULL)
+        completedTail = NULL;
+    }
+    (void)interrupt->SetLevel(oldLevel);
+    if (request == NULL)
+      break;
+
+    if (request->opcode == IO_READ && request->result > 0 &&
+        !CopyToUser(request->userBuffer, request->data, request->result))
+      request->result = -1;
+    int addr = CompletionAddr(ring, cqTail);
+    bool ok = WriteUserWord(addr, request->userData) &&
+              WriteUserWord(addr + 4, request->result);
+    delete[] request->data;
+    delete request;
+    if (!ok)
+      return -1;
+    cqTail++;
+  }
+  if (!WriteUserWord(HeaderAddr(ring, IoRingCqTail), cqTail))
+    return -1;
+  return cqTail - cqHead;
+}
+
+//----------------------------------------------------------------------
+// IoContext::AddCompleted
+// 	Queue a finished request for the next Reap, and wake up the
+//	thread waiting for it.  Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void IoContext::AddCompleted(IoRequest *request) {
+  request->next = NULL;
+  if (completedTail != NULL)
+    completedTail->next = request;
+  else
+    completedHead = request;
+  completedTail = request;
+  if (waiting) {
+    waiting = false;
+    completion->V();
+  }
+}
+
+//----------------------------------------------------------------------
+// IoContext::Complete
+// 	The worker is done with "request".
+//----------------------------------------------------------------------
+
+void IoContext::Complete(IoRequest *request) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  inFlight--;
+  if (released) {
+    delete[] request->data;
+    delete request;
+    if (inFlight == 0)
+      delete this;
+  } else {
+    AddCompleted(request);
+  }
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// IoWorkerThread
+// 	Dummy function because C++ can't fork a member function.
+//----------------------------------------------------------------------
+
+static void IoWorkerThread(void *worker) { ((IoWorker *)worker)->Run(); }
+
+//----------------------------------------------------------------------
+// IoWorker::IoWorker
+// 	Start the kernel thread.  It sleeps until there is work, so it
+//	does not keep Nachos from halting.
+//----------------------------------------------------------------------
+
+IoWorker::IoWorker() {
+  queueHead = queueTail = NULL;
+  work = new Semaphore("io work", 0);
+  idle = false;
+  Thread *thread = new Thread("io worker");
+  thread->Fork(IoWorkerThread, this);
+}
+
+//----------------------------------------------------------------------
+// IoWorker::Queue
+// 	Add "request" to the work of the next batch.
+//----------------------------------------------------------------------
+
+void IoWorker::Queue(IoRequest *request) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  request->next = NULL;
+  if (queueTail != NULL)
+    queueTail->next = request;
+  else
+    queueHead = request;
+  queueTail = request;
+  if (idle) {
+    idle = false;
+    work->V();
+  }
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// IoWorker::Run
+// 	Take everything queued as a batch, carry it out in order, and
+//	complete each request to its process.  Then wait for more.
+//----------------------------------------------------------------------
+
+void IoWorker::Run() {
+  for (;;) {
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    while (queueHead == NULL) {
+      idle = true;
+      work->P();
+    }
+    IoRequest *batch = queueHead;
+    queueHead = queueTail = NULL;
+    (void)interrupt->SetLevel(oldLevel);
+
+    stats->numIoBatches++;
+    while (batch != NULL) {
+      IoRequest *request = batch;
+      batch = batch->next;
+      Perform(request);
+      request->owner->Complete(request);
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// IoWorker::Perform
+// 	Do the host I/O of "request", and let go of its file.
+//----------------------------------------------------------------------
+
+void IoWorker::Perform(IoRequest *request) {
+  char *buffers[1] = {request->data};
+  int sizes[1] = {request->size};
+
+  switch (request->opcode) {
+  case IO_READ:
+    request->result = ReadScatter(request->file->unixHandle, buffers, sizes, 1,
+                                  request->offset);
+    if (request->result > 0)
+      stats->numDiskReads += request->result;
+    break;
+  case IO_WRITE:
+    request->result = WriteGather(request->file->unixHandle, buffers, sizes,
+                                  1, request->offset);
+    if (request->result > 0) {
+      stats->numDiskWrites += request->result;
+      execCache->Invalidate(request->file->name);
+    }
+    break;
+  default:
+    request->result = 0;
+    break;
+  }
+  if (request->file != NULL)
+    request->file->DelRef();
+  DEBUG('q', "Operacion asincrona %d de %d bytes: %d\n", request->opcode,
+        request->size, request->result);
+}
@@ -0,0 +1,116 @@
+// ioring.h
+//	Data structures for the asynchronous I/O of user programs.
+//
+//	A user program keeps an IoRing (see syscall.h) in its own memory:
+//	a ring of submissions, that it fills, and a ring of completions,
+//	that the kernel fills.  A single IoEnter system call takes any
+//	number of submissions, and collects the completions that are
+//	ready, so that the cost of the trap is spread over many
+//	operations.
+//
+//	The operations themselves are carried out by a kernel thread, the
+//	IoWorker, while the program goes on running.  The worker takes
+//	everything submitted since it last looked, by any process, as a
+//	batch.  Since it has no address space, the worker never touches
+//	user memory: the data to write is copied into the kernel when the
+//	operation is submitted, and the data read is copied out to the
+//	program, along with the completion, by the next IoEnter.
+//
+//	The worker does the same host I/O on the open files as Read and
+//	Write do; like them, it takes no simulated disk time, so what the
+//	ring saves is the traps, not waiting for the disk.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef IORING_H
+#define IORING_H
+
+#include "copyright.h"
+#include "synch.h"
+#include "syscall.h"
+
+class IoContext;
+class NachosOpenFile;
+
+// Layout of an IoRing in user memory, in words
+const int IoRingSqHead = 0;
+const int IoRingSqTail = 1;
+const int IoRingCqHead = 2;
+const int IoRingCqTail = 3;
+const int IoRingHeaderWords = 4;
+const int IoSubmissionWords = 6;
+const int IoCompletionWords = 2;
+const int IoRingWords = IoRingHeaderWords +
+                        IoRingEntries * (IoSubmissionWords + IoCompletionWords);
+
+// One operation, from its submission until the program gets its
+// completion
+
+struct IoRequest {
+  int opcode;           // IO_NOP, IO_READ or IO_WRITE
+  NachosOpenFile *file; // referenced while the request is in flight
+  int offset;           // -1 for the current position
+  int userBuffer;       // where the program wants the data
+  char *data;           // kernel copy of the data
+  int size;
+  int userData;         // for the completion
+  int result;           // bytes transferred, or -1
+  IoContext *owner;     // whose ring gets the completion
+  IoRequest *next;      // in the worker queue, or the completed list
+};
+
+// The asynchronous I/O of one process
+
+class IoContext {
+public:
+  IoContext(int ringAddr); // the IoRing is at "ringAddr"
+
+  // Submit up to "toSubmit" operations, and wait for "minComplete"
+  // completions in the ring.  Must be called by a thread of the
+  // process, so that the ring is in the current address space.
+  int Enter(int toSubmit, int minComplete);
+
+  void Complete(IoRequest *request); // called by the worker
+  void Release(); // the process is gone; deleted once nothing is in flight
+
+private:
+  ~IoContext(); // only through Release or Complete
+
+  int ring;        // user address of the IoRing
+  int sqHead;      // next submission to take
+  int cqTail;      // next completion slot to fill
+  int inFlight;    // requests the worker has not finished
+  IoRequest *completedHead; // finished, not yet in the ring
+  IoRequest *completedTail;
+  Lock *enterLock;       // one IoEnter at a time
+  Semaphore *completion; // V'ed by the worker when "waiting"
+  bool waiting;
+  bool released;
+
+  void Submit(int index); // take submission "index" from the ring
+  int Reap();             // post completions, return how many are unread
+  void AddCompleted(IoRequest *request);
+};
+
+// The kernel thread that carries out the operations
+
+class IoWorker {
+public:
+  IoWorker(); // forks the thread
+
+  void Queue(IoRequest *request); // hand over an operation
+
+  void Run(); // body of the thread, never returns
+
+private:
+  IoRequest *queueHead; // submitted, not yet taken
+  IoRequest *queueTail;
+  Semaphore *work;      // V'ed when "idle" and something is queued
+  bool idle;
+
+  void Perform(IoRequest *request); // do the host I/O
+};
+
+#endif // IORING_H
@@ -0,0 +1,81 @@
+// mappedfile.cc
+//	Routines to move the pages of a mapped file between the file and
+//	physical memory.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "mappedfile.h"
+#include "copyright.h"
+#include "nachostablita.h"
+#include "system.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------------
+// MappedFile::MappedFile
+// 	Map "fileLength" bytes of "whichFile", from "fileOffset" on, at
+//	page "first" of an address space.  The mapping holds a reference
+//	to the open file, so that closing the descriptor does not close
+//	the file under it.
+//----------------------------------------------------------------------
+
+MappedFile::MappedFile(NachosOpenFile *whichFile, int fileOffset,
+                       int fileLength, int first) {
+  file = whichFile;
+  file->AddRef();
+  offset = fileOffset;
+  length = fileLength;
+  firstPage = first;
+  numPages = divRoundUp(length, PageSize);
+}
+
+MappedFile::~MappedFile() { file->DelRef(); }
+
+//----------------------------------------------------------------------
+// MappedFile::Load
+// 	Read "page" of the mapping from the file into "frame".  What is
+//	past the end of the file, or of the mapping, is zero.
+//----------------------------------------------------------------------
+
+void MappedFile::Load(int page, int frame) {
+  char *buffers[1] = {&machine->mainMemory[frame * PageSize]};
+  int sizes[1] = {PageSize};
+  int size = length - page * PageSize;
+
+  if (size < PageSize)
+    sizes[0] = size;
+  memset(buffers[0], 0, PageSize);
+  int done = ReadScatter(file->unixHandle, buffers, sizes, 1,
+                         offset + page * PageSize);
+  if (done > 0)
+    stats->numDiskReads += done;
+  stats->numMappedPagesIn++;
+  DEBUG('4', "\t-- ARCHIVO [%d] -> MEM[%d] (%d bytes)\n",
+        offset + page * PageSize, frame, done);
+}
+
+//----------------------------------------------------------------------
+// MappedFile::WriteBack
+// 	The program wrote to "page", that is in "frame": write the part
+//	of it that belongs to the file back to it.
+//----------------------------------------------------------------------
+
+void MappedFile::WriteBack(int page, int frame) {
+  char *buffers[1] = {&machine->mainMemory[frame * PageSize]};
+  int sizes[1] = {PageSize};
+  int size = length - page * PageSize;
+
+  if (size < PageSize)
+    sizes[0] = size;
+  int done = WriteGather(file->unixHandle, buffers, sizes, 1,
+                         offset + page * PageSize);
+  if (done > 0) {
+    stats->numDiskWrites += done;
+    execCache->Invalidate(file->name);
+  }
+  stats->numMappedPagesOut++;
+  DEBUG('4', "\t-- MEM[%d] -> ARCHIVO [%d] (%d bytes)\n", frame,
+        offset + page * PageSize, done);
+}
@@ -0,0 +1,48 @@
+// mappedfile.h
+//	Data structures for the files that user programs map into their
+//	address space, with Mmap.
+//
+//	The pages of a mapped file are in the page table from the start,
+//	but not valid: each one is read from the file on its first fault,
+//	straight into the frame it gets, so the program never copies the
+//	data through Read.  A page the program wrote to goes back to the
+//	file, not to swap, when it is evicted or unmapped; a clean page
+//	is just dropped, since the file still has it.
+//
+//	Only the first "length" bytes of the mapping belong to the file:
+//	the rest of the last page starts zeroed, and is never written
+//	back.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "copyright.h"
+
+class NachosOpenFile;
+
+// Files one address space can have mapped at once
+const int MaxMappedFiles = 8;
+
+// A range of a file, mapped at "firstPage" of an address space
+
+class MappedFile {
+public:
+  MappedFile(NachosOpenFile *whichFile, int fileOffset, int fileLength,
+             int first); // keeps a reference to the file
+  ~MappedFile();         // lets go of it
+
+  NachosOpenFile *file;
+  int offset;    // in the file, where the mapping begins
+  int length;    // bytes of the file mapped
+  int firstPage; // where the mapping begins in the address space
+  int numPages;
+
+  void Load(int page, int frame);      // read "page" into "frame"
+  void WriteBack(int page, int frame); // write "frame" back to the file
+};
+
+#endif // MAPPEDFILE_H
@@ -1,37 +1,297 @@
-#include "./nachostablita.h"
+// nachostablita.cc
+//	Routines to manage the open files of the user processes.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
 
-NachosOpenFilesTable::NachosOpenFilesTable() {
-  this->openFiles = new int[MaxOpenFiles];
-  this->openFilesMap = new BitMap(MaxOpenFiles);
-  this->usage = 0;
+#include "nachostablita.h"
+#include "copyright.h"
+#include "pipe.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// NachosOpenFile::NachosOpenFile
+// 	Keep track of the Unix file "whichUnixHandle", opened as
+//	"whichName", referred to by a single descriptor for now.
+//----------------------------------------------------------------------
+
+NachosOpenFile::NachosOpenFile(int whichUnixHandle, const char *whichName) {
+  unixHandle = whichUnixHandle;
+  name = new char[strlen(whichName) + 1];
+  strcpy(name, whichName);
+  pipe = NULL;
+  writeEnd = false;
+  refs = 1;
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFile::NachosOpenFile
+// 	Keep track of the read or write end of "whichPipe".
+//----------------------------------------------------------------------
+
+NachosOpenFile::NachosOpenFile(NachosPipe *whichPipe, bool isWriteEnd) {
+  unixHandle = -1;
+  name = NULL;
+  pipe = whichPipe;
+  writeEnd = isWriteEnd;
+  refs = 1;
+}
+
+NachosOpenFile::~NachosOpenFile() {
+  if (pipe == NULL)
+    Close(unixHandle);
+  else if (writeEnd)
+    pipe->CloseWrite();
+  else
+    pipe->CloseRead();
+  delete[] name;
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFile::AddRef, DelRef
+// 	Count the descriptors that refer to the file.  The file can be
+//	shared by several processes, so interrupts are disabled.
+//----------------------------------------------------------------------
+
+void NachosOpenFile::AddRef() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  refs++;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+void NachosOpenFile::DelRef() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  ASSERT(refs > 0);
+  if (--refs == 0)
+    delete this;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::NachosOpenFilesTable
+// 	Initialize a table without open files.
+//----------------------------------------------------------------------
+
+NachosOpenFilesTable::NachosOpenFilesTable() { Init(InitialOpenFiles); }
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::NachosOpenFilesTable
+// 	Initialize the table of a process started by Exec: the same
+//	descriptors as its parent's table, sharing the open files.  This
+//	is how the console of a process can be a pipe.
+//----------------------------------------------------------------------
+
+NachosOpenFilesTable::NachosOpenFilesTable(NachosOpenFilesTable *parent) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  Init(parent->size);
+  firstFree = -1;
+  for (int fd = size - 1; fd >= 0; fd--) {
+    openFiles[fd] = parent->openFiles[fd];
+    if (openFiles[fd] != NULL) {
+      openFiles[fd]->AddRef();
+      nextFree[fd] = -1;
+      numOpen++;
+    } else if (fd >= FirstFileDescriptor) {
+      nextFree[fd] = firstFree;
+      firstFree = fd;
+    }
+  }
+  (void)interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::~NachosOpenFilesTable
+// 	The process finished: close the files it left open.
+//----------------------------------------------------------------------
+
 NachosOpenFilesTable::~NachosOpenFilesTable() {
-  delete this->openFiles;
-  delete this->openFilesMap;
+  for (int fd = 0; numOpen > 0 && fd < size; fd++)
+    if (openFiles[fd] != NULL)
+      Close(fd);
+  delete[] openFiles;
+  delete[] nextFree;
 }
-int NachosOpenFilesTable::Open(int UnixHandle) {
-  int position = this->openFilesMap->Find();
-  this->openFiles[position] = UnixHandle;
-  return position;
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Init
+// 	Allocate "initialSize" descriptors, all of them free except the
+//	ones of the console.
+//----------------------------------------------------------------------
+
+void NachosOpenFilesTable::Init(int initialSize) {
+  size = initialSize;
+  openFiles = new NachosOpenFile *[size];
+  nextFree = new int[size];
+  for (int fd = 0; fd < size; fd++) {
+    openFiles[fd] = NULL;
+    nextFree[fd] = (fd + 1 < size) ? fd + 1 : -1;
+  }
+  nextFree[FirstFileDescriptor - 1] = -1;
+  firstFree = FirstFileDescriptor;
+  numOpen = 0;
 }
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Grow
+// 	Double the number of descriptors, up to MaxOpenFiles.  Returns
+//	false if the table is already as big as it can be.
+//----------------------------------------------------------------------
+
+bool NachosOpenFilesTable::Grow() {
+  int newSize = (size * 2 > MaxOpenFiles) ? MaxOpenFiles : size * 2;
+
+  if (newSize <= size)
+    return false;
+
+  NachosOpenFile **newFiles = new NachosOpenFile *[newSize];
+  int *newNext = new int[newSize];
+  for (int fd = 0; fd < size; fd++) {
+    newFiles[fd] = openFiles[fd];
+    newNext[fd] = nextFree[fd];
+  }
+  for (int fd = size; fd < newSize; fd++) {
+    newFiles[fd] = NULL;
+    newNext[fd] = (fd + 1 < newSize) ? fd + 1 : firstFree;
+  }
+  firstFree = size;
+  delete[] openFiles;
+  delete[] nextFree;
+  openFiles = newFiles;
+  nextFree = newNext;
+  size = newSize;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Open
+// 	Give the Unix file "UnixHandle", opened as "name", a descriptor.
+//	Returns -1 if the process has too many open files; the Unix file
+//	is left open.
+//----------------------------------------------------------------------
+
+int NachosOpenFilesTable::Open(int UnixHandle, const char *name) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  int fd = -1;
+
+  if (firstFree != -1 || Grow())
+    fd = Open(new NachosOpenFile(UnixHandle, name));
+  (void)interrupt->SetLevel(oldLevel);
+  return fd;
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Open
+// 	Give "file" a descriptor, that takes over the reference of the
+//	caller.  Returns -1 if the process has too many open files; the
+//	reference is then still the caller's.
+//----------------------------------------------------------------------
+
+int NachosOpenFilesTable::Open(NachosOpenFile *file) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  int fd = -1;
+
+  if (firstFree != -1 || Grow()) {
+    fd = firstFree;
+    firstFree = nextFree[fd];
+    nextFree[fd] = -1;
+    openFiles[fd] = file;
+    numOpen++;
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  return fd;
+}
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Close
+// 	Free the descriptor "NachosHandle".  The Unix file is closed if
+//	no other descriptor refers to it.  Returns -1 if the descriptor
+//	was not open.
+//
+//	A redirected console descriptor goes back to the console; it
+//	never goes into the free list.
+//----------------------------------------------------------------------
+
 int NachosOpenFilesTable::Close(int NachosHandle) {
-  this->openFilesMap->Clear(NachosHandle);
-  return this->openFiles[NachosHandle];
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  if (!isOpened(NachosHandle)) {
+    (void)interrupt->SetLevel(oldLevel);
+    return -1;
+  }
+  NachosOpenFile *file = openFiles[NachosHandle];
+  openFiles[NachosHandle] = NULL;
+  if (NachosHandle >= FirstFileDescriptor) {
+    nextFree[NachosHandle] = firstFree;
+    firstFree = NachosHandle;
+  }
+  numOpen--;
+  file->DelRef();
+  (void)interrupt->SetLevel(oldLevel);
+  return 0;
 }
+
+//----------------------------------------------------------------------
+// NachosOpenFilesTable::Dup2
+// 	Make "newHandle" refer to the file of "NachosHandle", closing
+//	whatever it referred to before.  A console descriptor can be
+//	"newHandle", to redirect it.  Returns "newHandle", or -1 if
+//	"NachosHandle" is not open or "newHandle" is out of range.
+//----------------------------------------------------------------------
+
+int NachosOpenFilesTable::Dup2(int NachosHandle, int newHandle) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  if (!isOpened(NachosHandle) || newHandle < 0 || newHandle >= MaxOpenFiles) {
+    (void)interrupt->SetLevel(oldLevel);
+    return -1;
+  }
+  if (newHandle != NachosHandle) {
+    while (newHandle >= size)
+      Grow();
+    NachosOpenFile *file = openFiles[NachosHandle];
+    file->AddRef();
+    Close(newHandle); // si no estaba abierto, no pasa nada
+    if (newHandle >= FirstFileDescriptor) {
+      // INFO: se saca de la lista de libres, donde sea que este
+      int *link = &firstFree;
+      while (*link != newHandle)
+        link = &nextFree[*link];
+      *link = nextFree[newHandle];
+      nextFree[newHandle] = -1;
+    }
+    openFiles[newHandle] = file;
+    numOpen++;
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  return newHandle;
+}
+
 bool NachosOpenFilesTable::isOpened(int NachosHandle) {
-  return this->openFilesMap->Test(NachosHandle);
+  return NachosHandle >= 0 && NachosHandle < size &&
+         openFiles[NachosHandle] != NULL;
 }
+
 int NachosOpenFilesTable::getUnixHandle(int NachosHandle) {
-  return this->openFiles[NachosHandle];
+  return isOpened(NachosHandle) ? openFiles[NachosHandle]->unixHandle : -1;
 }
-void NachosOpenFilesTable::addThread() { usage++; }
-void NachosOpenFilesTable::delThread() { usage--; }
+
+NachosOpenFile *NachosOpenFilesTable::getFile(int NachosHandle) {
+  return isOpened(NachosHandle) ? openFiles[NachosHandle] : NULL;
+}
+
 void NachosOpenFilesTable::Print() {
-  int cantOpenFile = this->openFilesMap->NumClear() - MaxOpenFiles;
-  for (int file = 0; file < cantOpenFile; file++) {
-    printf("UnixHandle: %i |  NachOsHandle %i | Open: %s",
-           this->openFiles[file], file,
-           this->openFilesMap->Test(file) ? "true" : "false");
+  printf("Open files: %d of %d descriptors\n", numOpen, size);
+  for (int fd = 0; fd < size; fd++) {
+    if (openFiles[fd] == NULL)
+      continue;
+    if (openFiles[fd]->pipe != NULL)
+      printf("  NachOsHandle %d | %s end of pipe %p\n", fd,
+             openFiles[fd]->writeEnd ? "write" : "read",
+             (void *)openFiles[fd]->pipe);
+    else
+      printf("  NachOsHandle %d | UnixHandle %d\n", fd,
+             openFiles[fd]->unixHandle);
   }
 }
@@ -1,26 +1,104 @@
-#pragma once
+// nachostablita.h
+//	Data structures to keep track of the files opened by user
+//	processes.
+//
+//	Every process has its own table of descriptors, kept in its PCB
+//	and shared by all of its threads.  A descriptor names an open
+//	Unix file, or an end of a pipe.  The first ones (ConsoleInput,
+//	ConsoleOutput and ConsoleError) name the console, unless Dup2
+//	redirects them to an open file; closing them then goes back to
+//	the console.
+//
+//	A process started with Exec inherits the descriptors of its
+//	parent, which then share the open files: each open file counts
+//	how many descriptors refer to it, and the Unix file is only
+//	closed with the last of them.  When the last thread of a process
+//	exits, the descriptors it did not close are closed for it.
+//
+//	Descriptors are taken from a free list, so that opening and
+//	closing a file take constant time, and the table doubles as
+//	needed up to MaxOpenFiles.  Only Dup2, that asks for a given
+//	descriptor, has to look for it in the list.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
 
-#include "bitmap.h"
+#ifndef NACHOSTABLITA_H
+#define NACHOSTABLITA_H
+
+#include "copyright.h"
+
+class NachosPipe;
 
 // Igual que en linux
 const int MaxOpenFiles = 1024;
 
+// Descriptors below this one belong to the console
+const int FirstFileDescriptor = 3;
+
+// Initial number of descriptors, it doubles as needed
+const int InitialOpenFiles = 16;
+
+// An open Unix file or pipe end, shared by the descriptors that refer
+// to it
+
+class NachosOpenFile {
+public:
+  NachosOpenFile(int whichUnixHandle, const char *whichName); // one
+                                                             // reference
+  NachosOpenFile(NachosPipe *whichPipe, bool isWriteEnd); // an end of a pipe
+
+  int unixHandle; // Unix file descriptor, -1 for a pipe
+  char *name;     // what it was opened as, NULL for a pipe
+  NachosPipe *pipe;     // NULL for a Unix file
+  bool writeEnd;  // which end of "pipe"
+
+  void AddRef();  // one more descriptor refers to the file
+  void DelRef();  // one less; close and delete it after the last
+
+private:
+  ~NachosOpenFile(); // only through DelRef
+  int refs;
+};
+
+// The descriptors of one process.  Like the ProcessTable, every
+// operation runs with interrupts disabled.
+
 class NachosOpenFilesTable {
 public:
-  NachosOpenFilesTable();  // Initialize
-  ~NachosOpenFilesTable(); // De-allocate
+  NachosOpenFilesTable(); // no files open
+  NachosOpenFilesTable(NachosOpenFilesTable *parent); // for Exec, share
+                                                       // the parent's files
+  ~NachosOpenFilesTable(); // close every file left
 
-  int Open(int UnixHandle);    // Register the file handle
-  int Close(int NachosHandle); // Unregister the file handle
+  int Open(int UnixHandle, const char *name); // Register the file handle
+                                              // opened as "name", -1 if
+                                              // full
+  int Open(NachosOpenFile *file); // Register "file", taking its reference
+                                  // (left alone if full, -1)
+  int Close(int NachosHandle); // Unregister the file handle, -1 if not open
+  int Dup2(int NachosHandle, int newHandle); // make "newHandle" refer to
+                                             // the same file, -1 if not
+                                             // possible
   bool isOpened(int NachosHandle);
-  int getUnixHandle(int NachosHandle);
-  void addThread(); // If a user thread is using this table, add it
-  void delThread(); // If a user thread is using this table, delete it
+  int getUnixHandle(int NachosHandle); // -1 if not open
+  NachosOpenFile *getFile(int NachosHandle); // NULL if not open
 
+  int NumOpen() { return numOpen; }
   void Print(); // Print contents
 
 private:
-  int *openFiles;       // A vector with user opened files
-  BitMap *openFilesMap; // A bitmap to control our vector
-  int usage;            // How many threads are using this table
+  NachosOpenFile **openFiles; // A vector with user opened files, NULL
+                              // if the descriptor is free
+  int *nextFree;              // next free descriptor, -1 at the end
+  int size;                   // descriptors allocated
+  int firstFree;              // head of the free list, -1 if none
+  int numOpen;                // descriptors in use, redirected console
+                              // ones included
+
+  void Init(int initialSize); // empty table
+  bool Grow();                // double the size of the table
 };
+
+#endif // NACHOSTABLITA_H
@@ -0,0 +1,184 @@
+// pipe.cc
+//	Routines for the pipes between user processes.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "pipe.h"
+#include "copyright.h"
+#include "system.h"
+#include "usermem.h"
+#include <cstring>
+
+//----------------------------------------------------------------------
+// NachosPipe::NachosPipe
+// 	Initialize an empty pipe, with both ends open.
+//----------------------------------------------------------------------
+
+NachosPipe::NachosPipe() {
+  lock = new Lock("pipe");
+  writeLock = new Lock("pipe write");
+  dataAvail = new Condition("pipe data");
+  roomAvail = new Condition("pipe room");
+  head = count = 0;
+  readOpen = writeOpen = true;
+}
+
+NachosPipe::~NachosPipe() {
+  delete lock;
+  delete writeLock;
+  delete dataAvail;
+  delete roomAvail;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::TakeSpan
+// 	Move the next "size" bytes of the ring to "span", a piece of user
+//	memory; the caller made sure there are that many.
+//----------------------------------------------------------------------
+
+bool NachosPipe::TakeSpan(char *span, int size, void *arg) {
+  NachosPipe *pipe = (NachosPipe *)arg;
+
+  while (size > 0) {
+    int n = PipeBufferSize - pipe->head;
+    if (n > size)
+      n = size;
+    memcpy(span, pipe->buffer + pipe->head, n);
+    pipe->head = (pipe->head + n) % PipeBufferSize;
+    pipe->count -= n;
+    span += n;
+    size -= n;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::PutSpan
+// 	Move "size" bytes of "span", a piece of user memory, to the end
+//	of the ring; the caller made sure there is room.
+//----------------------------------------------------------------------
+
+bool NachosPipe::PutSpan(char *span, int size, void *arg) {
+  NachosPipe *pipe = (NachosPipe *)arg;
+
+  while (size > 0) {
+    int tail = (pipe->head + pipe->count) % PipeBufferSize;
+    int n = PipeBufferSize - tail;
+    if (n > size)
+      n = size;
+    memcpy(pipe->buffer + tail, span, n);
+    pipe->count += n;
+    span += n;
+    size -= n;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::ReadV
+// 	Wait until there is data, or no writer left, and move what there
+//	is, up to the total size of the "pieces", to user memory, filling
+//	one piece before the next.  It only waits once, so a piece that
+//	gets less than its size is the last one with data.
+//----------------------------------------------------------------------
+
+int NachosPipe::ReadV(int *userAddrs, int *sizes, int pieces) {
+  int size = 0, done = 0;
+
+  for (int i = 0; i < pieces; i++)
+    size += sizes[i];
+  lock->Acquire();
+  while (count == 0 && writeOpen && size > 0)
+    dataAvail->Wait(lock);
+  int left = count < size ? count : size;
+  for (int i = 0; i < pieces && left > 0; i++) {
+    int n = left < sizes[i] ? left : sizes[i];
+    if (!ForEachUserSpan(userAddrs[i], n, true, TakeSpan, this)) {
+      done = -1; // WARN: lo que se alcanzo a copiar se pierde
+      break;
+    }
+    done += n;
+    left -= n;
+  }
+  roomAvail->Broadcast(lock);
+  lock->Release();
+  return done;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::WriteV
+// 	Move the "pieces" to the ring, in order, as room frees up.
+//	Holding "writeLock" all along keeps other writers from getting in
+//	between, also between two pieces.
+//----------------------------------------------------------------------
+
+int NachosPipe::WriteV(int *userAddrs, int *sizes, int pieces) {
+  int size = 0, done = 0;
+
+  for (int i = 0; i < pieces; i++)
+    size += sizes[i];
+  writeLock->Acquire();
+  lock->Acquire();
+  for (int i = 0; i < pieces; i++) {
+    int n = Put(userAddrs[i], sizes[i]);
+    done += n;
+    if (n < sizes[i])
+      break;
+  }
+  lock->Release();
+  writeLock->Release();
+  stats->numPipeBytes += done;
+  return (done == 0 && size > 0) ? -1 : done;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::Put
+// 	Move "size" bytes of user memory to the ring, waiting for room as
+//	needed.  Returns how many got in before the read end was closed
+//	or the buffer turned out not to be in the address space; the
+//	pages of a bad stretch that were already copied are taken back
+//	out, so readers get exactly what Write reports.
+//----------------------------------------------------------------------
+
+int NachosPipe::Put(int userAddr, int size) {
+  int done = 0;
+
+  while (done < size && readOpen) {
+    while (count == PipeBufferSize && readOpen)
+      roomAvail->Wait(lock);
+    if (!readOpen)
+      break;
+    int n = PipeBufferSize - count, before = count;
+    if (n > size - done)
+      n = size - done;
+    if (!ForEachUserSpan(userAddr + done, n, false, PutSpan, this)) {
+      count = before; // INFO: lo copiado de esta vuelta no se cuenta
+      break;
+    }
+    done += n;
+    dataAvail->Broadcast(lock);
+  }
+  return done;
+}
+
+//----------------------------------------------------------------------
+// NachosPipe::CloseRead, CloseWrite
+// 	Close an end, waking up whoever waits on the other one.
+//----------------------------------------------------------------------
+
+void NachosPipe::CloseRead() { Close(&readOpen); }
+
+void NachosPipe::CloseWrite() { Close(&writeOpen); }
+
+void NachosPipe::Close(bool *end) {
+  lock->Acquire();
+  *end = false;
+  dataAvail->Broadcast(lock);
+  roomAvail->Broadcast(lock);
+  bool last = !readOpen && !writeOpen;
+  lock->Release();
+  if (last)
+    delete this;
+}
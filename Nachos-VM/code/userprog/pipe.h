@@ -0,0 +1,75 @@
+// pipe.h
+//	Data structures for the pipes that connect user processes.
+//
+//	A pipe is a ring buffer in the kernel, with a read end and a write
+//	end.  Each end is an open file (see nachostablita.h), so that it
+//	can be inherited by Exec, duplicated and closed like any other.
+//
+//	A Read waits until there is something in the buffer, and returns
+//	what is there, up to the size asked for; it only returns 0 once
+//	the buffer is empty and the write end is closed.  A Write waits
+//	for room as needed, until all of its data is in the buffer; the
+//	data of one Write is never mixed with another's.  Writing once
+//	the read end is closed fails.  ReadV and WriteV do the same for
+//	several pieces of user memory at once, in order.
+//
+//	Data moves straight between the ring and user memory, a page at
+//	a time, without another copy in the kernel.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "copyright.h"
+#include "synch.h"
+
+// Size of the ring buffer of a pipe
+const int PipeBufferSize = 1024;
+
+class NachosPipe {
+public:
+  NachosPipe(); // both ends open, nothing in it
+
+  // Move up to "size" bytes from the pipe to user address "userAddr",
+  // waiting for some.  Returns the bytes read, 0 at the end of the
+  // data, or -1 if the buffer is not in the address space.
+  int Read(int userAddr, int size) { return ReadV(&userAddr, &size, 1); }
+  int ReadV(int *userAddrs, int *sizes, int pieces);
+
+  // Move "size" bytes at user address "userAddr" into the pipe,
+  // waiting for room.  Returns the bytes written, less than "size" (or
+  // -1, if none) if the read end was closed or the buffer is not in
+  // the address space.
+  int Write(int userAddr, int size) { return WriteV(&userAddr, &size, 1); }
+  int WriteV(int *userAddrs, int *sizes, int pieces);
+
+  // The last descriptor of an end is gone.  The pipe is deleted with
+  // the second end.
+  void CloseRead();
+  void CloseWrite();
+
+private:
+  ~NachosPipe(); // only through CloseRead and CloseWrite
+
+  Lock *lock;           // protects the buffer and the ends
+  Lock *writeLock;      // one Write at a time
+  Condition *dataAvail; // something was written, or the write end closed
+  Condition *roomAvail; // something was read, or the read end closed
+
+  char buffer[PipeBufferSize];
+  int head;  // next byte to read
+  int count; // bytes in "buffer"
+  bool readOpen;
+  bool writeOpen;
+
+  // Copy to or from a piece of user memory, for ForEachUserSpan
+  static bool TakeSpan(char *span, int size, void *pipe);
+  static bool PutSpan(char *span, int size, void *pipe);
+  int Put(int userAddr, int size); // one piece of a WriteV, "lock" held
+  void Close(bool *end); // mark "end" closed, delete with the second
+};
+
+#endif // PIPE_H
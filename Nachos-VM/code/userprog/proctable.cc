@@ -0,0 +1,364 @@
+// proctable.cc
+//	Routines to manage the table of process control blocks.
+//
+//	Slots are handed out from a free list, and the parent/child
+//	relationship is kept with doubly linked sibling lists, so that no
+//	operation needs to scan the table.  Every routine turns interrupts
+//	off while it touches the table, since the system call handlers of
+//	several threads can be interleaved by the timer.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "proctable.h"
+#include "copyright.h"
+#include "ioring.h"
+#include "nachostablita.h"
+#include "system.h"
+#include "usersync.h"
+
+//----------------------------------------------------------------------
+// PCB::PCB
+// 	Initialize a free process control block.
+//
+//	"whichSlot" is the position of the PCB in the process table.
+//----------------------------------------------------------------------
+
+PCB::PCB(int whichSlot) {
+  slot = whichSlot;
+  id = whichSlot;
+  generation = 0;
+  status = PROCESS_FREE;
+  thread = NULL;
+  space = NULL;
+  openFiles = NULL;
+  syncObjects = NULL;
+  ioContext = NULL;
+  numThreads = 0;
+  parent = firstChild = nextSibling = prevSibling = NULL;
+  exitStatus = 0;
+  joiners = 0;
+  exited = new Semaphore("process exited", 0);
+  nextFree = -1;
+  startTicks = exitTicks = numSyscalls = 0;
+}
+
+PCB::~PCB() {
+  if (ioContext != NULL)
+    ioContext->Release();
+  delete openFiles;
+  delete syncObjects;
+  delete exited;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+// 	Initialize an empty process table, all the slots are in the
+//	free list.
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable() {
+  size = InitialNumProcesses;
+  table = new PCB *[size];
+  for (int i = 0; i < size; i++) {
+    table[i] = new PCB(i);
+    table[i]->nextFree = (i + 1 < size) ? i + 1 : -1;
+  }
+  firstFree = 0;
+  numProcesses = 0;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::~ProcessTable
+// 	De-allocate the process table.
+//----------------------------------------------------------------------
+
+ProcessTable::~ProcessTable() {
+  for (int i = 0; i < size; i++)
+    delete table[i];
+  delete[] table;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Grow
+// 	Double the number of slots in the table, up to MaxNumProcesses.
+//	Only the array of pointers is copied, so the PCBs already handed
+//	out stay where they are.
+//
+//	Returns false if the table is already as big as it can be.
+//----------------------------------------------------------------------
+
+bool ProcessTable::Grow() {
+  int newSize = size * 2;
+
+  if (newSize > MaxNumProcesses)
+    newSize = MaxNumProcesses;
+  if (newSize <= size)
+    return false;
+
+  PCB **newTable = new PCB *[newSize];
+  for (int i = 0; i < size; i++)
+    newTable[i] = table[i];
+  for (int i = size; i < newSize; i++) {
+    newTable[i] = new PCB(i);
+    newTable[i]->nextFree = (i + 1 < newSize) ? i + 1 : firstFree;
+  }
+  firstFree = size;
+  delete[] table;
+  table = newTable;
+  size = newSize;
+  DEBUG('u', "Process table grown to %d slots\n", size);
+  return true;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Create
+// 	Take a free slot for a new process, run by "thread".  The thread
+//	gets the identifier of the process, and the process inherits the
+//	open files of its parent.
+//
+//	"parent" is the process doing the Exec, or NULL for the first
+//	program.  Returns NULL if there are no slots left.
+//----------------------------------------------------------------------
+
+PCB *ProcessTable::Create(Thread *thread, PCB *parent) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  if (firstFree == -1 && !Grow()) {
+    (void)interrupt->SetLevel(oldLevel);
+    return NULL;
+  }
+
+  PCB *pcb = table[firstFree];
+  firstFree = pcb->nextFree;
+  numProcesses++;
+
+  pcb->nextFree = -1;
+  pcb->id = (pcb->generation << ProcessSlotBits) | pcb->slot;
+  pcb->status = PROCESS_RUNNING;
+  pcb->thread = thread;
+  pcb->space = NULL;
+  pcb->openFiles = (parent != NULL && parent->openFiles != NULL)
+                       ? new NachosOpenFilesTable(parent->openFiles)
+                       : new NachosOpenFilesTable();
+  pcb->syncObjects = NULL;
+  pcb->ioContext = NULL;
+  pcb->numThreads = 1;
+  pcb->exitStatus = 0;
+  pcb->joiners = 0;
+  pcb->firstChild = NULL;
+  pcb->startTicks = stats->totalTicks;
+  pcb->exitTicks = 0;
+  pcb->numSyscalls = 0;
+
+  pcb->parent = parent;
+  pcb->prevSibling = NULL;
+  pcb->nextSibling = NULL;
+  if (parent != NULL) {
+    pcb->nextSibling = parent->firstChild;
+    if (parent->firstChild != NULL)
+      parent->firstChild->prevSibling = pcb;
+    parent->firstChild = pcb;
+  }
+  if (thread != NULL)
+    thread->id = pcb->id;
+
+  (void)interrupt->SetLevel(oldLevel);
+  DEBUG('u', "Created process %d (slot %d), parent %d\n", pcb->id, pcb->slot,
+        parent != NULL ? parent->id : -1);
+  return pcb;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Lookup
+// 	Find the PCB of process "id".  The slot must be in use, and
+//	its generation must match the one in the identifier.
+//----------------------------------------------------------------------
+
+PCB *ProcessTable::Lookup(SpaceId id) {
+  int slot = id & ProcessSlotMask;
+
+  if (id < 0 || slot >= size)
+    return NULL;
+  PCB *pcb = table[slot];
+  if (pcb->status == PROCESS_FREE || pcb->id != id)
+    return NULL;
+  return pcb;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::AddThread
+// 	A new thread runs inside process "pcb", the process will not
+//	finish until this thread also calls Exit.
+//----------------------------------------------------------------------
+
+void ProcessTable::AddThread(PCB *pcb) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  pcb->numThreads++;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Exit
+// 	One of the threads of "pcb" finished.  If it was the last one,
+//	record the exit status, close its files, drop its asynchronous
+//	I/O, destroy its synchronization objects, wake up every thread
+//	waiting in Join, and
+//	let go of the children (they will be freed as soon as they exit,
+//	since nobody can join them now).
+//
+//	If it was the thread that started the process, but others are
+//	left, the process is done with its status: its synchronization
+//	objects are destroyed, so that the threads waiting on them wake
+//	up (their system calls fail) and get to Exit too.
+//----------------------------------------------------------------------
+
+bool ProcessTable::Exit(PCB *pcb, int status) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  ASSERT(pcb->status == PROCESS_RUNNING && pcb->numThreads > 0);
+  if (--pcb->numThreads > 0) {
+    if (currentThread == pcb->thread) {
+      pcb->thread = NULL;
+      pcb->exitStatus = status;
+      delete pcb->syncObjects; // wakes up whoever waits on them
+      pcb->syncObjects = NULL;
+    }
+    (void)interrupt->SetLevel(oldLevel);
+    return false;
+  }
+
+  pcb->status = PROCESS_ZOMBIE;
+  if (pcb->thread != NULL) // INFO: si no, ya vale lo del hilo principal
+    pcb->exitStatus = status;
+  pcb->exitTicks = stats->totalTicks;
+  pcb->thread = NULL;
+  pcb->space = NULL;
+  if (pcb->ioContext != NULL) // freed once the worker is done with it
+    pcb->ioContext->Release();
+  pcb->ioContext = NULL;
+  delete pcb->openFiles;   // closes whatever the process left open
+  pcb->openFiles = NULL;
+  delete pcb->syncObjects; // destroys whatever the process left
+  pcb->syncObjects = NULL;
+  DEBUG('u', "Process %d exited with status %d after %d ticks\n", pcb->id,
+        pcb->exitStatus, pcb->exitTicks - pcb->startTicks);
+
+  for (int i = 0; i < pcb->joiners; i++)
+    pcb->exited->V();
+
+  PCB *child = pcb->firstChild;
+  while (child != NULL) {
+    PCB *next = child->nextSibling;
+    child->parent = NULL;
+    child->nextSibling = child->prevSibling = NULL;
+    MaybeFree(child);
+    child = next;
+  }
+  pcb->firstChild = NULL;
+
+  MaybeFree(pcb);
+  (void)interrupt->SetLevel(oldLevel);
+  return true;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Join
+// 	Wait for process "id" to finish, and return its exit status.
+//	When the parent joins a child, the child is reaped and its slot
+//	can be reused.  A process can not join itself: it would wait
+//	forever.
+//----------------------------------------------------------------------
+
+int ProcessTable::Join(SpaceId id) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  PCB *pcb = Lookup(id);
+
+  if (pcb == NULL || id == currentThread->id) {
+    (void)interrupt->SetLevel(oldLevel);
+    return -1;
+  }
+
+  if (pcb->status == PROCESS_RUNNING) {
+    pcb->joiners++;
+    pcb->exited->P();
+    pcb->joiners--;
+  }
+  int status = pcb->exitStatus;
+
+  if (pcb->parent != NULL && pcb->parent->id == currentThread->id) {
+    Unlink(pcb);
+  }
+  MaybeFree(pcb);
+
+  (void)interrupt->SetLevel(oldLevel);
+  return status;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Unlink
+// 	Remove "child" from the list of children of its parent.  After
+//	this, nobody is going to reap it.
+//----------------------------------------------------------------------
+
+void ProcessTable::Unlink(PCB *child) {
+  PCB *parent = child->parent;
+
+  if (child->prevSibling != NULL)
+    child->prevSibling->nextSibling = child->nextSibling;
+  else
+    parent->firstChild = child->nextSibling;
+  if (child->nextSibling != NULL)
+    child->nextSibling->prevSibling = child->prevSibling;
+  child->parent = child->nextSibling = child->prevSibling = NULL;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::MaybeFree
+// 	Give back the slot of a zombie, once its parent is gone (or has
+//	reaped it) and no thread is still waiting in Join.
+//----------------------------------------------------------------------
+
+void ProcessTable::MaybeFree(PCB *pcb) {
+  if (pcb->status == PROCESS_ZOMBIE && pcb->parent == NULL &&
+      pcb->joiners == 0) {
+    Free(pcb);
+  }
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Free
+// 	Put the slot back in the free list, with a new generation so that
+//	the old identifier is not valid anymore.
+//----------------------------------------------------------------------
+
+void ProcessTable::Free(PCB *pcb) {
+  DEBUG('u', "Freeing process %d (slot %d)\n", pcb->id, pcb->slot);
+  pcb->status = PROCESS_FREE;
+  pcb->generation = (pcb->generation + 1) & ProcessGenerationMask;
+  pcb->nextFree = firstFree;
+  firstFree = pcb->slot;
+  numProcesses--;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Print
+// 	Print the processes in use, for debugging.
+//----------------------------------------------------------------------
+
+void ProcessTable::Print() {
+  printf("Process table: %d processes, %d slots\n", numProcesses, size);
+  for (int i = 0; i < size; i++) {
+    PCB *pcb = table[i];
+    if (pcb->status == PROCESS_FREE)
+      continue;
+    printf("  %d: %s, parent %d, threads %d, syscalls %d, ticks %d\n", pcb->id,
+           pcb->status == PROCESS_RUNNING ? "running" : "zombie",
+           pcb->parent != NULL ? pcb->parent->id : -1, pcb->numThreads,
+           pcb->numSyscalls,
+           (pcb->status == PROCESS_ZOMBIE ? pcb->exitTicks
+                                          : stats->totalTicks) -
+               pcb->startTicks);
+  }
+}
@@ -0,0 +1,128 @@
+// proctable.h
+//	Data structures to keep track of the user processes running on
+//	Nachos.
+//
+//	Every process has a process control block (PCB), that links its
+//	identifier with the kernel thread running it, its address space,
+//	its open files, its parent and its children.  All the PCBs live in
+//	a single table, indexed by the low bits of the process identifier,
+//	so that looking up a process, creating it, joining it and making it
+//	exit can all be done in constant time.
+//
+//	The high bits of a process identifier are a generation counter
+//	for the slot.  When a slot is reused, its generation is bumped, so
+//	that a stale identifier (for instance, a Join on a process that
+//	finished long ago) can never refer to a different process.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCTABLE_H
+#define PROCTABLE_H
+
+#include "copyright.h"
+#include "machine.h"
+#include "synch.h"
+#include "syscall.h"
+
+class AddrSpace;
+class IoContext;
+class NachosOpenFilesTable;
+class UserSyncTable;
+
+// Number of bits of a SpaceId used to index the process table; the rest
+// of the bits hold the generation of the slot.
+const int ProcessSlotBits = 16;
+const int ProcessSlotMask = (1 << ProcessSlotBits) - 1;
+const int ProcessGenerationMask = 0x7fff;
+
+// Initial number of slots in the process table, it doubles as needed
+// up to MaxNumProcesses.
+const int InitialNumProcesses = 128;
+
+// Process state
+enum ProcessStatus { PROCESS_FREE, PROCESS_RUNNING, PROCESS_ZOMBIE };
+
+// The following class defines a "process control block".  The fields
+// are public to make it simpler to manipulate them from the system
+// call handlers, but they should only be changed by the ProcessTable.
+
+class PCB {
+public:
+  PCB(int whichSlot); // initialize a free slot
+  ~PCB();
+
+  SpaceId id;           // slot number plus generation
+  int slot;             // position in the process table
+  int generation;       // how many times the slot has been reused
+  ProcessStatus status; // free, running or zombie
+
+  Thread *thread;                  // thread that started the process
+  AddrSpace *space;                // address space of that thread
+  NachosOpenFilesTable *openFiles; // files opened by the process
+  UserSyncTable *syncObjects;      // semaphores, locks and conditions
+  IoContext *ioContext;            // asynchronous I/O, NULL until IoSetup
+  int numThreads;                  // live threads (Exec + Forks)
+
+  PCB *parent;      // NULL if nobody is going to reap us
+  PCB *firstChild;  // children, linked through "nextSibling"
+  PCB *nextSibling; // and "prevSibling", so that a child
+  PCB *prevSibling; // can be unlinked in constant time
+
+  int exitStatus;       // value passed to Exit
+  int joiners;          // threads waiting in Join for this process
+  Semaphore *exited;    // where those threads wait
+  int nextFree;         // next free slot, if this one is free
+
+  // Resource usage
+  int startTicks;  // simulated time when the process was created
+  int exitTicks;   // simulated time when the process exited
+  int numSyscalls; // system calls done by all of its threads
+};
+
+// The following class defines the process table.  Every operation
+// runs with interrupts disabled, so that it is atomic with respect to
+// other threads, and none of them has to walk the table.
+
+class ProcessTable {
+public:
+  ProcessTable();  // empty table, InitialNumProcesses slots
+  ~ProcessTable(); // de-allocate every PCB
+
+  // Create a process run by "thread", child of "parent" (NULL for the
+  // first user program).  Return NULL if the table is full.
+  PCB *Create(Thread *thread, PCB *parent);
+
+  // Return the PCB of process "id", or NULL if the process does not
+  // exist anymore (or never existed).
+  PCB *Lookup(SpaceId id);
+
+  // A thread was forked inside the process
+  void AddThread(PCB *pcb);
+
+  // A thread of the process called Exit.  When it was the last one, the
+  // process becomes a zombie until its parent joins it, or is freed right
+  // away if nobody can join it.  Returns true if the process finished.
+  bool Exit(PCB *pcb, int status);
+
+  // Wait until process "id" finishes, and return its exit status.
+  // Returns -1 if there is no such process.
+  int Join(SpaceId id);
+
+  int NumProcesses() { return numProcesses; }
+  void Print(); // Print contents, for debugging
+
+private:
+  PCB **table;      // slots, grown by doubling
+  int size;         // slots allocated
+  int firstFree;    // head of the list of free slots, -1 if none
+  int numProcesses; // slots in use (running or zombie)
+
+  bool Grow();            // double the size of the table
+  void Free(PCB *pcb);    // give the slot back
+  void MaybeFree(PCB *pcb); // free a zombie if it is not needed anymore
+  void Unlink(PCB *child);  // remove a child from its parent's list
+};
+
+#endif // PROCTABLE_H
@@ -17,30 +17,33 @@
 
 //----------------------------------------------------------------------
 // StartProcess
-// 	Run a user program.  Open the executable, load it into
-//	memory, and jump to it.
+// 	Run a user program.  Load the executable into memory, through
+//	the executables cache, and jump to it.
 //----------------------------------------------------------------------
 
 // INFO: inicia un proceso
 void StartProcess(const char *filename) {
-  OpenFile *executable = fileSystem->Open(filename);
+  ExecImage *image = execCache->Get(filename);
   AddrSpace *space;
 
-  if (executable == NULL) {
+  if (image == NULL) {
     DEBUG('u', "Unable to open file %s\n", filename);
     return;
   }
-  space = new AddrSpace(executable);
+  space = new AddrSpace(image);
   currentThread->space = space;
   // printf("Process %s loaded.\n", filename);
 
-  delete executable; // close file
+  execCache->Release(image);
 
   space->InitRegisters(); // set the initial register values
   // WARN: VM crea la tabla de paginas para la maquina
   space->RestoreState();  // load page table register
 
-  currentThread->id = runningThreads->SecureFind();
+  // INFO: el proceso raiz no tiene padre que lo espere
+  PCB *pcb = processTable->Create(currentThread, NULL);
+  ASSERT(pcb != NULL);
+  pcb->space = space;
 
   // printf("Executing %s\n", filename);
   // NOTE: 0 inicia la simulación
@@ -0,0 +1,283 @@
+// sharedmem.cc
+//	Routines to manage the shared memory segments of user programs.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "sharedmem.h"
+#include "addrspace.h"
+#include "copyright.h"
+#include "system.h"
+#include <cstring>
+
+//----------------------------------------------------------------------
+// SharedSegment::SharedSegment
+// 	Initialize a segment of "pages" pages, known by "whichKey".
+//	Allocate must be called before using it.
+//----------------------------------------------------------------------
+
+SharedSegment::SharedSegment(int whichKey, int pages) {
+  key = whichKey;
+  numPages = pages;
+  numAttached = 0;
+  frames = new int[numPages];
+  sectors = new int[numPages];
+  dirty = new bool[numPages];
+  for (int page = 0; page < numPages; page++) {
+    frames[page] = sectors[page] = -1;
+    dirty[page] = false;
+  }
+  mappings = NULL;
+}
+
+//----------------------------------------------------------------------
+// SharedSegment::~SharedSegment
+// 	Free the frames and swap sectors of the segment.  Nobody is
+//	attached to it anymore.
+//----------------------------------------------------------------------
+
+SharedSegment::~SharedSegment() {
+  ASSERT(mappings == NULL);
+  for (int page = 0; page < numPages; page++) {
+    if (frames[page] != -1)
+      coreMap->Release(frames[page]);
+#ifdef VM
+    if (sectors[page] != -1)
+      swapSectors->SecureClear(sectors[page]);
+#endif
+  }
+  delete[] frames;
+  delete[] sectors;
+  delete[] dirty;
+}
+
+//----------------------------------------------------------------------
+// SharedSegment::Allocate
+// 	Get the memory of the segment, filled with zeros: frames, or swap
+//	sectors with virtual memory.  Returns false if there is not
+//	enough; what was allocated is freed with the segment.
+//----------------------------------------------------------------------
+
+bool SharedSegment::Allocate() {
+  for (int page = 0; page < numPages; page++) {
+#ifdef VM
+    sectors[page] = swapSectors->SecureFind();
+    if (sectors[page] == -1)
+      return false;
+    memset(&swapSpace[sectors[page] * SectorSize], 0, PageSize);
+#else
+    frames[page] = MapitaBits->SecureFind();
+    if (frames[page] == -1)
+      return false;
+    memset(&machine->mainMemory[frames[page] * PageSize], 0, PageSize);
+    coreMap->MapShared(frames[page], this, page, 0);
+#endif
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// SharedSegment::Attach
+// 	Map the segment into the page table of "space", from "firstPage"
+//	on.  The pages that are in memory are mapped right away; the
+//	others fault.
+//----------------------------------------------------------------------
+
+void SharedSegment::Attach(AddrSpace *space, int firstPage) {
+  SharedMapping *mapping = new SharedMapping;
+
+  mapping->space = space;
+  mapping->firstPage = firstPage;
+  mapping->next = mappings;
+  mappings = mapping;
+  numAttached++;
+
+  for (int page = 0; page < numPages; page++) {
+    TranslationEntry *entry = space->EntryFromVirtPage(firstPage + page);
+    entry->virtualPage = firstPage + page;
+    entry->physicalPage = frames[page];
+    entry->swapSector = sectors[page];
+    entry->valid = frames[page] != -1;
+    entry->readOnly = false;
+    entry->use = false;
+    entry->dirty = false;
+    if (frames[page] != -1)
+      coreMap->AddRef(frames[page]);
+  }
+}
+
+//----------------------------------------------------------------------
+// SharedSegment::Detach
+// 	"space" lets go of the segment; it takes the pages out of its
+//	page table afterwards.  The frames stay for the other address
+//	spaces, unless this was the last one.
+//----------------------------------------------------------------------
+
+void SharedSegment::Detach(AddrSpace *space) {
+  SharedMapping **link = &mappings;
+
+  while (*link != NULL && (*link)->space != space)
+    link = &(*link)->next;
+  ASSERT(*link != NULL);
+  SharedMapping *mapping = *link;
+  *link = mapping->next;
+  numAttached--;
+
+  for (int page = 0; page < numPages; page++) {
+    TranslationEntry *entry =
+        space->EntryFromVirtPage(mapping->firstPage + page);
+    if (frames[page] != -1) {
+      // INFO: lo que escribio este proceso no se pierde al desalojar
+      dirty[page] = dirty[page] || entry->dirty;
+      bool last = coreMap->Entry(frames[page])->refs <= 1;
+      coreMap->Release(frames[page]);
+      if (last)
+        frames[page] = -1;
+    }
+  }
+  delete mapping;
+}
+
+#ifdef VM
+//----------------------------------------------------------------------
+// SharedSegment::Load
+// 	Bring "page" from its swap sector into "frame", and map it in
+//	every attached address space, so that they all use this copy.
+//----------------------------------------------------------------------
+
+void SharedSegment::Load(int page, int frame) {
+  memcpy(&machine->mainMemory[frame * PageSize],
+         &swapSpace[sectors[page] * SectorSize], PageSize);
+  frames[page] = frame;
+  coreMap->MapShared(frame, this, page, numAttached);
+  for (SharedMapping *mapping = mappings; mapping != NULL;
+       mapping = mapping->next) {
+    TranslationEntry *entry =
+        mapping->space->EntryFromVirtPage(mapping->firstPage + page);
+    entry->physicalPage = frame;
+    entry->valid = true;
+    entry->use = false;
+    entry->dirty = false;
+  }
+  DEBUG('4', "\t-- SWAP [%d] -> MEM[%d] (compartida, %d espacios)\n",
+        sectors[page], frame, numAttached);
+}
+
+//----------------------------------------------------------------------
+// SharedSegment::Unload
+// 	"page" is leaving memory: invalidate it in every attached address
+//	space.  Returns true if any of them wrote to it since it was
+//	loaded.
+//----------------------------------------------------------------------
+
+bool SharedSegment::Unload(int page) {
+  bool wasDirty = dirty[page];
+
+  for (SharedMapping *mapping = mappings; mapping != NULL;
+       mapping = mapping->next) {
+    TranslationEntry *entry =
+        mapping->space->EntryFromVirtPage(mapping->firstPage + page);
+    wasDirty = wasDirty || entry->dirty;
+    entry->physicalPage = -1;
+    entry->valid = false;
+    entry->dirty = false;
+  }
+  frames[page] = -1;
+  dirty[page] = false;
+  return wasDirty;
+}
+#endif
+
+//----------------------------------------------------------------------
+// SharedMemoryTable::SharedMemoryTable
+// 	Initialize the table, without segments.
+//----------------------------------------------------------------------
+
+SharedMemoryTable::SharedMemoryTable() {
+  for (int id = 0; id < MaxSharedSegments; id++)
+    segments[id] = NULL;
+}
+
+//----------------------------------------------------------------------
+// SharedMemoryTable::Create
+// 	Find the segment with "key", or create it with room for "size"
+//	bytes, as long as there is memory for it.
+//----------------------------------------------------------------------
+
+int SharedMemoryTable::Create(int key, int size) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  int id = -1, freeId = -1;
+
+  for (int i = 0; i < MaxSharedSegments && id == -1; i++) {
+    if (segments[i] != NULL && segments[i]->key == key)
+      id = i;
+    else if (segments[i] == NULL && freeId == -1)
+      freeId = i;
+  }
+  if (id != -1) {
+    if (size > segments[id]->numPages * PageSize)
+      id = -1; // WARN: ya existe, pero es mas pequeno
+  } else if (size > 0 && freeId != -1) {
+    int pages = divRoundUp(size, PageSize);
+#ifdef VM
+    int maxPages = SwapSize;
+#else
+    int maxPages = NumPhysPages;
+#endif
+    SharedSegment *segment = NULL;
+    if (pages <= maxPages) {
+      segment = new SharedSegment(key, pages);
+      if (!segment->Allocate()) {
+        delete segment;
+        segment = NULL;
+      }
+    }
+    if (segment != NULL) {
+      segments[freeId] = segment;
+      id = freeId;
+      DEBUG('a', "Segmento compartido %d (llave %d), %d paginas\n", id, key,
+            pages);
+    }
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  return id;
+}
+
+SharedSegment *SharedMemoryTable::Lookup(int id) {
+  return (id >= 0 && id < MaxSharedSegments) ? segments[id] : NULL;
+}
+
+//----------------------------------------------------------------------
+// SharedMemoryTable::Attach
+// 	Attach segment "id" to "space", where it has room.  Returns the
+//	first page of the segment in "space", or -1.
+//----------------------------------------------------------------------
+
+int SharedMemoryTable::Attach(int id, AddrSpace *space) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  SharedSegment *segment = Lookup(id);
+  int firstPage = segment != NULL ? space->Attach(segment) : -1;
+
+  (void)interrupt->SetLevel(oldLevel);
+  return firstPage;
+}
+
+//----------------------------------------------------------------------
+// SharedMemoryTable::Detach
+// 	Detach "segment" from "space", and destroy it if nobody else is
+//	attached to it.
+//----------------------------------------------------------------------
+
+void SharedMemoryTable::Detach(SharedSegment *segment, AddrSpace *space) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  segment->Detach(space);
+  if (segment->numAttached == 0) {
+    for (int id = 0; id < MaxSharedSegments; id++)
+      if (segments[id] == segment)
+        segments[id] = NULL;
+    delete segment;
+  }
+  (void)interrupt->SetLevel(oldLevel);
+}
@@ -0,0 +1,100 @@
+// sharedmem.h
+//	Data structures for the shared memory segments of user programs.
+//
+//	A segment is a number of pages that any process can attach to
+//	its address space, with ShmAttach; every attached process maps
+//	the same page frames, so whatever one writes the others see.
+//	Processes find a segment by a key they agree on, with ShmCreate,
+//	since Exec passes no arguments.
+//
+//	Without virtual memory, the frames of a segment are allocated
+//	(and zeroed) when it is created.  With virtual memory, each page
+//	has a swap sector instead, and is loaded on the first fault of
+//	any attached process: it is then mapped into every attached page
+//	table at once, and evicted from all of them at once, so that the
+//	processes never see different copies of it.
+//
+//	A segment is destroyed, and its key can be used again, when the
+//	last process attached to it detaches (or exits).  A segment that
+//	nobody attached yet is kept until someone does.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SHAREDMEM_H
+#define SHAREDMEM_H
+
+#include "copyright.h"
+
+class AddrSpace;
+
+// Segments that can exist at once
+const int MaxSharedSegments = 16;
+
+// Segments one address space can have attached at once
+const int MaxAttachedSegments = 8;
+
+// An address space a segment is attached to
+struct SharedMapping {
+  AddrSpace *space;
+  int firstPage; // where the segment starts in "space"
+  SharedMapping *next;
+};
+
+// A shared memory segment
+
+class SharedSegment {
+public:
+  SharedSegment(int whichKey, int pages); // nothing allocated yet
+  ~SharedSegment(); // frees what is allocated
+
+  int key;
+  int numPages;
+  int numAttached; // address spaces attached
+
+  bool Allocate(); // frames or swap sectors, zeroed; false if no room
+
+  // Map the segment at "firstPage" of "space", or remove it from there
+  void Attach(AddrSpace *space, int firstPage);
+  void Detach(AddrSpace *space);
+
+  int SectorOf(int page) { return sectors[page]; }
+
+#ifdef VM
+  void Load(int page, int frame); // bring "page" into "frame", and map it
+                                  // in every attached address space
+  bool Unload(int page); // unmap "page" everywhere, true if it is dirty
+#endif
+
+private:
+  int *frames;          // frame of each page, -1 if not in memory
+  int *sectors;         // swap sector of each page (VM), or -1
+  bool *dirty;          // written by a space that detached since loaded
+  SharedMapping *mappings; // where the segment is attached
+};
+
+// The segments that exist, by id.  Like the ProcessTable, every
+// operation runs with interrupts disabled.
+
+class SharedMemoryTable {
+public:
+  SharedMemoryTable(); // no segments
+
+  // The id of the segment with "key", created with "size" bytes if it
+  // does not exist.  Returns -1 if it exists but is smaller, or there
+  // is no room for it.
+  int Create(int key, int size);
+
+  SharedSegment *Lookup(int id); // NULL if there is no such segment
+
+  // Attach segment "id" to "space", or detach "segment" from it;
+  // detaching the last address space destroys the segment
+  int Attach(int id, AddrSpace *space); // first page, -1 if not possible
+  void Detach(SharedSegment *segment, AddrSpace *space);
+
+private:
+  SharedSegment *segments[MaxSharedSegments];
+};
+
+#endif // SHAREDMEM_H
@@ -0,0 +1,193 @@
+// synchconsole.cc
+//	Routines to read and write the console a line at a time, on top of
+//	the asynchronous console device.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "synchconsole.h"
+#include "copyright.h"
+#include "system.h"
+
+// Editing characters of the line discipline
+const char EraseChar = '\b';
+const char DeleteChar = 0x7f; // also erases, as most terminals send it
+const char KillChar = 0x15;   // ^U
+const char EndChar = 0x04;    // ^D
+
+// Dummy functions because C++ can't take a pointer to a member function
+static void SynchConsoleReadAvail(void *c) {
+  ((SynchConsole *)c)->ReadAvail();
+}
+static void SynchConsoleWriteDone(void *c) {
+  ((SynchConsole *)c)->WriteDone();
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::SynchConsole
+// 	Initialize the console device, and empty buffers.
+//
+//	"readFile" -- UNIX file simulating the keyboard (NULL -> stdin)
+//	"writeFile" -- UNIX file simulating the display (NULL -> stdout)
+//----------------------------------------------------------------------
+
+SynchConsole::SynchConsole(const char *readFile, const char *writeFile) {
+  readLock = new Lock("console read");
+  writeLock = new Lock("console write");
+  lineAvail = new Semaphore("console line", 0);
+  outputRoom = new Semaphore("console output", 0);
+  inHead = inCount = inComplete = 0;
+  inEnd = readerWaiting = false;
+  outHead = outCount = 0;
+  putBusy = writerWaiting = false;
+  console = new Console(readFile, writeFile, SynchConsoleReadAvail,
+                        SynchConsoleWriteDone, this);
+}
+
+SynchConsole::~SynchConsole() {
+  delete console;
+  delete readLock;
+  delete writeLock;
+  delete lineAvail;
+  delete outputRoom;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::Read
+// 	Wait until a line is complete, and copy up to "size" bytes of it
+//	into "into" (the rest is left for the next Read).  Returns the
+//	number of bytes read, 0 at the end of the input.
+//----------------------------------------------------------------------
+
+int SynchConsole::Read(char *into, int size) {
+  int n = 0;
+
+  readLock->Acquire();
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  while (inComplete == 0 && !inEnd) {
+    readerWaiting = true;
+    lineAvail->P();
+  }
+  if (inComplete == 0) {
+    inEnd = false; // reported once
+  } else {
+    while (n < size && inComplete > 0) {
+      char ch = input[inHead];
+      inHead = (inHead + 1) % SynchConsoleBufferSize;
+      inCount--;
+      inComplete--;
+      into[n++] = ch;
+      if (ch == '\n')
+        break;
+    }
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  readLock->Release();
+  return n;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::Write
+// 	Queue "size" bytes from "from" for the display.  Returns as soon
+//	as they are all in the buffer; the device displays them later.
+//----------------------------------------------------------------------
+
+void SynchConsole::Write(const char *from, int size) {
+  writeLock->Acquire();
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  while (size > 0) {
+    while (outCount == SynchConsoleBufferSize) {
+      writerWaiting = true;
+      outputRoom->P();
+    }
+    for (; size > 0 && outCount < SynchConsoleBufferSize; size--) {
+      output[(outHead + outCount) % SynchConsoleBufferSize] = *from++;
+      outCount++;
+    }
+    StartOutput();
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  writeLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::Drain
+// 	Wait until everything written so far is on the display.
+//----------------------------------------------------------------------
+
+void SynchConsole::Drain() {
+  writeLock->Acquire();
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  while (outCount > 0) {
+    writerWaiting = true;
+    outputRoom->P();
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  writeLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::StartOutput
+// 	If the device is free, give it the next character.  Interrupts
+//	must be disabled.
+//----------------------------------------------------------------------
+
+void SynchConsole::StartOutput() {
+  if (!putBusy && outCount > 0) {
+    putBusy = true;
+    console->PutChar(output[outHead]);
+  }
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::WriteDone
+// 	Interrupt handler: a character was displayed.  Take it out of the
+//	buffer, start on the next one, and let a waiting writer know.
+//----------------------------------------------------------------------
+
+void SynchConsole::WriteDone() {
+  putBusy = false;
+  outHead = (outHead + 1) % SynchConsoleBufferSize;
+  outCount--;
+  StartOutput();
+  if (writerWaiting) {
+    writerWaiting = false;
+    outputRoom->V();
+  }
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::ReadAvail
+// 	Interrupt handler: a key was pressed.  Apply the line discipline,
+//	and wake up the reader if a line is complete.  Characters that do
+//	not fit are dropped, except that there is always room left to end
+//	the line.
+//----------------------------------------------------------------------
+
+void SynchConsole::ReadAvail() {
+  char ch = console->GetChar();
+
+  if (ch == EraseChar || ch == DeleteChar) {
+    if (inCount > inComplete)
+      inCount--;
+  } else if (ch == KillChar) {
+    inCount = inComplete;
+  } else if (ch == EndChar) {
+    if (inCount > inComplete)
+      inComplete = inCount;
+    else
+      inEnd = true;
+  } else if (inCount < SynchConsoleBufferSize - 1 ||
+             (ch == '\n' && inCount < SynchConsoleBufferSize)) {
+    input[(inHead + inCount) % SynchConsoleBufferSize] = ch;
+    inCount++;
+    if (ch == '\n')
+      inComplete = inCount;
+  }
+
+  if (readerWaiting && (inComplete > 0 || inEnd)) {
+    readerWaiting = false;
+    lineAvail->V();
+  }
+}
@@ -0,0 +1,88 @@
+// synchconsole.h
+//	Data structures for synchronous access to the console device,
+//	for the user programs.
+//
+//	The Console device only takes one character at a time, and
+//	interrupts when it is done with it; it also interrupts whenever a
+//	key is pressed.  The SynchConsole hides this behind Read and Write
+//	calls that a thread can make at any time:
+//
+//	Output goes into a ring buffer, and the WriteDone interrupts feed
+//	it to the device a character at a time.  A Write only waits if
+//	the buffer is full, so writers do not wait for each character to
+//	be displayed, and the output of many threads is queued together.
+//	The characters of one Write are never mixed with another's.
+//
+//	Input goes into another ring buffer, with a line discipline like
+//	a terminal's: the characters typed are only handed to a Read once
+//	the line is complete (with a newline), so that it can still be
+//	edited (backspace erases a character, ^U the whole line).  ^D
+//	hands over the line as it is, or, at the start of a line, makes
+//	the Read return 0 (the end of the input).  There is no echo; a
+//	host terminal already does it.
+//
+//	A Read waits until there is a complete line, and returns at most
+//	one line.
+//
+//	Since the console keeps polling the keyboard, there are always
+//	interrupts pending while it exists.  The machine still halts when
+//	there is nothing else left to do (see Interrupt::CheckIfDue), as
+//	long as no thread is waiting for input.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHCONSOLE_H
+#define SYNCHCONSOLE_H
+
+#include "console.h"
+#include "copyright.h"
+#include "synch.h"
+
+// Size of each of the ring buffers
+const int SynchConsoleBufferSize = 256;
+
+class SynchConsole {
+public:
+  // Use "readFile" as the keyboard and "writeFile" as the display (NULL
+  // for stdin and stdout)
+  SynchConsole(const char *readFile, const char *writeFile);
+  ~SynchConsole();
+
+  int Read(char *into, int size);         // wait for a line, return
+                                          // up to "size" bytes of it
+  void Write(const char *from, int size); // queue output
+  void Drain(); // wait until all the output is displayed
+
+  // Is a thread waiting for a line?
+  bool WaitingForInput() { return readerWaiting; }
+
+  // Interrupt handlers, called by the console device
+  void ReadAvail();
+  void WriteDone();
+
+private:
+  Console *console;
+  Lock *readLock;        // one Read at a time
+  Lock *writeLock;       // one Write at a time
+  Semaphore *lineAvail;  // a line was completed for the reader
+  Semaphore *outputRoom; // a character was displayed for the writer
+
+  char input[SynchConsoleBufferSize];
+  int inHead;     // next character for a Read
+  int inCount;    // characters in "input"
+  int inComplete; // ... that are in complete lines
+  bool inEnd;     // ^D typed at the start of a line
+  bool readerWaiting;
+
+  char output[SynchConsoleBufferSize];
+  int outHead;  // character being displayed, or next to display
+  int outCount; // characters in "output", including the one displayed
+  bool putBusy; // is the device displaying a character?
+  bool writerWaiting;
+
+  void StartOutput(); // hand the device the next character
+};
+
+#endif // SYNCHCONSOLE_H
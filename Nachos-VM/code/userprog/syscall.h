@@ -48,6 +48,26 @@
 #define SC_CondWait 22
 #define SC_CondBroadcast 23
 
+/*
+ *  Time system calls
+ */
+#define SC_Sleep 24
+#define SC_Ticks 46
+
+/*
+ *  Vectored and positional file system calls
+ */
+#define SC_ReadV 25
+#define SC_WriteV 26
+#define SC_PRead 27
+#define SC_PWrite 28
+
+/*
+ *  Pipe system calls
+ */
+#define SC_Pipe 29
+#define SC_Dup2 38
+
 /*
  *  Socket system calls
  */
@@ -58,6 +78,34 @@
 #define SC_Accept 34
 #define SC_Shutdown 35
 
+/*
+ *  Asynchronous I/O system calls
+ */
+#define SC_IoSetup 36
+#define SC_IoEnter 37
+
+/*
+ *  Shared memory system calls
+ */
+#define SC_ShmCreate 39
+#define SC_ShmAttach 40
+#define SC_ShmDetach 41
+
+/*
+ *  Dynamic memory system calls
+ */
+#define SC_Sbrk 42
+#define SC_Mmap 43
+#define SC_Munmap 44
+
+/*
+ *  Several system calls in one trap
+ */
+#define SC_Batch 45
+
+/* one more than the highest code: the size of the kernel's syscall table */
+#define NumSyscalls 47
+
 #ifndef IN_ASM
 
 /* The system call interface.  These are the operations the Nachos
@@ -75,7 +123,10 @@ void Halt();
 
 /* Address space control operations: Exit, Exec, and Join */
 
-/* This user program is done (status = 0 means exited normally). */
+/* This user program is done (status = 0 means exited normally).  A
+ * thread created with Fork only ends itself; the process ends when all of
+ * its threads have, with the status of the thread that started it.
+ */
 void Exit(int status);
 
 /* A unique identifier for an executing user program (address space) */
@@ -87,7 +138,8 @@ typedef int SpaceId;
 SpaceId Exec(char *name);
 
 /* Only return once the the user program "id" has finished.
- * Return the exit status.
+ * Return the exit status, or -1 if there is no such program or it is
+ * the caller itself.
  */
 int Join(SpaceId id);
 
@@ -135,6 +187,166 @@ int Read(char *buffer, int size, OpenFileId id);
 /* Close the file, we're done reading and writing to it. */
 void Close(OpenFileId id);
 
+/* A piece of a user buffer: "len" bytes at "base".  The kernel reads an
+ * array of these as pairs of words, so that a whole batch of records can
+ * be moved with a single system call.
+ */
+typedef struct {
+  char *base;
+  int len;
+} IoVec;
+
+/* Most pieces in one call */
+#define MaxIoVecs 64
+
+/* Read from the open file into the "iovcnt" pieces in "iov", filling
+ * each one before going on to the next.  Return the number of bytes
+ * read, or -1 on error.  On a pipe it waits only until there is some
+ * data, like Read.  Not for the console input.
+ */
+int ReadV(IoVec *iov, int iovcnt, OpenFileId id);
+
+/* Write the "iovcnt" pieces in "iov" to the open file (or to a pipe, or
+ * to the console output), in order.  On a pipe, no other Write gets in
+ * between the pieces; on the console, like Write, the output ends at the
+ * first '\0'.  Return the number of bytes written, or -1 on error.
+ */
+int WriteV(IoVec *iov, int iovcnt, OpenFileId id);
+
+/* Like ReadV and WriteV, but at byte "offset" of the file, without moving
+ * the position used by Read and Write.  Only for files: -1 on a pipe.
+ */
+int PRead(IoVec *iov, int iovcnt, int offset, OpenFileId id);
+int PWrite(IoVec *iov, int iovcnt, int offset, OpenFileId id);
+
+/* Create a pipe: fds[0] is its read end, fds[1] its write end.  Read
+ * waits for data, and returns 0 once every write end is closed; Write
+ * waits for room, and fails once every read end is closed.  The ends are
+ * inherited by Exec, like every open file.  Return 0, or -1 on error.
+ */
+int Pipe(OpenFileId *fds);
+
+/* Make "newId" refer to the same open file as "id", closing it first if
+ * needed.  "newId" can be ConsoleInput or ConsoleOutput, so that the
+ * programs started with Exec afterwards use the file as their console;
+ * Close(newId) then goes back to the console.  Return "newId", or -1.
+ */
+OpenFileId Dup2(OpenFileId id, OpenFileId newId);
+
+/* Shared memory.  ShmCreate returns the id of the segment with "key",
+ * creating it with room for "size" bytes (all zero) if there is none; -1
+ * if it exists but is smaller, or there is no memory for it.  Unrelated
+ * processes agree on the key to share a segment.
+ *
+ * ShmAttach maps segment "id" into the address space of the caller,
+ * between the heap and the stack, and returns its address ((char *) -1 on
+ * error, like Sbrk); every process attached to a segment sees what the
+ * others write in it.  ShmDetach unmaps the
+ * segment at "addr", returning 0 (-1 on error).  The segment goes away
+ * when the last process attached to it detaches or exits.  Threads
+ * created with Fork share the segments of their process.
+ */
+int ShmCreate(int key, int size);
+char *ShmAttach(int id);
+int ShmDetach(char *addr);
+
+/* Dynamic memory.  The heap starts right after the uninitialized data;
+ * Sbrk moves its end "increment" bytes (back, if negative) and returns
+ * where it was, so that a positive increment returns the new memory, all
+ * zero.  Returns (char *) -1 if the heap can not grow that much.  Sbrk(0)
+ * tells where the heap ends.  The stack needs no call: it grows on its
+ * own, up to 8 KB.  Threads created with Fork share the heap of their
+ * process, but get a stack of their own that does not grow.
+ */
+char *Sbrk(int increment);
+
+/* Mapped files.  Mmap maps "length" bytes of the open file "id", from
+ * "offset" on (a multiple of 128, the page size), between the heap and
+ * the stack, and returns their address ((char *) -1 on error).  Each page is read
+ * from the file the first time the program touches it; what the program
+ * writes goes back to the file when the page leaves memory, or at the
+ * latest with Munmap, that removes the mapping at "addr" and returns 0
+ * (-1 on error).  Closing "id" does not remove the mapping, exiting does.
+ * Threads created with Fork share the mappings of their process.
+ */
+char *Mmap(OpenFileId id, int offset, int length);
+int Munmap(char *addr);
+
+/* One system call of a Batch: its code (SC_Write, ...), its arguments,
+ * and, once it ran, what it returned.
+ */
+typedef struct {
+  int type;
+  int args[4];
+  int result;
+} SyscallDesc;
+
+/* Most system calls in one Batch */
+#define MaxBatchCalls 64
+
+/* Make the "count" system calls in "calls", in order, with a single trap
+ * into the kernel, leaving the result of each in its "result".  Stops
+ * after the first one that returns a negative value, as every call does
+ * when it fails.  Halt, Exit and
+ * Batch itself can not be batched: they fail with -1.  Returns how many
+ * calls succeeded, so "calls[n]" is the one that failed if n < count; or
+ * -1 if "calls" can not be read.
+ */
+int Batch(SyscallDesc *calls, int count);
+
+/* Asynchronous I/O.  The program keeps an IoRing in its own memory, and
+ * hands it to the kernel once with IoSetup.  To start operations, it fills
+ * submission entries sq[sqTail % IoRingEntries] and advances sqTail; the
+ * kernel takes them with IoEnter, advancing sqHead, and a kernel thread
+ * carries them out while the program goes on.  The result of each one
+ * (bytes transferred, or -1) is posted at cq[cqTail % IoRingEntries],
+ * with the "userData" of its submission, as the kernel advances cqTail;
+ * the program consumes them advancing cqHead.
+ *
+ * Completions are posted to the ring during IoEnter, so a program that
+ * only wants to collect results calls IoEnter(0, n).
+ */
+
+#define IoRingEntries 16
+
+#define IO_NOP 0
+#define IO_READ 1
+#define IO_WRITE 2
+
+typedef struct {
+  int opcode;    /* IO_NOP, IO_READ or IO_WRITE */
+  OpenFileId id; /* an open file, not the console */
+  char *buffer;  /* the data, left alone until the operation completes */
+  int size;
+  int offset;    /* position in the file, -1 for the current one */
+  int userData;  /* copied to the completion */
+} IoSubmission;
+
+typedef struct {
+  int userData;
+  int result;
+} IoCompletion;
+
+typedef struct {
+  int sqHead; /* advanced by the kernel */
+  int sqTail; /* advanced by the program */
+  int cqHead; /* advanced by the program */
+  int cqTail; /* advanced by the kernel */
+  IoSubmission sq[IoRingEntries];
+  IoCompletion cq[IoRingEntries];
+} IoRing;
+
+/* Use "ring" for the asynchronous I/O of the process; every index is
+ * set to 0.  Returns -1 if the process already has a ring.
+ */
+int IoSetup(IoRing *ring);
+
+/* Start up to "toSubmit" of the pending submissions, and wait until
+ * there are at least "minComplete" completions in the ring, or nothing
+ * left in flight.  Returns the number of submissions taken, -1 on error.
+ */
+int IoEnter(int toSubmit, int minComplete);
+
 /* User-level thread operations: Fork and Yield.  To allow multiple
  * threads to run within a user program.
  */
@@ -149,6 +361,20 @@ void Fork(void (*func)());
  */
 void Yield();
 
+/* Sleep for "ticks" units of simulated time, letting other threads run. */
+void Sleep(int ticks);
+
+/* Return the simulated time, in ticks since Nachos started. */
+int Ticks();
+
+/* The synchronization objects below belong to the process that creates
+ * them, and are shared by all of its threads.  Every call returns -1 on
+ * a bad identifier; the ones that wait also return -1 if the object is
+ * destroyed meanwhile.  Objects left when the thread that started the
+ * process calls Exit are destroyed then, waking up the threads that wait
+ * on them.
+ */
+
 typedef int Sem_t;
 /* SemCreate creates a semaphore initialized to initval value
  * return the semaphore id
@@ -171,18 +397,18 @@ Lock_t LckCreate();
 /* LckDestroy destroy an already created Lock */
 int LckDestroy(Lock_t lockId);
 
-/* LckLock obtain the lock, if busy the thread must wait */
-int LckLock(Lock_t lockId);
+/* LckAcquire obtain the lock, if busy the thread must wait */
+int LckAcquire(Lock_t lockId);
 
-/* LckUnlock release the obtained lock freeing it to be used for others */
-int LckUnlock(Lock_t lockId);
+/* LckRelease release the obtained lock freeing it to be used for others */
+int LckRelease(Lock_t lockId);
 
 typedef int Cond_t;
 /* CondCreate creates a condition variable */
-int CondCreate(Cond_t condId);
+Cond_t CondCreate();
 
-/* CondDestroy destroy an already created Lock */
-int LckDestroy(Cond_t condId);
+/* CondDestroy destroy an already created condition variable */
+int CondDestroy(Cond_t condId);
 
 /* CondSignal signal on condition variable, awaking other threads if necessary
  */
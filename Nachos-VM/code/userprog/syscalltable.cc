@@ -0,0 +1,140 @@
+// syscalltable.cc
+//	Routines to keep, and report, the counters of the system calls.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "syscalltable.h"
+#include "copyright.h"
+#include "utility.h"
+
+//----------------------------------------------------------------------
+// LatencyHistogram::LatencyHistogram
+// 	Initialize an empty histogram.
+//----------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram() {
+  samples = total = max = 0;
+  for (int i = 0; i < HistogramBuckets; i++)
+    buckets[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// LatencyHistogram::Record
+// 	Count one more "value": it goes in the bucket of the smallest
+//	power of two larger than it.
+//----------------------------------------------------------------------
+
+void LatencyHistogram::Record(long long value) {
+  int bucket = 0;
+
+  while (bucket < HistogramBuckets - 1 && (value >> bucket) != 0)
+    bucket++;
+  buckets[bucket]++;
+  samples++;
+  total += value;
+  if (value > max)
+    max = value;
+}
+
+//----------------------------------------------------------------------
+// LatencyHistogram::Print
+// 	Print the mean, the maximum, and the buckets that are not empty,
+//	as "<2^i:count".  There must be some value.
+//----------------------------------------------------------------------
+
+void LatencyHistogram::Print(const char *unit) {
+  printf("      %-5s mean %lld, max %lld:", unit, total / samples, max);
+  for (int i = 0; i < HistogramBuckets; i++)
+    if (buckets[i] > 0)
+      printf(" <2^%d:%lld", i, buckets[i]);
+  printf("\n");
+}
+
+//----------------------------------------------------------------------
+// LatencyHistogram::PrintJSON
+// 	Write the histogram as a JSON object; "buckets" has every bucket,
+//	bucket i counting the values below 2^i.
+//----------------------------------------------------------------------
+
+void LatencyHistogram::PrintJSON(FILE *output) {
+  fprintf(output, "{\"samples\": %lld, \"total\": %lld, \"max\": %lld, "
+                  "\"buckets\": [", samples, total, max);
+  for (int i = 0; i < HistogramBuckets; i++)
+    fprintf(output, "%s%lld", i == 0 ? "" : ", ", buckets[i]);
+  fprintf(output, "]}");
+}
+
+//----------------------------------------------------------------------
+// SyscallProfiler::SyscallProfiler
+// 	Initialize the counters of every system call to zero.  The report
+//	is written, as JSON, to "jsonFileName".
+//----------------------------------------------------------------------
+
+SyscallProfiler::SyscallProfiler(const char *jsonFileName) {
+  for (int type = 0; type < NumSyscalls; type++)
+    counters[type].calls = 0;
+  jsonName = jsonFileName;
+}
+
+//----------------------------------------------------------------------
+// SyscallProfiler::Record
+// 	A call to system call "type" returned, after "ticks" of simulated
+//	time and "nanos" of host time.
+//----------------------------------------------------------------------
+
+void SyscallProfiler::Record(int type, long long ticks, long long nanos) {
+  counters[type].ticks.Record(ticks);
+  counters[type].nanos.Record(nanos);
+}
+
+//----------------------------------------------------------------------
+// SyscallProfiler::Print
+// 	Print the system calls that were made, in the order of their
+//	codes, and write all of them to the JSON file.
+//----------------------------------------------------------------------
+
+void SyscallProfiler::Print() {
+  long long calls = 0;
+
+  for (int type = 0; type < NumSyscalls; type++)
+    calls += counters[type].calls;
+  printf("System calls (%lld calls):\n", calls);
+  for (int type = 0; type < NumSyscalls; type++) {
+    SyscallStats *s = &counters[type];
+    if (s->calls == 0)
+      continue;
+    printf("  %2d %-14s %8lld calls\n", type, syscallTable[type].name,
+           s->calls);
+    if (s->ticks.samples > 0) { // INFO: Exit y Halt no vuelven
+      s->ticks.Print("ticks");
+      s->nanos.Print("ns");
+    }
+  }
+
+  FILE *output = fopen(jsonName, "w");
+  if (output == NULL) {
+    printf("Unable to write the system call report to %s\n", jsonName);
+    return;
+  }
+  fprintf(output, "{\"syscalls\": [\n");
+  bool first = true;
+  for (int type = 0; type < NumSyscalls; type++) {
+    SyscallStats *s = &counters[type];
+    if (syscallTable[type].name == NULL)
+      continue;
+    fprintf(output, "%s  {\"code\": %d, \"name\": \"%s\", \"args\": %d, "
+                    "\"calls\": %lld,\n   \"ticks\": ",
+            first ? "" : ",\n", type, syscallTable[type].name,
+            syscallTable[type].numArgs, s->calls);
+    s->ticks.PrintJSON(output);
+    fprintf(output, ",\n   \"ns\": ");
+    s->nanos.PrintJSON(output);
+    fprintf(output, "}");
+    first = false;
+  }
+  fprintf(output, "\n]}\n");
+  fclose(output);
+  printf("System call report written to %s\n", jsonName);
+}
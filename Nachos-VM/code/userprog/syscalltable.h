@@ -0,0 +1,84 @@
+// syscalltable.h
+//	Data structures to dispatch the system calls of user programs, and
+//	to find out which of them the programs spend their time in.
+//
+//	ExceptionHandler looks the code in r2 up in a table with one
+//	descriptor per system call: its name, how many arguments it takes
+//	(in r4 to r7), and the kernel routine that implements it.
+//
+//	When Nachos is started with the -ss flag, every system call also
+//	counts how many times it was made, and how long each call took,
+//	both in simulated ticks and in nanoseconds of the host.  The times
+//	go into histograms with one bucket per power of two.  A call that
+//	blocks counts the time it waited; Exit and Halt, that do not
+//	return, only count the call.  The report is printed with the rest
+//	of the statistics when Nachos halts, and also written, as JSON, to
+//	a file.  Without -ss, the only cost is a test for NULL.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYSCALLTABLE_H
+#define SYSCALLTABLE_H
+
+#include "copyright.h"
+#include "syscall.h"
+
+#include <cstdio>
+
+// What the kernel knows about one system call
+
+struct SyscallDescriptor {
+  const char *name;  // NULL if the code is not in use
+  int numArgs;       // arguments in r4, r5, ...
+  void (*handler)(); // reads them, and leaves the result in r2
+};
+
+// Indexed by the SC_ code; defined in exception.cc, with the handlers
+extern const SyscallDescriptor syscallTable[NumSyscalls];
+
+// Powers of two a histogram tells apart; the last bucket takes
+// everything larger
+const int HistogramBuckets = 40;
+
+class LatencyHistogram {
+public:
+  LatencyHistogram(); // empty
+
+  void Record(long long value);
+
+  long long samples;
+  long long total;
+  long long max;
+  long long buckets[HistogramBuckets]; // bucket i: values < 2^i
+
+  void Print(const char *unit);   // one line, only the used buckets
+  void PrintJSON(FILE *output);   // as a JSON object
+};
+
+// Counters of one system call
+
+struct SyscallStats {
+  long long calls;
+  LatencyHistogram ticks; // simulated time
+  LatencyHistogram nanos; // host time
+};
+
+class SyscallProfiler {
+public:
+  SyscallProfiler(const char *jsonFileName); // the name is not copied
+
+  void Call(int type) { counters[type].calls++; }
+  void Record(int type, long long ticks, long long nanos);
+
+  void Print(); // report, and write the JSON file
+
+private:
+  SyscallStats counters[NumSyscalls];
+  const char *jsonName;
+};
+
+extern SyscallProfiler *syscallProfiler; // NULL unless -ss was given
+
+#endif // SYSCALLTABLE_H
@@ -0,0 +1,177 @@
+// usermem.cc
+//	Routines to copy data in and out of user memory, one page at a
+//	time.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "usermem.h"
+#include "copyright.h"
+#include "system.h"
+
+#include <cstring>
+
+// Most translations of one page: the worst case is a stack page that is
+// not there yet, which HandleFault maps, the next fault loads, the next
+// puts in the TLB, and the last one finds
+const int MaxTranslateTries = 4;
+
+//----------------------------------------------------------------------
+// UserSpan
+// 	Translate user address "userAddr", and return where it is in the
+//	simulated physical memory.  "*spanSize" gets the number of bytes
+//	from there to the end of the page, which are contiguous.
+//
+//	A page fault is served by the translation itself (it loads the
+//	TLB, and the page if needed) or by HandleFault (the stack grows),
+//	so we try again until it goes through, or HandleFault refuses the
+//	address.  Returns NULL if the address is not valid.
+//
+//	"writing" is true if the bytes are going to be changed, so the
+//	page gets marked dirty.
+//----------------------------------------------------------------------
+
+static char *UserSpan(int userAddr, bool writing, int *spanSize) {
+  int physAddr;
+  ExceptionType exception = PageFaultException;
+
+  for (int i = 0; i < MaxTranslateTries && exception == PageFaultException;
+       i++) {
+    exception = machine->Translate(userAddr, &physAddr, 1, writing);
+    // INFO: igual que en ExceptionHandler, puede ser el stack que crece
+    if (exception == PageFaultException &&
+        !currentThread->space->HandleFault(userAddr))
+      break;
+  }
+  stats->numUserCopyTranslations++;
+  if (exception != NoException) {
+    DEBUG('a', "User address 0x%x not valid (%d)\n", userAddr, exception);
+    return NULL;
+  }
+  *spanSize = PageSize - (unsigned)userAddr % PageSize;
+  return &machine->mainMemory[physAddr];
+}
+
+//----------------------------------------------------------------------
+// ForEachUserSpan
+// 	Go through a user buffer a page at a time, handing every piece
+//	to "func".
+//----------------------------------------------------------------------
+
+bool ForEachUserSpan(int userAddr, int size, bool writing,
+                     UserSpanFunction func, void *arg) {
+  int done = 0;
+
+  while (done < size) {
+    int span;
+    char *piece = UserSpan(userAddr + done, writing, &span);
+    if (piece == NULL)
+      return false;
+    if (span > size - done)
+      span = size - done;
+    done += span;
+    stats->numUserBytesCopied += span;
+    if (!func(piece, span, arg))
+      break;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+// CopyFromUser
+// 	Copy "size" bytes from user memory into the kernel, a page at a
+//	time.
+//----------------------------------------------------------------------
+
+bool CopyFromUser(int userAddr, char *buffer, int size) {
+  int done = 0;
+
+  while (done < size) {
+    int span;
+    char *from = UserSpan(userAddr + done, false, &span);
+    if (from == NULL)
+      return false;
+    if (span > size - done)
+      span = size - done;
+    memcpy(buffer + done, from, span);
+    done += span;
+  }
+  stats->numUserBytesCopied += size;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// CopyToUser
+// 	Copy "size" bytes from the kernel into user memory, a page at a
+//	time.
+//----------------------------------------------------------------------
+
+bool CopyToUser(int userAddr, const char *buffer, int size) {
+  int done = 0;
+
+  while (done < size) {
+    int span;
+    char *to = UserSpan(userAddr + done, true, &span);
+    if (to == NULL)
+      return false;
+    if (span > size - done)
+      span = size - done;
+    memcpy(to, buffer + done, span);
+    done += span;
+  }
+  stats->numUserBytesCopied += size;
+  return true;
+}
+
+//----------------------------------------------------------------------
+// ReadUserWord, WriteUserWord
+// 	Move a single word of a structure shared with a user program,
+//	converting between the byte order of the host and the machine's.
+//----------------------------------------------------------------------
+
+bool ReadUserWord(int userAddr, int *value) {
+  unsigned word;
+
+  if (!CopyFromUser(userAddr, (char *)&word, sizeof(word)))
+    return false;
+  *value = WordToHost(word);
+  return true;
+}
+
+bool WriteUserWord(int userAddr, int value) {
+  unsigned word = WordToMachine(value);
+
+  return CopyToUser(userAddr, (char *)&word, sizeof(word));
+}
+
+//----------------------------------------------------------------------
+// CopyStringFromUser
+// 	Copy a '\0' terminated string from user memory.  Each page is
+//	searched for the end of the string with memchr, so that we never
+//	look at the page after the one the string ends in.
+//----------------------------------------------------------------------
+
+int CopyStringFromUser(int userAddr, char *buffer, int maxSize) {
+  int done = 0;
+
+  while (done < maxSize) {
+    int span;
+    char *from = UserSpan(userAddr + done, false, &span);
+    if (from == NULL)
+      return -1;
+    if (span > maxSize - done)
+      span = maxSize - done;
+    char *end = (char *)memchr(from, '\0', span);
+    if (end != NULL) {
+      int length = done + (end - from);
+      memcpy(buffer + done, from, end - from + 1);
+      stats->numUserBytesCopied += length + 1;
+      return length;
+    }
+    memcpy(buffer + done, from, span);
+    done += span;
+  }
+  DEBUG('a', "User string at 0x%x longer than %d\n", userAddr, maxSize);
+  return -1;
+}
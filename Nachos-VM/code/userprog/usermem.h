@@ -0,0 +1,63 @@
+// usermem.h
+//	Routines to move data between the kernel and the address space of
+//	the current user program.
+//
+//	System calls get pointers into user memory: file names, buffers
+//	to read into or write from.  Going through Machine::ReadMem and
+//	WriteMem one byte at a time costs a full address translation per
+//	byte.  Instead, these routines translate once per page, and copy
+//	whole spans of the page at a time with memcpy; a page of user
+//	memory is contiguous in the simulated physical memory, even though
+//	consecutive pages are not.
+//
+//	If a page is not in the TLB (or, with virtual memory, not even in
+//	memory), translating it brings it in, and the copy is resumed
+//	from there.  The copy only fails if the address is not valid.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef USERMEM_H
+#define USERMEM_H
+
+#include "copyright.h"
+
+// Longest string (file name, ...) taken from a user program, counting
+// the terminating '\0'
+const int MaxUserString = 256;
+
+// Most bytes moved by one vectored system call (ReadV, WriteV, ...)
+const int MaxUserIo = 1 << 20;
+
+// Copy "size" bytes at user address "userAddr" into "buffer".  Returns
+// false if some of the bytes are not in the address space.
+bool CopyFromUser(int userAddr, char *buffer, int size);
+
+// Copy "size" bytes from "buffer" to user address "userAddr".  Returns
+// false if some of the bytes are not in the address space.
+bool CopyToUser(int userAddr, const char *buffer, int size);
+
+// Call "func" on each piece of the "size" bytes at user address
+// "userAddr" that is contiguous in the simulated physical memory (a
+// page, or part of one), in order.  "arg" is passed along.  Stops early,
+// and still succeeds, if "func" returns false.  Returns false if some of
+// the bytes are not in the address space.
+//
+// A piece is only valid until the next translation, which could evict
+// its page; so "func" must be done with it when it returns.
+typedef bool (*UserSpanFunction)(char *span, int size, void *arg);
+bool ForEachUserSpan(int userAddr, int size, bool writing,
+                     UserSpanFunction func, void *arg);
+
+// Read or write the word at user address "userAddr", in the byte order
+// of the machine.  Return false if it is not in the address space.
+bool ReadUserWord(int userAddr, int *value);
+bool WriteUserWord(int userAddr, int value);
+
+// Copy the string at user address "userAddr" into "buffer", which has
+// room for "maxSize" bytes.  Returns the length of the string, or -1 if
+// it is not in the address space or does not fit.
+int CopyStringFromUser(int userAddr, char *buffer, int maxSize);
+
+#endif // USERMEM_H
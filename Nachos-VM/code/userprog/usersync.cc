@@ -0,0 +1,155 @@
+// usersync.cc
+//	Routines to manage the synchronization objects of user programs.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "usersync.h"
+#include "copyright.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// UserSync::UserSync
+// 	Create the kernel object behind a user semaphore, lock or
+//	condition.  "initialValue" is only used by semaphores.
+//----------------------------------------------------------------------
+
+UserSync::UserSync(UserSyncKind whichKind, int initialValue) {
+  kind = whichKind;
+  semaphore = NULL;
+  lock = NULL;
+  condition = NULL;
+  switch (kind) {
+  case USER_SEMAPHORE:
+    semaphore = new Semaphore("user semaphore", initialValue);
+    break;
+  case USER_LOCK:
+    lock = new Lock("user lock");
+    break;
+  case USER_CONDITION:
+    condition = new Condition("user condition");
+    break;
+  }
+  users = 0;
+  destroyed = false;
+}
+
+UserSync::~UserSync() {
+  delete semaphore;
+  delete lock;
+  delete condition;
+}
+
+//----------------------------------------------------------------------
+// UserSync::Destroy
+// 	Wake up the threads waiting on the object; their system calls
+//	fail.  The object is deleted now if nobody is using it, or else by
+//	the last of its users.  Interrupts must be disabled.
+//----------------------------------------------------------------------
+
+void UserSync::Destroy() {
+  destroyed = true;
+  switch (kind) {
+  case USER_SEMAPHORE:
+    semaphore->Destroy();
+    break;
+  case USER_LOCK:
+    lock->Destroy();
+    break;
+  case USER_CONDITION:
+    condition->Destroy();
+    break;
+  }
+  if (users == 0)
+    delete this;
+}
+
+//----------------------------------------------------------------------
+// UserSync::Unuse
+// 	A system call is done with the object.  If it was destroyed
+//	meanwhile, and this was its last user, delete it.
+//----------------------------------------------------------------------
+
+void UserSync::Unuse() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+  ASSERT(users > 0);
+  if (--users == 0 && destroyed)
+    delete this;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// UserSyncTable::UserSyncTable
+// 	Initialize an empty table.
+//----------------------------------------------------------------------
+
+UserSyncTable::UserSyncTable() { handles = new HandleTable<UserSync>; }
+
+//----------------------------------------------------------------------
+// UserSyncTable::~UserSyncTable
+// 	The process finished: destroy the objects it left behind.
+//----------------------------------------------------------------------
+
+UserSyncTable::~UserSyncTable() {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  UserSync *object;
+
+  while ((object = handles->RemoveAny()) != NULL)
+    object->Destroy();
+  delete handles;
+  (void)interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// UserSyncTable::Create
+// 	Create an object and give it a handle.
+//----------------------------------------------------------------------
+
+int UserSyncTable::Create(UserSyncKind kind, int initialValue) {
+  UserSync *object = new UserSync(kind, initialValue);
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  int handle = handles->Add(object);
+
+  (void)interrupt->SetLevel(oldLevel);
+  if (handle == -1)
+    delete object;
+  return handle;
+}
+
+//----------------------------------------------------------------------
+// UserSyncTable::Use
+// 	Look "handle" up, checking that it names an object of "kind".
+//----------------------------------------------------------------------
+
+UserSync *UserSyncTable::Use(int handle, UserSyncKind kind) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  UserSync *object = handles->Lookup(handle);
+
+  if (object != NULL && object->kind != kind)
+    object = NULL;
+  if (object != NULL)
+    object->users++;
+  (void)interrupt->SetLevel(oldLevel);
+  return object;
+}
+
+//----------------------------------------------------------------------
+// UserSyncTable::Destroy
+// 	Take "handle" out of the table, and destroy its object.
+//----------------------------------------------------------------------
+
+int UserSyncTable::Destroy(int handle, UserSyncKind kind) {
+  IntStatus oldLevel = interrupt->SetLevel(IntOff);
+  UserSync *object = handles->Lookup(handle);
+  int result = -1;
+
+  if (object != NULL && object->kind == kind) {
+    handles->Remove(handle);
+    object->Destroy();
+    result = 0;
+  }
+  (void)interrupt->SetLevel(oldLevel);
+  return result;
+}
@@ -0,0 +1,77 @@
+// usersync.h
+//	Data structures for the semaphores, locks and condition variables
+//	that user programs create with system calls.
+//
+//	Each object is a kernel Semaphore, Lock or Condition, and user
+//	programs name it with a handle from a per-process HandleTable, so
+//	that the threads of a process share their objects, but processes
+//	cannot touch each other's.
+//
+//	Destroying an object wakes up the threads blocked on it, whose
+//	system calls then fail.  Since those threads still use the object
+//	on their way out, it is only deleted when the last thread inside a
+//	system call on it is done; until then it is "destroyed", and no
+//	longer reachable through its handle.  When the thread that started
+//	the process exits, every object it did not destroy is destroyed the
+//	same way, so that no thread is left waiting on one forever.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef USERSYNC_H
+#define USERSYNC_H
+
+#include "copyright.h"
+#include "handletable.h"
+#include "synch.h"
+
+enum UserSyncKind { USER_SEMAPHORE, USER_LOCK, USER_CONDITION };
+
+// A synchronization object owned by a user process
+
+class UserSync {
+public:
+  UserSync(UserSyncKind whichKind, int initialValue);
+  ~UserSync();
+
+  UserSyncKind kind;
+  Semaphore *semaphore; // the kernel object, depending on "kind"
+  Lock *lock;
+  Condition *condition;
+
+  void Destroy(); // wake up every waiter; deleted once nobody uses it
+  void Unuse();   // a system call is done with the object
+
+private:
+  friend class UserSyncTable;
+  int users;      // threads inside a system call on the object
+  bool destroyed; // no longer in the table
+};
+
+// The objects of one process, by handle.  Like the ProcessTable, every
+// operation runs with interrupts disabled.
+
+class UserSyncTable {
+public:
+  UserSyncTable();  // no objects
+  ~UserSyncTable(); // destroy every object left
+
+  // Create an object of "kind" (semaphores start at "initialValue").
+  // Returns its handle, or -1 if the table is full.
+  int Create(UserSyncKind kind, int initialValue);
+
+  // Return the object named by "handle", which must be of "kind", and
+  // count the caller as using it until it calls Unuse.  Returns NULL if
+  // there is no such object.
+  UserSync *Use(int handle, UserSyncKind kind);
+
+  // Destroy the object named by "handle".  Returns -1 if there is no
+  // such object of "kind".
+  int Destroy(int handle, UserSyncKind kind);
+
+private:
+  HandleTable<UserSync> *handles;
+};
+
+#endif // USERSYNC_H